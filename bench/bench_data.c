@@ -0,0 +1,405 @@
+#include "bench_data.h"
+#include "data/dao.h"
+#include "util/hash.h"
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* SQL del generador: la historia entra ya cerrada, con fechas y precios explícitos. */
+static const char BENCH_SQL_USER_INSERT[] = "INSERT INTO users(username, role, password_hash) VALUES(?, 'mozo', ?)";
+static const char BENCH_SQL_TABLE_INSERT[] = "INSERT INTO tables(name, status, capacity) VALUES(?, 'libre', ?)";
+static const char BENCH_SQL_MENU_ITEM_INSERT[] = "INSERT INTO menu_items(name, category, price, cost, stock, station) VALUES(?, ?, ?, ?, ?, ?)";
+static const char BENCH_SQL_ORDER_INSERT[] = "INSERT INTO orders(table_id, waiter_id, status, created_at, closed_at, business_date) VALUES(?, ?, 'cerrada', ?, ?, ?)";
+static const char BENCH_SQL_ORDER_ITEM_INSERT[] = "INSERT INTO order_items(order_id, menu_item_id, status, notes, unit_price, unit_cost) VALUES(?, ?, ?, ?, ?, ?)";
+static const char BENCH_SQL_COUNTS[] = "SELECT (SELECT COUNT(*) FROM orders), (SELECT COUNT(*) FROM order_items), (SELECT COUNT(*) FROM reservations)";
+
+/* Las mesas, la carta y los mozos del seed cuentan dentro de la escala. */
+#define BENCH_SEED_TABLES 10
+#define BENCH_SEED_MENU_ITEMS 10
+#define BENCH_SEED_WAITERS 2
+/* Ventana de reservas: una semana hacia atrás y un mes hacia adelante. */
+#define BENCH_RESERVATION_DAYS_BACK 7
+#define BENCH_RESERVATION_DAYS_AHEAD 30
+
+typedef struct BenchPreset {
+    const char *name;
+    BenchScale scale;
+} BenchPreset;
+
+static const BenchPreset BENCH_PRESETS[] = {
+    {"small", {10, 4, 40, 30, 100, 5, 8}},
+    {"medium", {40, 12, 120, 180, 300, 6, 20}},
+    {"large", {60, 20, 200, 365, 400, 7, 30}}
+};
+
+typedef struct BenchCategory {
+    const char *category;
+    const char *station;
+    double base_price;
+} BenchCategory;
+
+static const BenchCategory BENCH_CATEGORIES[] = {
+    {"Entrada", "cocina", 1800},
+    {"Plato Principal", "cocina", 3200},
+    {"Postre", "postres", 1400},
+    {"Bebida", "barra", 900}
+};
+
+static const char *const BENCH_NOTES[] = {"", "", "", "sin sal", "bien cocido", "sin hielo"};
+
+/* Lo que la historia necesita de la carta y del personal ya insertados. */
+typedef struct BenchCatalog {
+    int *waiter_ids;
+    int waiter_count;
+    int *table_ids;
+    int table_count;
+    MenuItem *menu;
+    int menu_count;
+} BenchCatalog;
+
+/* xorshift32: determinista y sin estado global. */
+static unsigned int bench_random_next(unsigned int *state) {
+    unsigned int value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+static int bench_random_below(unsigned int *state, int limit) {
+    return limit <= 0 ? 0 : (int)(bench_random_next(state) % (unsigned int)limit);
+}
+
+bool bench_scale_preset(const char *name, BenchScale *scale) {
+    size_t index = 0;
+    while (index < sizeof(BENCH_PRESETS) / sizeof(BENCH_PRESETS[0])) {
+        if (strcmp(BENCH_PRESETS[index].name, name) == 0) {
+            *scale = BENCH_PRESETS[index].scale;
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+void bench_format_day(int days_from_today, char *buffer, size_t buffer_len) {
+    time_t when = time(NULL) + (time_t)days_from_today * 86400;
+    struct tm tm_when;
+#ifdef _WIN32
+    gmtime_s(&tm_when, &when);
+#else
+    gmtime_r(&when, &tm_when);
+#endif
+    strftime(buffer, buffer_len, "%Y-%m-%d", &tm_when);
+}
+
+static bool bench_step(sqlite3_stmt *stmt, Database *db) {
+    int rc = sqlite3_step(stmt);
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+static bool bench_insert_waiters(Database *db, const BenchScale *scale) {
+    int number = BENCH_SEED_WAITERS + 1;
+    while (number <= scale->waiters) {
+        sqlite3_stmt *stmt = database_prepare(db, BENCH_SQL_USER_INSERT);
+        char username[32];
+        char credentials[64];
+        char hash[65];
+        if (stmt == NULL) {
+            return false;
+        }
+        snprintf(username, sizeof(username), "mozo%d", number);
+        snprintf(credentials, sizeof(credentials), "%s:mozo123", username);
+        hash_sha256_hex((const unsigned char *)credentials, strlen(credentials), hash, sizeof(hash));
+        sqlite3_bind_text(stmt, 1, username, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, hash, -1, SQLITE_TRANSIENT);
+        if (!bench_step(stmt, db)) {
+            return false;
+        }
+        number = number + 1;
+    }
+    return true;
+}
+
+static bool bench_insert_tables(Database *db, const BenchScale *scale) {
+    static const int capacities[] = {2, 4, 4, 6};
+    int number = BENCH_SEED_TABLES + 1;
+    while (number <= scale->tables) {
+        sqlite3_stmt *stmt = database_prepare(db, BENCH_SQL_TABLE_INSERT);
+        char name[32];
+        if (stmt == NULL) {
+            return false;
+        }
+        snprintf(name, sizeof(name), "Mesa %d", number);
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, capacities[number % 4]);
+        if (!bench_step(stmt, db)) {
+            return false;
+        }
+        number = number + 1;
+    }
+    return true;
+}
+
+static bool bench_insert_menu_items(Database *db, const BenchScale *scale, unsigned int *random) {
+    int number = BENCH_SEED_MENU_ITEMS + 1;
+    while (number <= scale->menu_items) {
+        const BenchCategory *category = &BENCH_CATEGORIES[number % 4];
+        sqlite3_stmt *stmt = database_prepare(db, BENCH_SQL_MENU_ITEM_INSERT);
+        char name[64];
+        double price = category->base_price + 100.0 * bench_random_below(random, 20);
+        if (stmt == NULL) {
+            return false;
+        }
+        snprintf(name, sizeof(name), "%s %d", category->category, number);
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, category->category, -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 3, price);
+        sqlite3_bind_double(stmt, 4, (double)(long)(price * 0.4));
+        sqlite3_bind_int(stmt, 5, 50 + bench_random_below(random, 100));
+        sqlite3_bind_text(stmt, 6, category->station, -1, SQLITE_STATIC);
+        if (!bench_step(stmt, db)) {
+            return false;
+        }
+        number = number + 1;
+    }
+    return true;
+}
+
+static bool bench_insert_catalog(Database *db, const BenchScale *scale, unsigned int *random) {
+    if (!database_begin(db)) {
+        return false;
+    }
+    if (!bench_insert_waiters(db, scale) || !bench_insert_tables(db, scale) || !bench_insert_menu_items(db, scale, random)) {
+        database_rollback(db);
+        return false;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    return true;
+}
+
+static void bench_catalog_free(BenchCatalog *catalog) {
+    g_free(catalog->waiter_ids);
+    g_free(catalog->table_ids);
+    dao_free_menu_items(catalog->menu);
+    memset(catalog, 0, sizeof(BenchCatalog));
+}
+
+/* Toma los primeros N de cada lista: con una escala menor que el seed sobra el resto. */
+static bool bench_catalog_load(Database *db, const BenchScale *scale, BenchCatalog *catalog) {
+    User *users = NULL;
+    TableStatus *tables = NULL;
+    int count = 0;
+    int index = 0;
+    memset(catalog, 0, sizeof(BenchCatalog));
+    if (!dao_list_users(db, &users, &count)) {
+        return false;
+    }
+    catalog->waiter_ids = g_new0(int, count > 0 ? count : 1);
+    while (index < count && catalog->waiter_count < scale->waiters) {
+        if (strcmp(users[index].role, "mozo") == 0) {
+            catalog->waiter_ids[catalog->waiter_count] = users[index].id;
+            catalog->waiter_count = catalog->waiter_count + 1;
+        }
+        index = index + 1;
+    }
+    dao_free_users(users);
+    if (!dao_list_tables(db, &tables, &count)) {
+        bench_catalog_free(catalog);
+        return false;
+    }
+    catalog->table_count = MIN(count, scale->tables);
+    catalog->table_ids = g_new0(int, catalog->table_count > 0 ? catalog->table_count : 1);
+    index = 0;
+    while (index < catalog->table_count) {
+        catalog->table_ids[index] = tables[index].id;
+        index = index + 1;
+    }
+    dao_free_tables(tables);
+    if (!dao_list_menu_items(db, &catalog->menu, &count)) {
+        bench_catalog_free(catalog);
+        return false;
+    }
+    catalog->menu_count = MIN(count, scale->menu_items);
+    return catalog->waiter_count > 0 && catalog->table_count > 0 && catalog->menu_count > 0;
+}
+
+static bool bench_insert_history_order(Database *db, const BenchCatalog *catalog, const BenchScale *scale, const char *day, unsigned int *random, BenchDataStats *stats) {
+    sqlite3_stmt *stmt = database_prepare(db, BENCH_SQL_ORDER_INSERT);
+    char created_at[32];
+    char closed_at[32];
+    int minute = 12 * 60 + bench_random_below(random, 11 * 60);
+    int items = 1 + bench_random_below(random, scale->items_per_order * 2 - 1);
+    int order_id;
+    int index = 0;
+    if (stmt == NULL) {
+        return false;
+    }
+    snprintf(created_at, sizeof(created_at), "%s %02d:%02d:00", day, minute / 60, minute % 60);
+    minute = MIN(minute + 45 + bench_random_below(random, 60), 23 * 60 + 59);
+    snprintf(closed_at, sizeof(closed_at), "%s %02d:%02d:00", day, minute / 60, minute % 60);
+    sqlite3_bind_int(stmt, 1, catalog->table_ids[bench_random_below(random, catalog->table_count)]);
+    sqlite3_bind_int(stmt, 2, catalog->waiter_ids[bench_random_below(random, catalog->waiter_count)]);
+    sqlite3_bind_text(stmt, 3, created_at, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4, closed_at, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 5, day, -1, SQLITE_TRANSIENT);
+    if (!bench_step(stmt, db)) {
+        return false;
+    }
+    order_id = (int)sqlite3_last_insert_rowid(db->handle);
+    while (index < items) {
+        const MenuItem *item = &catalog->menu[bench_random_below(random, catalog->menu_count)];
+        stmt = database_prepare(db, BENCH_SQL_ORDER_ITEM_INSERT);
+        if (stmt == NULL) {
+            return false;
+        }
+        sqlite3_bind_int(stmt, 1, order_id);
+        sqlite3_bind_int(stmt, 2, item->id);
+        /* Uno de cada cincuenta se anula: los triggers lo dejan fuera del subtotal. */
+        sqlite3_bind_text(stmt, 3, bench_random_below(random, 50) == 0 ? "anulado" : "servido", -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, BENCH_NOTES[bench_random_below(random, (int)(sizeof(BENCH_NOTES) / sizeof(BENCH_NOTES[0])))], -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 5, item->price);
+        sqlite3_bind_double(stmt, 6, item->cost);
+        if (!bench_step(stmt, db)) {
+            return false;
+        }
+        index = index + 1;
+    }
+    stats->orders = stats->orders + 1;
+    stats->order_items = stats->order_items + items;
+    return true;
+}
+
+/* Un commit por día: lotes grandes sin que el journal crezca sin límite. */
+static bool bench_insert_history(Database *db, const BenchCatalog *catalog, const BenchScale *scale, unsigned int *random, BenchDataStats *stats) {
+    int day_offset = scale->days;
+    while (day_offset >= 1) {
+        char day[16];
+        int order_index = 0;
+        bench_format_day(-day_offset, day, sizeof(day));
+        if (!database_begin(db)) {
+            return false;
+        }
+        while (order_index < scale->orders_per_day) {
+            if (!bench_insert_history_order(db, catalog, scale, day, random, stats)) {
+                database_rollback(db);
+                return false;
+            }
+            order_index = order_index + 1;
+        }
+        if (!database_commit(db)) {
+            database_rollback(db);
+            return false;
+        }
+        day_offset = day_offset - 1;
+    }
+    return true;
+}
+
+/* El servicio en curso: la mitad de las mesas con una comanda abierta y sus ítems pendientes, por el DAO. */
+static bool bench_insert_open_orders(Database *db, const BenchCatalog *catalog, const BenchScale *scale, unsigned int *random, BenchDataStats *stats) {
+    OrderItemRequest *requests = g_new0(OrderItemRequest, scale->items_per_order);
+    int table_index = 0;
+    bool ok = true;
+    while (ok && table_index < MAX(1, catalog->table_count / 2)) {
+        int order_id = 0;
+        int index = 0;
+        ok = dao_create_order(db, catalog->table_ids[table_index], catalog->waiter_ids[table_index % catalog->waiter_count], &order_id);
+        while (ok && index < scale->items_per_order) {
+            requests[index].menu_item_id = catalog->menu[bench_random_below(random, catalog->menu_count)].id;
+            requests[index].notes = "";
+            requests[index].quantity = 1;
+            index = index + 1;
+        }
+        if (ok) {
+            ok = dao_add_items_to_order(db, order_id, requests, scale->items_per_order);
+        }
+        if (ok) {
+            stats->orders = stats->orders + 1;
+            stats->order_items = stats->order_items + scale->items_per_order;
+        }
+        table_index = table_index + 1;
+    }
+    g_free(requests);
+    return ok;
+}
+
+/* Turnos de tres horas desde las 12: hasta cuatro reservas por mesa y día sin choques. */
+static bool bench_insert_reservations(Database *db, const BenchCatalog *catalog, const BenchScale *scale, BenchDataStats *stats) {
+    int per_day = MIN(scale->reservations_per_day, catalog->table_count * 4);
+    int day_offset = -BENCH_RESERVATION_DAYS_BACK;
+    if (!database_begin(db)) {
+        return false;
+    }
+    while (day_offset <= BENCH_RESERVATION_DAYS_AHEAD) {
+        char day[16];
+        int index = 0;
+        bench_format_day(day_offset, day, sizeof(day));
+        while (index < per_day) {
+            char when[32];
+            char name[64];
+            snprintf(when, sizeof(when), "%s %02d:00", day, 12 + 3 * (index / catalog->table_count));
+            snprintf(name, sizeof(name), "Cliente %d", index + 1);
+            if (!dao_create_reservation(db, catalog->table_ids[index % catalog->table_count], name, "123456789", when, "", NULL)) {
+                database_rollback(db);
+                return false;
+            }
+            stats->reservations = stats->reservations + 1;
+            index = index + 1;
+        }
+        day_offset = day_offset + 1;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    return true;
+}
+
+bool bench_data_generate(Database *db, const BenchScale *scale, unsigned int seed, BenchDataStats *stats) {
+    gint64 started = g_get_monotonic_time();
+    unsigned int random = seed == 0 ? 1 : seed;
+    BenchCatalog catalog;
+    bool ok;
+    memset(stats, 0, sizeof(BenchDataStats));
+    if (scale->tables <= 0 || scale->waiters <= 0 || scale->menu_items <= 0 || scale->days < 0 || scale->orders_per_day < 0 || scale->items_per_order <= 0) {
+        return false;
+    }
+    if (!database_seed(db, NULL) || !bench_insert_catalog(db, scale, &random)) {
+        return false;
+    }
+    if (!bench_catalog_load(db, scale, &catalog)) {
+        bench_catalog_free(&catalog);
+        return false;
+    }
+    ok = bench_insert_history(db, &catalog, scale, &random, stats)
+         && bench_insert_open_orders(db, &catalog, scale, &random, stats)
+         && bench_insert_reservations(db, &catalog, scale, stats)
+         && dao_rebuild_rollups(db);
+    bench_catalog_free(&catalog);
+    stats->elapsed_s = (double)(g_get_monotonic_time() - started) / G_USEC_PER_SEC;
+    return ok;
+}
+
+bool bench_data_count(Database *db, BenchDataStats *stats) {
+    sqlite3_stmt *stmt = database_prepare(db, BENCH_SQL_COUNTS);
+    int rc;
+    memset(stats, 0, sizeof(BenchDataStats));
+    if (stmt == NULL) {
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        stats->orders = (long)sqlite3_column_int64(stmt, 0);
+        stats->order_items = (long)sqlite3_column_int64(stmt, 1);
+        stats->reservations = (long)sqlite3_column_int64(stmt, 2);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_ROW;
+}
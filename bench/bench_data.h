@@ -0,0 +1,39 @@
+#ifndef BENCH_DATA_H
+#define BENCH_DATA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "data/database.h"
+
+/* Tamaño del local a simular; days son días de historia cerrada antes de hoy. */
+typedef struct BenchScale {
+    int tables;
+    int waiters;
+    int menu_items;
+    int days;
+    int orders_per_day;
+    int items_per_order;
+    int reservations_per_day;
+} BenchScale;
+
+typedef struct BenchDataStats {
+    long orders;
+    long order_items;
+    long reservations;
+    double elapsed_s;
+} BenchDataStats;
+
+/* "small", "medium" o "large" (~1M ítems de comanda); false si el nombre no existe. */
+bool bench_scale_preset(const char *name, BenchScale *scale);
+/*
+ * Llena una base recién migrada: seed, mozos, mesas, carta, historia cerrada con
+ * un commit por día, comandas abiertas de hoy, reservas y rollups. El mismo seed
+ * genera los mismos datos.
+ */
+bool bench_data_generate(Database *db, const BenchScale *scale, unsigned int seed, BenchDataStats *stats);
+/* 'YYYY-MM-DD' en UTC, como DATE('now'); days_from_today negativo va al pasado. */
+void bench_format_day(int days_from_today, char *buffer, size_t buffer_len);
+/* Cuenta lo que ya tiene una base generada antes (--reuse). */
+bool bench_data_count(Database *db, BenchDataStats *stats);
+
+#endif
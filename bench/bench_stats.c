@@ -0,0 +1,47 @@
+#include "bench_stats.h"
+#include <string.h>
+
+static gint bench_compare_samples(gconstpointer left, gconstpointer right) {
+    gint64 a = *(const gint64 *)left;
+    gint64 b = *(const gint64 *)right;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* Nearest-rank sobre las muestras ya ordenadas. */
+static gint64 bench_percentile(const GArray *samples, double fraction) {
+    double exact = fraction * samples->len;
+    guint rank = (guint)exact;
+    if ((double)rank < exact || rank == 0) {
+        rank = rank + 1;
+    }
+    return g_array_index(samples, gint64, MIN(rank, samples->len) - 1);
+}
+
+void bench_summarize(GArray *samples, BenchSummary *summary) {
+    gint64 total = 0;
+    guint index = 0;
+    memset(summary, 0, sizeof(BenchSummary));
+    if (samples->len == 0) {
+        return;
+    }
+    g_array_sort(samples, bench_compare_samples);
+    while (index < samples->len) {
+        total = total + g_array_index(samples, gint64, index);
+        index = index + 1;
+    }
+    summary->count = samples->len;
+    summary->min_us = g_array_index(samples, gint64, 0);
+    summary->p50_us = bench_percentile(samples, 0.50);
+    summary->p90_us = bench_percentile(samples, 0.90);
+    summary->p99_us = bench_percentile(samples, 0.99);
+    summary->max_us = g_array_index(samples, gint64, samples->len - 1);
+    summary->mean_us = (double)total / samples->len;
+}
+
+void bench_append_summary_json(GString *json, const BenchSummary *summary) {
+    if (summary->count == 0) {
+        return;
+    }
+    g_string_append_printf(json, ", \"min_us\": %lld, \"p50_us\": %lld, \"p90_us\": %lld, \"p99_us\": %lld, \"max_us\": %lld, \"mean_us\": %.1f", (long long)summary->min_us,
+                           (long long)summary->p50_us, (long long)summary->p90_us, (long long)summary->p99_us, (long long)summary->max_us, summary->mean_us);
+}
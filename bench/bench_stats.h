@@ -0,0 +1,22 @@
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <glib.h>
+
+/* Resumen exacto de muestras en microsegundos; los percentiles son nearest-rank. */
+typedef struct BenchSummary {
+    guint count;
+    gint64 min_us;
+    gint64 p50_us;
+    gint64 p90_us;
+    gint64 p99_us;
+    gint64 max_us;
+    double mean_us;
+} BenchSummary;
+
+/* Ordena samples (gint64) en el lugar; sin muestras deja todo en cero. */
+void bench_summarize(GArray *samples, BenchSummary *summary);
+/* Agrega ", \"min_us\": ..." hasta mean_us; no escribe nada si count es 0. */
+void bench_append_summary_json(GString *json, const BenchSummary *summary);
+
+#endif
@@ -0,0 +1,980 @@
+#include "bench_data.h"
+#include "bench_stats.h"
+#include "app_context.h"
+#include "core/auth_service.h"
+#include "core/kitchen_service.h"
+#include "core/order_service.h"
+#include "core/report_service.h"
+#include "core/reservation_service.h"
+#include "data/dao.h"
+#include "data/migrations.h"
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Mide cada función pública dao_* y *_service_* contra una base sintética.
+ * Cada caso corre warmup veces sin medir y después reps veces midiendo; los
+ * percentiles salen de las muestras ordenadas (bench_stats.c), no de
+ * histogramas. La salida es JSON para poder comparar corridas entre commits.
+ */
+
+#define BENCH_STATUS_BATCH 32
+#define BENCH_WINDOW_LIMIT 50
+
+typedef struct BenchOptions {
+    char db_path[512];
+    char output_path[512];
+    char label[64];
+    char filter[64];
+    BenchScale scale;
+    int warmup;
+    int reps;
+    unsigned int seed;
+    bool reuse;
+} BenchOptions;
+
+typedef struct BenchState {
+    AppContext ctx;
+    BenchScale scale;
+    bool in_memory;
+    char work_dir[512];
+    char export_path[1024];
+    char today[16];
+    char yesterday[16];
+    char history_from[16];
+    char range_from[16];
+    char window_from[32];
+    char window_to[32];
+    char book_when[32];
+    /* Comanda abierta de hoy con ítems pendientes: la leen los casos de consulta. */
+    int open_order_id;
+    int open_item_id;
+    /* Comanda donde se acumulan los ítems de los casos de alta. */
+    int scratch_order_id;
+    /* Turnos de reserva ya usados por los casos de alta: cada uno toma el siguiente. */
+    int next_slot;
+    /* Ids que arma prepare para que cada repetición tenga su propia fila. */
+    GArray *fixtures;
+    KitchenFeed idle_feed;
+    long rows;
+} BenchState;
+
+typedef bool (*BenchPrepare)(BenchState *state, int count);
+typedef bool (*BenchRun)(BenchState *state, int iteration);
+
+/* rep_divisor achica warmup y reps de los casos que recorren toda la historia. */
+typedef struct BenchCase {
+    const char *name;
+    BenchPrepare prepare;
+    BenchRun run;
+    int rep_divisor;
+} BenchCase;
+
+/* Visitors: solo cuentan filas para que la lectura no quede optimizada. */
+static bool bench_count_row(void *user_data) {
+    BenchState *state = (BenchState *)user_data;
+    state->rows = state->rows + 1;
+    return true;
+}
+
+static bool bench_count_table(const TableRowView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_menu_item(const MenuItemView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_user(const UserView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_table_version(const char *table_name, int version, void *user_data) {
+    (void)table_name;
+    (void)version;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_order_id(int order_id, void *user_data) {
+    (void)order_id;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_order_summary(const OrderSummaryView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_order_item(const OrderItemView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_daily_report(const DailyReportRowView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_reservation(const ReservationView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static bool bench_count_kitchen_ticket(const KitchenTicketView *row, void *user_data) {
+    (void)row;
+    return bench_count_row(user_data);
+}
+
+static int bench_fixture(BenchState *state, int iteration) {
+    return g_array_index(state->fixtures, int, iteration);
+}
+
+static int bench_table_id(BenchState *state, int iteration) {
+    return 1 + iteration % state->scale.tables;
+}
+
+/* Turnos de tres horas a partir de dentro de un año: nunca chocan con la agenda generada. */
+static void bench_next_slot(BenchState *state, int *table_id, char *when, size_t when_len) {
+    int slot = state->next_slot;
+    int per_day = state->scale.tables * 4;
+    char day[16];
+    state->next_slot = state->next_slot + 1;
+    bench_format_day(365 + slot / per_day, day, sizeof(day));
+    *table_id = 1 + slot % state->scale.tables;
+    snprintf(when, when_len, "%s %02d:00", day, 12 + 3 * ((slot % per_day) / state->scale.tables));
+}
+
+static bool bench_open_order(BenchState *state, int table_id, int *order_id) {
+    OrderItemRequest requests[16];
+    int count = MIN(state->scale.items_per_order, 16);
+    int index = 0;
+    while (index < count) {
+        requests[index].menu_item_id = 1 + (table_id + index) % state->scale.menu_items;
+        requests[index].notes = "";
+        requests[index].quantity = 1;
+        index = index + 1;
+    }
+    return dao_create_order(state->ctx.db, table_id, 2, order_id) && dao_add_items_to_order(state->ctx.db, *order_id, requests, count);
+}
+
+static bool bench_prepare_orders(BenchState *state, int count) {
+    int index = 0;
+    while (index < count) {
+        int order_id = 0;
+        if (!bench_open_order(state, bench_table_id(state, index), &order_id)) {
+            return false;
+        }
+        g_array_append_val(state->fixtures, order_id);
+        index = index + 1;
+    }
+    return true;
+}
+
+static bool bench_collect_item(const OrderItemView *row, void *user_data) {
+    g_array_append_val(((BenchState *)user_data)->fixtures, row->id);
+    return true;
+}
+
+/* Ítems de una comanda propia para los cambios de estado; alcanza con un lote. */
+static bool bench_prepare_items(BenchState *state, int count) {
+    int order_id = 0;
+    int added = 0;
+    (void)count;
+    if (!dao_create_order(state->ctx.db, 1, 2, &order_id)) {
+        return false;
+    }
+    while (added < BENCH_STATUS_BATCH) {
+        if (!dao_add_item_to_order(state->ctx.db, order_id, 1 + added % state->scale.menu_items, "")) {
+            return false;
+        }
+        added = added + 1;
+    }
+    return dao_visit_order_items(state->ctx.db, order_id, bench_collect_item, state);
+}
+
+static bool bench_prepare_reservations(BenchState *state, int count) {
+    int index = 0;
+    while (index < count) {
+        int table_id = 0;
+        int reservation_id = 0;
+        char when[32];
+        bench_next_slot(state, &table_id, when, sizeof(when));
+        if (!dao_create_reservation(state->ctx.db, table_id, "Cliente Bench", "", when, "", &reservation_id)) {
+            return false;
+        }
+        g_array_append_val(state->fixtures, reservation_id);
+        index = index + 1;
+    }
+    return true;
+}
+
+static bool bench_dao_get_user_by_username(BenchState *state, int iteration) {
+    User user;
+    (void)iteration;
+    return dao_get_user_by_username(state->ctx.db, "mozo1", &user);
+}
+
+static bool bench_dao_visit_tables(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_tables(state->ctx.db, bench_count_table, state);
+}
+
+static bool bench_dao_visit_menu_items(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_menu_items(state->ctx.db, bench_count_menu_item, state);
+}
+
+static bool bench_dao_visit_users(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_users(state->ctx.db, bench_count_user, state);
+}
+
+static bool bench_dao_visit_table_versions(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_table_versions(state->ctx.db, bench_count_table_version, state);
+}
+
+static bool bench_dao_get_data_version(BenchState *state, int iteration) {
+    int data_version = 0;
+    (void)iteration;
+    return dao_get_data_version(state->ctx.db, &data_version);
+}
+
+static bool bench_dao_visit_open_orders(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_open_orders(state->ctx.db, bench_count_order_id, state);
+}
+
+static bool bench_dao_visit_open_order_summaries(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_open_order_summaries(state->ctx.db, bench_count_order_summary, state);
+}
+
+static bool bench_dao_visit_order_items(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_order_items(state->ctx.db, state->open_order_id, bench_count_order_item, state);
+}
+
+static bool bench_dao_get_open_order_summary(BenchState *state, int iteration) {
+    OrderSummaryView summary;
+    bool found = false;
+    (void)iteration;
+    return dao_get_open_order_summary(state->ctx.db, state->open_order_id, &summary, &found) && found;
+}
+
+static bool bench_dao_visit_order_item(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_order_item(state->ctx.db, state->open_item_id, bench_count_order_item, state);
+}
+
+static bool bench_dao_visit_kitchen_tickets(BenchState *state, int iteration) {
+    long long seq = 0;
+    (void)iteration;
+    return dao_visit_kitchen_tickets(state->ctx.db, "", -1, bench_count_kitchen_ticket, state, &seq);
+}
+
+static bool bench_dao_visit_reservations(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_reservations(state->ctx.db, bench_count_reservation, state);
+}
+
+static bool bench_dao_visit_reservations_window(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_reservations_window(state->ctx.db, state->window_from, state->window_to, NULL, BENCH_WINDOW_LIMIT, bench_count_reservation, state);
+}
+
+static bool bench_dao_list_tables(BenchState *state, int iteration) {
+    TableStatus *tables = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_tables(state->ctx.db, &tables, &count)) {
+        return false;
+    }
+    dao_free_tables(tables);
+    return true;
+}
+
+static bool bench_dao_list_menu_items(BenchState *state, int iteration) {
+    MenuItem *items = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_menu_items(state->ctx.db, &items, &count)) {
+        return false;
+    }
+    dao_free_menu_items(items);
+    return true;
+}
+
+static bool bench_dao_list_users(BenchState *state, int iteration) {
+    User *users = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_users(state->ctx.db, &users, &count)) {
+        return false;
+    }
+    dao_free_users(users);
+    return true;
+}
+
+static bool bench_dao_list_open_orders(BenchState *state, int iteration) {
+    int *order_ids = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_open_orders(state->ctx.db, &order_ids, &count)) {
+        return false;
+    }
+    dao_free_order_ids(order_ids);
+    return true;
+}
+
+static bool bench_dao_list_order_items(BenchState *state, int iteration) {
+    OrderItem *items = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_order_items(state->ctx.db, state->open_order_id, &items, &count)) {
+        return false;
+    }
+    dao_free_order_items(items);
+    return true;
+}
+
+static bool bench_dao_list_reservations(BenchState *state, int iteration) {
+    Reservation *reservations = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_reservations(state->ctx.db, &reservations, &count)) {
+        return false;
+    }
+    dao_free_reservations(reservations);
+    return true;
+}
+
+static bool bench_dao_list_reservations_window(BenchState *state, int iteration) {
+    Reservation *reservations = NULL;
+    int count = 0;
+    (void)iteration;
+    if (!dao_list_reservations_window(state->ctx.db, state->window_from, state->window_to, NULL, BENCH_WINDOW_LIMIT, &reservations, &count)) {
+        return false;
+    }
+    dao_free_reservations(reservations);
+    return true;
+}
+
+/* Los dao_query_* se miden junto con dao_result_set_free, como los usa la UI. */
+static bool bench_result_set_done(DaoResultSet *set, bool ok) {
+    dao_result_set_free(set);
+    return ok;
+}
+
+static bool bench_dao_query_tables(BenchState *state, int iteration) {
+    DaoResultSet set;
+    (void)iteration;
+    return bench_result_set_done(&set, dao_query_tables(state->ctx.db, &set));
+}
+
+static bool bench_dao_query_menu_items(BenchState *state, int iteration) {
+    DaoResultSet set;
+    (void)iteration;
+    return bench_result_set_done(&set, dao_query_menu_items(state->ctx.db, &set));
+}
+
+static bool bench_dao_query_open_orders(BenchState *state, int iteration) {
+    DaoResultSet set;
+    (void)iteration;
+    return bench_result_set_done(&set, dao_query_open_orders(state->ctx.db, &set));
+}
+
+static bool bench_dao_query_order_items(BenchState *state, int iteration) {
+    DaoResultSet set;
+    (void)iteration;
+    return bench_result_set_done(&set, dao_query_order_items(state->ctx.db, state->open_order_id, &set));
+}
+
+static bool bench_dao_query_reservations(BenchState *state, int iteration) {
+    DaoResultSet set;
+    (void)iteration;
+    return bench_result_set_done(&set, dao_query_reservations(state->ctx.db, &set));
+}
+
+static bool bench_dao_sum_daily_sales(BenchState *state, int iteration) {
+    SalesTotals totals;
+    (void)iteration;
+    return dao_sum_daily_sales(state->ctx.db, state->history_from, state->today, &totals);
+}
+
+static bool bench_dao_visit_daily_report(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_visit_daily_report(state->ctx.db, state->yesterday, bench_count_daily_report, state);
+}
+
+static bool bench_dao_export_daily_report(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_export_daily_report(state->ctx.db, state->yesterday, state->export_path);
+}
+
+static bool bench_dao_calculate_order_totals(BenchState *state, int iteration) {
+    double subtotal = 0.0;
+    double tax = 0.0;
+    double total = 0.0;
+    (void)iteration;
+    return dao_calculate_order_totals(state->ctx.db, state->open_order_id, 0.21, 0.1, 0.0, &subtotal, &tax, &total);
+}
+
+static bool bench_dao_create_order(BenchState *state, int iteration) {
+    int order_id = 0;
+    return dao_create_order(state->ctx.db, bench_table_id(state, iteration), 2, &order_id);
+}
+
+static bool bench_dao_add_item_to_order(BenchState *state, int iteration) {
+    return dao_add_item_to_order(state->ctx.db, state->scratch_order_id, 1 + iteration % state->scale.menu_items, "");
+}
+
+static bool bench_dao_add_items_to_order(BenchState *state, int iteration) {
+    OrderItemRequest requests[16];
+    int count = MIN(state->scale.items_per_order, 16);
+    int index = 0;
+    while (index < count) {
+        requests[index].menu_item_id = 1 + (iteration + index) % state->scale.menu_items;
+        requests[index].notes = "";
+        requests[index].quantity = 1;
+        index = index + 1;
+    }
+    return dao_add_items_to_order(state->ctx.db, state->scratch_order_id, requests, count);
+}
+
+/* Alterna entre dos estados para que cada repetición cambie la fila de verdad. */
+static const char *bench_toggle_status(int iteration) {
+    return iteration % 2 == 0 ? "preparacion" : "listo";
+}
+
+static bool bench_dao_update_order_item_status(BenchState *state, int iteration) {
+    int item_id = bench_fixture(state, iteration % (int)state->fixtures->len);
+    return dao_update_order_item_status(state->ctx.db, item_id, bench_toggle_status(iteration / (int)state->fixtures->len));
+}
+
+static bool bench_dao_update_order_item_statuses(BenchState *state, int iteration) {
+    OrderItemStatusChange changes[BENCH_STATUS_BATCH];
+    int count = MIN((int)state->fixtures->len, BENCH_STATUS_BATCH);
+    int applied = 0;
+    int index = 0;
+    while (index < count) {
+        changes[index].order_item_id = bench_fixture(state, index);
+        g_strlcpy(changes[index].status, bench_toggle_status(iteration), sizeof(changes[index].status));
+        index = index + 1;
+    }
+    return dao_update_order_item_statuses(state->ctx.db, changes, count, &applied);
+}
+
+static bool bench_dao_close_order(BenchState *state, int iteration) {
+    return dao_close_order(state->ctx.db, bench_fixture(state, iteration));
+}
+
+static bool bench_dao_create_reservation(BenchState *state, int iteration) {
+    int table_id = 0;
+    char when[32];
+    (void)iteration;
+    bench_next_slot(state, &table_id, when, sizeof(when));
+    return dao_create_reservation(state->ctx.db, table_id, "Cliente Bench", "123456789", when, "", NULL);
+}
+
+static bool bench_dao_cancel_reservation(BenchState *state, int iteration) {
+    return dao_cancel_reservation(state->ctx.db, bench_fixture(state, iteration));
+}
+
+static bool bench_dao_rebuild_rollups(BenchState *state, int iteration) {
+    (void)iteration;
+    return dao_rebuild_rollups(state->ctx.db);
+}
+
+static bool bench_auth_check_credentials(BenchState *state, int iteration) {
+    User user;
+    (void)iteration;
+    return auth_check_credentials(state->ctx.db, "mozo1", "mozo123", &user) == AUTH_RESULT_OK;
+}
+
+static bool bench_auth_login(BenchState *state, int iteration) {
+    User user;
+    (void)iteration;
+    return auth_login(&state->ctx, "mozo1", "mozo123", &user);
+}
+
+static bool bench_order_service_calculate_totals(BenchState *state, int iteration) {
+    double subtotal = 0.0;
+    double tax = 0.0;
+    double total = 0.0;
+    (void)iteration;
+    return order_service_calculate_totals(&state->ctx, state->open_order_id, 0.1, 0.0, &subtotal, &tax, &total);
+}
+
+static bool bench_order_service_pending_status(BenchState *state, int iteration) {
+    char status[16];
+    (void)iteration;
+    order_service_pending_status(&state->ctx, state->open_item_id, status, sizeof(status));
+    return true;
+}
+
+/* Sondeo con una pantalla recién abierta: visita todos los pendientes. */
+static bool bench_kitchen_service_poll_full(BenchState *state, int iteration) {
+    KitchenFeed feed;
+    bool changed = false;
+    (void)iteration;
+    kitchen_feed_init(&feed, "");
+    return kitchen_service_poll(state->ctx.db, &feed, bench_count_kitchen_ticket, state, &changed) && changed;
+}
+
+/* Sondeo sin cambios desde el anterior: el caso de todos los ticks en reposo. */
+static bool bench_kitchen_service_poll_idle(BenchState *state, int iteration) {
+    bool changed = false;
+    (void)iteration;
+    return kitchen_service_poll(state->ctx.db, &state->idle_feed, bench_count_kitchen_ticket, state, &changed);
+}
+
+static bool bench_reservation_book_table_free(BenchState *state, int iteration) {
+    bool is_free = false;
+    int conflict_id = 0;
+    return reservation_book_table_free(&state->ctx.reservations, state->ctx.db, bench_table_id(state, iteration), state->book_when, 0, &is_free, &conflict_id);
+}
+
+static bool bench_reservation_book_free_tables(BenchState *state, int iteration) {
+    GArray *table_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    bool ok = reservation_book_free_tables(&state->ctx.reservations, state->ctx.db, state->book_when, 0, 2 + iteration % 4, table_ids);
+    g_array_unref(table_ids);
+    return ok;
+}
+
+static bool bench_report_service_export_daily(BenchState *state, int iteration) {
+    (void)iteration;
+    return report_service_export_daily(&state->ctx, state->yesterday, state->export_path);
+}
+
+/* Los hilos abren conexiones propias sobre el archivo: en memoria no hay qué leer. */
+static bool bench_report_service_export_range(BenchState *state, int iteration) {
+    ReportRangeStats stats;
+    (void)iteration;
+    return report_service_export_range(&state->ctx, state->range_from, state->yesterday, true, state->work_dir, &stats);
+}
+
+static bool bench_order_service_create(BenchState *state, int iteration) {
+    int order_id = 0;
+    return order_service_create(&state->ctx, bench_table_id(state, iteration), 2, &order_id);
+}
+
+static bool bench_order_service_add_item(BenchState *state, int iteration) {
+    return order_service_add_item(&state->ctx, state->scratch_order_id, 1 + iteration % state->scale.menu_items, "");
+}
+
+static bool bench_order_service_add_items(BenchState *state, int iteration) {
+    OrderItemRequest requests[16];
+    int count = MIN(state->scale.items_per_order, 16);
+    int index = 0;
+    while (index < count) {
+        requests[index].menu_item_id = 1 + (iteration + index) % state->scale.menu_items;
+        requests[index].notes = "";
+        requests[index].quantity = 1;
+        index = index + 1;
+    }
+    return order_service_add_items(&state->ctx, state->scratch_order_id, requests, count);
+}
+
+/* Con la cola prendida casi siempre solo encola; cada max_entries llamadas paga el flush. */
+static bool bench_order_service_update_status(BenchState *state, int iteration) {
+    int item_id = bench_fixture(state, iteration % (int)state->fixtures->len);
+    return order_service_update_status(&state->ctx, item_id, bench_toggle_status(iteration / (int)state->fixtures->len));
+}
+
+/* Encolar el lote es parte de la medición, pero cuesta poco al lado de la escritura. */
+static bool bench_order_service_flush_statuses(BenchState *state, int iteration) {
+    gint64 now = g_get_monotonic_time();
+    int index = 0;
+    while (index < (int)state->fixtures->len) {
+        status_queue_put(&state->ctx.statuses, bench_fixture(state, index), bench_toggle_status(iteration), now);
+        index = index + 1;
+    }
+    return order_service_flush_statuses(&state->ctx);
+}
+
+static bool bench_order_service_close(BenchState *state, int iteration) {
+    return order_service_close(&state->ctx, bench_fixture(state, iteration));
+}
+
+static bool bench_reservation_book_create(BenchState *state, int iteration) {
+    int table_id = 0;
+    int reservation_id = 0;
+    int conflict_id = 0;
+    char when[32];
+    (void)iteration;
+    bench_next_slot(state, &table_id, when, sizeof(when));
+    return reservation_book_create(&state->ctx.reservations, state->ctx.db, table_id, "Cliente Bench", "123456789", when, "", &reservation_id, &conflict_id);
+}
+
+static bool bench_reservation_book_cancel(BenchState *state, int iteration) {
+    return reservation_book_cancel(&state->ctx.reservations, state->ctx.db, bench_fixture(state, iteration));
+}
+
+static bool bench_report_service_rebuild_rollups(BenchState *state, int iteration) {
+    (void)iteration;
+    return report_service_rebuild_rollups(&state->ctx);
+}
+
+/*
+ * Primero las lecturas, con la base tal como quedó generada; después las
+ * escrituras, que agregan comandas y reservas; al final lo que recorre toda la
+ * historia. Quedan afuera dao_free_* y dao_result_set_memory (se miden dentro
+ * de los list/query), auth_log_result, kitchen_service_next_status y
+ * reservation_parse_minutes, que no tocan la base.
+ */
+static const BenchCase BENCH_CASES[] = {
+    {"dao_get_user_by_username", NULL, bench_dao_get_user_by_username, 1},
+    {"dao_visit_tables", NULL, bench_dao_visit_tables, 1},
+    {"dao_visit_menu_items", NULL, bench_dao_visit_menu_items, 1},
+    {"dao_visit_users", NULL, bench_dao_visit_users, 1},
+    {"dao_visit_table_versions", NULL, bench_dao_visit_table_versions, 1},
+    {"dao_get_data_version", NULL, bench_dao_get_data_version, 1},
+    {"dao_visit_open_orders", NULL, bench_dao_visit_open_orders, 1},
+    {"dao_visit_open_order_summaries", NULL, bench_dao_visit_open_order_summaries, 1},
+    {"dao_visit_order_items", NULL, bench_dao_visit_order_items, 1},
+    {"dao_get_open_order_summary", NULL, bench_dao_get_open_order_summary, 1},
+    {"dao_visit_order_item", NULL, bench_dao_visit_order_item, 1},
+    {"dao_visit_kitchen_tickets", NULL, bench_dao_visit_kitchen_tickets, 1},
+    {"dao_visit_reservations", NULL, bench_dao_visit_reservations, 1},
+    {"dao_visit_reservations_window", NULL, bench_dao_visit_reservations_window, 1},
+    {"dao_list_tables", NULL, bench_dao_list_tables, 1},
+    {"dao_list_menu_items", NULL, bench_dao_list_menu_items, 1},
+    {"dao_list_users", NULL, bench_dao_list_users, 1},
+    {"dao_list_open_orders", NULL, bench_dao_list_open_orders, 1},
+    {"dao_list_order_items", NULL, bench_dao_list_order_items, 1},
+    {"dao_list_reservations", NULL, bench_dao_list_reservations, 1},
+    {"dao_list_reservations_window", NULL, bench_dao_list_reservations_window, 1},
+    {"dao_query_tables", NULL, bench_dao_query_tables, 1},
+    {"dao_query_menu_items", NULL, bench_dao_query_menu_items, 1},
+    {"dao_query_open_orders", NULL, bench_dao_query_open_orders, 1},
+    {"dao_query_order_items", NULL, bench_dao_query_order_items, 1},
+    {"dao_query_reservations", NULL, bench_dao_query_reservations, 1},
+    {"dao_sum_daily_sales", NULL, bench_dao_sum_daily_sales, 1},
+    {"dao_visit_daily_report", NULL, bench_dao_visit_daily_report, 1},
+    {"dao_export_daily_report", NULL, bench_dao_export_daily_report, 1},
+    {"dao_calculate_order_totals", NULL, bench_dao_calculate_order_totals, 1},
+    {"auth_check_credentials", NULL, bench_auth_check_credentials, 1},
+    {"auth_login", NULL, bench_auth_login, 1},
+    {"order_service_calculate_totals", NULL, bench_order_service_calculate_totals, 1},
+    {"order_service_pending_status", NULL, bench_order_service_pending_status, 1},
+    {"kitchen_service_poll_full", NULL, bench_kitchen_service_poll_full, 1},
+    {"kitchen_service_poll_idle", NULL, bench_kitchen_service_poll_idle, 1},
+    {"reservation_book_table_free", NULL, bench_reservation_book_table_free, 1},
+    {"reservation_book_free_tables", NULL, bench_reservation_book_free_tables, 1},
+    {"report_service_export_daily", NULL, bench_report_service_export_daily, 1},
+    {"report_service_export_range", NULL, bench_report_service_export_range, 10},
+    {"dao_create_order", NULL, bench_dao_create_order, 1},
+    {"dao_add_item_to_order", NULL, bench_dao_add_item_to_order, 1},
+    {"dao_add_items_to_order", NULL, bench_dao_add_items_to_order, 1},
+    {"dao_update_order_item_status", bench_prepare_items, bench_dao_update_order_item_status, 1},
+    {"dao_update_order_item_statuses", bench_prepare_items, bench_dao_update_order_item_statuses, 1},
+    {"dao_close_order", bench_prepare_orders, bench_dao_close_order, 1},
+    {"dao_create_reservation", NULL, bench_dao_create_reservation, 1},
+    {"dao_cancel_reservation", bench_prepare_reservations, bench_dao_cancel_reservation, 1},
+    {"order_service_create", NULL, bench_order_service_create, 1},
+    {"order_service_add_item", NULL, bench_order_service_add_item, 1},
+    {"order_service_add_items", NULL, bench_order_service_add_items, 1},
+    {"order_service_update_status", bench_prepare_items, bench_order_service_update_status, 1},
+    {"order_service_flush_statuses", bench_prepare_items, bench_order_service_flush_statuses, 1},
+    {"order_service_close", bench_prepare_orders, bench_order_service_close, 1},
+    {"reservation_book_create", NULL, bench_reservation_book_create, 1},
+    {"reservation_book_cancel", bench_prepare_reservations, bench_reservation_book_cancel, 1},
+    {"dao_rebuild_rollups", NULL, bench_dao_rebuild_rollups, 20},
+    {"report_service_rebuild_rollups", NULL, bench_report_service_rebuild_rollups, 20}
+};
+
+static void bench_append_result(GString *json, const char *name, const BenchSummary *summary, int warmup, int failures, bool *first) {
+    g_string_append_printf(json, "%s\n    {\"name\": \"%s\", \"warmup\": %d, \"reps\": %u, \"failures\": %d", *first ? "" : ",", name, warmup, summary->count, failures);
+    bench_append_summary_json(json, summary);
+    g_string_append(json, "}");
+    *first = false;
+}
+
+static bool bench_run_case(BenchState *state, const BenchCase *bench_case, const BenchOptions *options, GString *json, bool *first) {
+    int warmup = options->warmup / bench_case->rep_divisor;
+    int reps = MAX(1, options->reps / bench_case->rep_divisor);
+    int failures = 0;
+    int iteration = 0;
+    BenchSummary summary;
+    GArray *samples = g_array_new(FALSE, FALSE, sizeof(gint64));
+    g_array_set_size(state->fixtures, 0);
+    if (bench_case->prepare != NULL && !bench_case->prepare(state, warmup + reps)) {
+        fprintf(stderr, "%s: no se pudieron preparar los datos\n", bench_case->name);
+        g_array_unref(samples);
+        return false;
+    }
+    fprintf(stderr, "%-34s", bench_case->name);
+    while (iteration < warmup + reps) {
+        gint64 started = g_get_monotonic_time();
+        bool ok = bench_case->run(state, iteration);
+        gint64 elapsed = g_get_monotonic_time() - started;
+        if (!ok) {
+            failures = failures + 1;
+        } else if (iteration >= warmup) {
+            g_array_append_val(samples, elapsed);
+        }
+        iteration = iteration + 1;
+    }
+    bench_summarize(samples, &summary);
+    bench_append_result(json, bench_case->name, &summary, warmup, failures, first);
+    if (summary.count > 0) {
+        fprintf(stderr, " p50 %8lld us  p99 %8lld us%s\n", (long long)summary.p50_us, (long long)summary.p99_us, failures > 0 ? "  (con fallas)" : "");
+    } else {
+        fprintf(stderr, " sin muestras\n");
+    }
+    g_array_unref(samples);
+    return failures == 0;
+}
+
+static bool bench_first_open_item(const OrderItemView *row, void *user_data) {
+    ((BenchState *)user_data)->open_item_id = row->id;
+    return false;
+}
+
+static bool bench_state_prepare(BenchState *state) {
+    int *order_ids = NULL;
+    int count = 0;
+    char day[16];
+    bench_format_day(0, state->today, sizeof(state->today));
+    bench_format_day(-1, state->yesterday, sizeof(state->yesterday));
+    bench_format_day(-MAX(1, state->scale.days), state->history_from, sizeof(state->history_from));
+    bench_format_day(-MIN(7, MAX(1, state->scale.days)), state->range_from, sizeof(state->range_from));
+    bench_format_day(-7, day, sizeof(day));
+    snprintf(state->window_from, sizeof(state->window_from), "%s 00:00", day);
+    bench_format_day(14, day, sizeof(day));
+    snprintf(state->window_to, sizeof(state->window_to), "%s 00:00", day);
+    bench_format_day(2, day, sizeof(day));
+    snprintf(state->book_when, sizeof(state->book_when), "%s 20:00", day);
+    snprintf(state->export_path, sizeof(state->export_path), "%s/reporte.csv", state->work_dir);
+    if (!dao_list_open_orders(state->ctx.db, &order_ids, &count) || count == 0) {
+        dao_free_order_ids(order_ids);
+        return false;
+    }
+    state->open_order_id = order_ids[0];
+    dao_free_order_ids(order_ids);
+    if (!dao_visit_order_items(state->ctx.db, state->open_order_id, bench_first_open_item, state) || state->open_item_id == 0) {
+        return false;
+    }
+    if (!bench_open_order(state, 1, &state->scratch_order_id)) {
+        return false;
+    }
+    kitchen_feed_init(&state->idle_feed, "");
+    state->fixtures = g_array_new(FALSE, FALSE, sizeof(int));
+    return true;
+}
+
+/* Borra lo que dejaron los reportes; el directorio es propio de esta corrida. */
+static void bench_remove_work_dir(const char *path) {
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const char *name = NULL;
+    if (dir == NULL) {
+        return;
+    }
+    name = g_dir_read_name(dir);
+    while (name != NULL) {
+        char *file = g_build_filename(path, name, NULL);
+        g_remove(file);
+        g_free(file);
+        name = g_dir_read_name(dir);
+    }
+    g_dir_close(dir);
+    g_rmdir(path);
+}
+
+static bool bench_parse_int(const char *text, int *value) {
+    char *end = NULL;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0 || parsed > G_MAXINT) {
+        return false;
+    }
+    *value = (int)parsed;
+    return true;
+}
+
+static void bench_usage(void) {
+    fprintf(stderr,
+            "Uso: restaurant_bench [opciones]\n"
+            "  --db=RUTA               base a generar (:memory: por defecto; en disco no debe existir)\n"
+            "  --reuse                 usa la base de --db tal como está, sin generar\n"
+            "  --scale=small|medium|large\n"
+            "  --tables=N --waiters=N --menu-items=N --days=N\n"
+            "  --orders-per-day=N --items-per-order=N --reservations-per-day=N\n"
+            "  --warmup=N --reps=N --seed=N\n"
+            "  --filter=TEXTO          solo los casos cuyo nombre contiene TEXTO\n"
+            "  --output=RUTA           JSON a un archivo en vez de stdout\n"
+            "  --label=TEXTO           etiqueta libre (commit, máquina) dentro del JSON\n");
+}
+
+static bool bench_parse_args(int argc, char **argv, BenchOptions *options) {
+    int arg_index = 1;
+    memset(options, 0, sizeof(BenchOptions));
+    strcpy(options->db_path, ":memory:");
+    bench_scale_preset("medium", &options->scale);
+    options->warmup = 10;
+    options->reps = 100;
+    options->seed = 42;
+    while (arg_index < argc) {
+        const char *arg = argv[arg_index];
+        const char *value = strchr(arg, '=');
+        bool ok = true;
+        value = value == NULL ? "" : value + 1;
+        if (strncmp(arg, "--db=", 5) == 0) {
+            g_strlcpy(options->db_path, value, sizeof(options->db_path));
+        } else if (strcmp(arg, "--reuse") == 0) {
+            options->reuse = true;
+        } else if (strncmp(arg, "--scale=", 8) == 0) {
+            ok = bench_scale_preset(value, &options->scale);
+        } else if (strncmp(arg, "--tables=", 9) == 0) {
+            ok = bench_parse_int(value, &options->scale.tables);
+        } else if (strncmp(arg, "--waiters=", 10) == 0) {
+            ok = bench_parse_int(value, &options->scale.waiters);
+        } else if (strncmp(arg, "--menu-items=", 13) == 0) {
+            ok = bench_parse_int(value, &options->scale.menu_items);
+        } else if (strncmp(arg, "--days=", 7) == 0) {
+            ok = bench_parse_int(value, &options->scale.days);
+        } else if (strncmp(arg, "--orders-per-day=", 17) == 0) {
+            ok = bench_parse_int(value, &options->scale.orders_per_day);
+        } else if (strncmp(arg, "--items-per-order=", 18) == 0) {
+            ok = bench_parse_int(value, &options->scale.items_per_order);
+        } else if (strncmp(arg, "--reservations-per-day=", 23) == 0) {
+            ok = bench_parse_int(value, &options->scale.reservations_per_day);
+        } else if (strncmp(arg, "--warmup=", 9) == 0) {
+            ok = bench_parse_int(value, &options->warmup);
+        } else if (strncmp(arg, "--reps=", 7) == 0) {
+            ok = bench_parse_int(value, &options->reps) && options->reps > 0;
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            int seed = 0;
+            ok = bench_parse_int(value, &seed);
+            options->seed = (unsigned int)seed;
+        } else if (strncmp(arg, "--filter=", 9) == 0) {
+            g_strlcpy(options->filter, value, sizeof(options->filter));
+        } else if (strncmp(arg, "--output=", 9) == 0) {
+            g_strlcpy(options->output_path, value, sizeof(options->output_path));
+        } else if (strncmp(arg, "--label=", 8) == 0) {
+            g_strlcpy(options->label, value, sizeof(options->label));
+            /* Va tal cual dentro de una cadena JSON. */
+            g_strdelimit(options->label, "\"\\", '_');
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Opción inválida: %s\n", arg);
+            return false;
+        }
+        arg_index = arg_index + 1;
+    }
+    /* Las escrituras reparten mesas y turnos con módulo: hacen falta al menos una mesa y un plato. */
+    return options->scale.tables > 0 && options->scale.menu_items > 0 && options->scale.waiters > 0 && options->scale.items_per_order > 0;
+}
+
+static bool bench_open_database(BenchState *state, const BenchOptions *options, BenchDataStats *stats) {
+    AppContext *ctx = &state->ctx;
+    state->in_memory = strcmp(options->db_path, ":memory:") == 0;
+    if (!state->in_memory && !options->reuse && g_file_test(options->db_path, G_FILE_TEST_EXISTS)) {
+        fprintf(stderr, "%s ya existe: usar --reuse o borrarla\n", options->db_path);
+        return false;
+    }
+    g_strlcpy(ctx->config.database_path, options->db_path, sizeof(ctx->config.database_path));
+    if (!database_open(&ctx->db, options->db_path, &ctx->config.storage, &ctx->logger)) {
+        return false;
+    }
+    if (!database_apply_migrations(ctx->db, MIGRATIONS, MIGRATION_COUNT, &ctx->logger)) {
+        return false;
+    }
+    if (options->reuse && !state->in_memory) {
+        return bench_data_count(ctx->db, stats);
+    }
+    fprintf(stderr, "Generando datos...\n");
+    return bench_data_generate(ctx->db, &state->scale, options->seed, stats);
+}
+
+static void bench_append_header(GString *json, const BenchOptions *options, const BenchDataStats *stats) {
+    const BenchScale *scale = &options->scale;
+    g_string_append_printf(json, "{\n  \"label\": \"%s\",\n  \"sqlite_version\": \"%s\",\n  \"database\": \"%s\",\n", options->label, sqlite3_libversion(),
+                           strcmp(options->db_path, ":memory:") == 0 ? "memory" : "file");
+    g_string_append_printf(json, "  \"seed\": %u,\n  \"warmup\": %d,\n  \"reps\": %d,\n", options->seed, options->warmup, options->reps);
+    g_string_append_printf(json, "  \"scale\": {\"tables\": %d, \"waiters\": %d, \"menu_items\": %d, \"days\": %d, \"orders_per_day\": %d, \"items_per_order\": %d, \"reservations_per_day\": %d},\n",
+                           scale->tables, scale->waiters, scale->menu_items, scale->days, scale->orders_per_day, scale->items_per_order, scale->reservations_per_day);
+    g_string_append_printf(json, "  \"data\": {\"orders\": %ld, \"order_items\": %ld, \"reservations\": %ld, \"generate_s\": %.2f, \"reused\": %s},\n  \"results\": [",
+                           stats->orders, stats->order_items, stats->reservations, stats->elapsed_s, options->reuse && strcmp(options->db_path, ":memory:") != 0 ? "true" : "false");
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    BenchState state;
+    BenchDataStats stats;
+    GString *json = NULL;
+    char *work_dir = NULL;
+    size_t index = 0;
+    bool first = true;
+    bool ok = true;
+    if (!bench_parse_args(argc, argv, &options)) {
+        bench_usage();
+        return 2;
+    }
+    memset(&state, 0, sizeof(BenchState));
+    state.scale = options.scale;
+    metrics_init(&state.ctx.metrics);
+    config_default(&state.ctx.config);
+    status_queue_init(&state.ctx.statuses);
+    reservation_book_init(&state.ctx.reservations, state.ctx.config.reservation_seating_min);
+    work_dir = g_dir_make_tmp("restaurant_bench_XXXXXX", NULL);
+    if (work_dir == NULL || !logger_init(&state.ctx.logger, work_dir, LOG_LEVEL_ERROR)) {
+        fprintf(stderr, "No se pudo crear el directorio de trabajo\n");
+        return 1;
+    }
+    g_strlcpy(state.work_dir, work_dir, sizeof(state.work_dir));
+    g_free(work_dir);
+    if (!bench_open_database(&state, &options, &stats) || !bench_state_prepare(&state)) {
+        fprintf(stderr, "No se pudo preparar la base\n");
+        ok = false;
+    }
+    if (ok) {
+        fprintf(stderr, "%ld comandas, %ld ítems, %ld reservas (%.1f s)\n", stats.orders, stats.order_items, stats.reservations, stats.elapsed_s);
+        /* Con --reuse las corridas anteriores ya ocuparon los primeros turnos. */
+        state.next_slot = (int)stats.reservations;
+        /* Con métricas, como en la app: el costo de registrarlas entra en cada medición. */
+        database_set_metrics(state.ctx.db, &state.ctx.metrics);
+        json = g_string_new(NULL);
+        bench_append_header(json, &options, &stats);
+        while (index < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0])) {
+            const BenchCase *bench_case = &BENCH_CASES[index];
+            bool skipped = options.filter[0] != '\0' && strstr(bench_case->name, options.filter) == NULL;
+            if (!skipped && state.in_memory && bench_case->run == bench_report_service_export_range) {
+                fprintf(stderr, "%-34s se omite con :memory:\n", bench_case->name);
+                skipped = true;
+            }
+            if (!skipped && !bench_run_case(&state, bench_case, &options, json, &first)) {
+                ok = false;
+            }
+            index = index + 1;
+        }
+        g_string_append(json, "\n  ]\n}\n");
+        if (options.output_path[0] != '\0') {
+            if (!g_file_set_contents(options.output_path, json->str, (gssize)json->len, NULL)) {
+                fprintf(stderr, "No se pudo escribir %s\n", options.output_path);
+                ok = false;
+            }
+        } else {
+            fputs(json->str, stdout);
+        }
+        g_string_free(json, TRUE);
+    }
+    if (state.fixtures != NULL) {
+        g_array_unref(state.fixtures);
+    }
+    database_close(state.ctx.db);
+    reservation_book_clear(&state.ctx.reservations);
+    status_queue_clear(&state.ctx.statuses);
+    logger_close(&state.ctx.logger);
+    metrics_clear(&state.ctx.metrics);
+    bench_remove_work_dir(state.work_dir);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,716 @@
+#include "bench_data.h"
+#include "bench_stats.h"
+#include "data/dao.h"
+#include "data/migrations.h"
+#include "util/config.h"
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Simula varias terminales sobre el mismo archivo: un hilo por terminal, cada
+ * uno con su conexión, mezclando altas de comandas, ítems, cambios de estado,
+ * listados y cierres durante un tiempo fijo. Por cada combinación de
+ * journal_mode, synchronous y busy_timeout_ms reporta throughput, latencias y
+ * cuánto se esperó por locks.
+ */
+
+#define LOAD_MAX_PROFILES 4
+#define LOAD_TRACKED_ITEMS 64
+
+typedef enum LoadOp {
+    LOAD_OP_CREATE = 0,
+    LOAD_OP_ADD,
+    LOAD_OP_STATUS,
+    LOAD_OP_LIST,
+    LOAD_OP_CLOSE,
+    LOAD_OP_COUNT
+} LoadOp;
+
+static const char *const LOAD_OP_NAMES[LOAD_OP_COUNT] = {"create", "add", "status", "list", "close"};
+
+/* Mismas esperas que sqlite3_busy_timeout; el handler propio solo agrega los contadores. */
+static const int LOAD_BUSY_DELAYS_MS[] = {1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100};
+static const int LOAD_BUSY_TOTALS_MS[] = {0, 1, 3, 8, 18, 33, 53, 78, 103, 128, 178, 228};
+
+static const char *const LOAD_JOURNAL_MODES[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", NULL};
+static const char *const LOAD_SYNC_LEVELS[] = {"OFF", "NORMAL", "FULL", "EXTRA", NULL};
+
+typedef struct LoadOptions {
+    char dir[512];
+    char output_path[512];
+    char label[64];
+    char journal_modes[LOAD_MAX_PROFILES][16];
+    int journal_count;
+    char sync_levels[LOAD_MAX_PROFILES][16];
+    int sync_count;
+    int busy_timeouts[LOAD_MAX_PROFILES];
+    int busy_count;
+    BenchScale scale;
+    int terminals;
+    int duration_s;
+    int think_ms;
+    int retries;
+    int weights[LOAD_OP_COUNT];
+    unsigned int seed;
+} LoadOptions;
+
+/*
+ * busy_waits: operaciones que encontraron la base bloqueada al menos una vez.
+ * busy_sleeps: esperas del busy handler. retries: reintentos de la operación
+ * entera después de agotar busy_timeout_ms. busy_failures: operaciones que
+ * fallaron por lock aun con los reintentos; errors, por cualquier otra causa.
+ */
+typedef struct LoadOpStats {
+    GArray *samples;
+    long busy_waits;
+    long busy_sleeps;
+    gint64 lock_wait_us;
+    long retries;
+    long busy_failures;
+    long errors;
+} LoadOpStats;
+
+/* Lo que comparten los hilos de una corrida; go se prende cuando todos abrieron su conexión. */
+typedef struct LoadRun {
+    const LoadOptions *options;
+    const StorageProfile *profile;
+    char path[1024];
+    gint ready;
+    gint go;
+    gint64 deadline;
+} LoadRun;
+
+typedef struct LoadItem {
+    int item_id;
+    int order_id;
+} LoadItem;
+
+typedef struct LoadWorker {
+    LoadRun *run;
+    int number;
+    Database *db;
+    unsigned int random;
+    /* Comandas abiertas por esta terminal, la más vieja primero, y los últimos ítems de esas comandas. */
+    GArray *orders;
+    GArray *items;
+    LoadOp current;
+    bool op_busy;
+    bool gave_up;
+    bool opened;
+    LoadOpStats ops[LOAD_OP_COUNT];
+} LoadWorker;
+
+static unsigned int load_random_next(unsigned int *state) {
+    unsigned int value = *state;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    *state = value;
+    return value;
+}
+
+static int load_random_below(unsigned int *state, int limit) {
+    return limit <= 0 ? 0 : (int)(load_random_next(state) % (unsigned int)limit);
+}
+
+static int load_busy_handler(void *data, int count) {
+    LoadWorker *worker = (LoadWorker *)data;
+    LoadOpStats *stats = &worker->ops[worker->current];
+    int slots = (int)(sizeof(LOAD_BUSY_DELAYS_MS) / sizeof(LOAD_BUSY_DELAYS_MS[0]));
+    int timeout = worker->run->profile->busy_timeout_ms;
+    int delay;
+    int waited;
+    gint64 started;
+    if (count < slots) {
+        delay = LOAD_BUSY_DELAYS_MS[count];
+        waited = LOAD_BUSY_TOTALS_MS[count];
+    } else {
+        delay = LOAD_BUSY_DELAYS_MS[slots - 1];
+        waited = LOAD_BUSY_TOTALS_MS[slots - 1] + delay * (count - (slots - 1));
+    }
+    worker->op_busy = true;
+    if (waited + delay > timeout) {
+        delay = timeout - waited;
+        if (delay <= 0) {
+            worker->gave_up = true;
+            return 0;
+        }
+    }
+    started = g_get_monotonic_time();
+    g_usleep((gulong)delay * 1000);
+    stats->busy_sleeps = stats->busy_sleeps + 1;
+    stats->lock_wait_us = stats->lock_wait_us + (g_get_monotonic_time() - started);
+    return 1;
+}
+
+/* Si falta la comanda o el ítem sobre el que opera, se hace antes lo que lo crea. */
+static LoadOp load_resolve_op(LoadWorker *worker, LoadOp op) {
+    if ((op == LOAD_OP_ADD || op == LOAD_OP_CLOSE) && worker->orders->len == 0) {
+        return LOAD_OP_CREATE;
+    }
+    if (op == LOAD_OP_STATUS && worker->items->len == 0) {
+        return worker->orders->len == 0 ? LOAD_OP_CREATE : LOAD_OP_ADD;
+    }
+    return op;
+}
+
+static LoadOp load_pick_op(LoadWorker *worker) {
+    const int *weights = worker->run->options->weights;
+    int total = 0;
+    int pick;
+    int index = 0;
+    while (index < LOAD_OP_COUNT) {
+        total = total + weights[index];
+        index = index + 1;
+    }
+    pick = load_random_below(&worker->random, total);
+    index = 0;
+    while (index < LOAD_OP_COUNT - 1 && pick >= weights[index]) {
+        pick = pick - weights[index];
+        index = index + 1;
+    }
+    return load_resolve_op(worker, (LoadOp)index);
+}
+
+static bool load_list(LoadWorker *worker) {
+    int *order_ids = NULL;
+    OrderItem *items = NULL;
+    int count = 0;
+    if (!dao_list_open_orders(worker->db, &order_ids, &count)) {
+        return false;
+    }
+    dao_free_order_ids(order_ids);
+    if (worker->orders->len == 0) {
+        return true;
+    }
+    if (!dao_list_order_items(worker->db, g_array_index(worker->orders, int, worker->orders->len - 1), &items, &count)) {
+        return false;
+    }
+    dao_free_order_items(items);
+    return true;
+}
+
+/* Los ítems de una comanda cerrada ya no cambian de estado: dejan de elegirse. */
+static void load_forget_items(LoadWorker *worker, int order_id) {
+    guint index = 0;
+    while (index < worker->items->len) {
+        if (g_array_index(worker->items, LoadItem, index).order_id == order_id) {
+            g_array_remove_index(worker->items, index);
+        } else {
+            index = index + 1;
+        }
+    }
+}
+
+static bool load_execute(LoadWorker *worker, LoadOp op) {
+    const BenchScale *scale = &worker->run->options->scale;
+    int order_id = 0;
+    LoadItem item;
+    switch (op) {
+    case LOAD_OP_CREATE:
+        if (!dao_create_order(worker->db, 1 + load_random_below(&worker->random, scale->tables), 2 + worker->number % scale->waiters, &order_id)) {
+            return false;
+        }
+        g_array_append_val(worker->orders, order_id);
+        return true;
+    case LOAD_OP_ADD:
+        order_id = g_array_index(worker->orders, int, load_random_below(&worker->random, (int)worker->orders->len));
+        if (!dao_add_item_to_order(worker->db, order_id, 1 + load_random_below(&worker->random, scale->menu_items), "")) {
+            return false;
+        }
+        /* Los triggers del insert no cambian el rowid que ve la conexión. */
+        item.item_id = (int)sqlite3_last_insert_rowid(worker->db->handle);
+        item.order_id = order_id;
+        if (worker->items->len >= LOAD_TRACKED_ITEMS) {
+            g_array_remove_index(worker->items, 0);
+        }
+        g_array_append_val(worker->items, item);
+        return true;
+    case LOAD_OP_STATUS:
+        item = g_array_index(worker->items, LoadItem, load_random_below(&worker->random, (int)worker->items->len));
+        return dao_update_order_item_status(worker->db, item.item_id, load_random_below(&worker->random, 2) == 0 ? "preparacion" : "listo");
+    case LOAD_OP_LIST:
+        return load_list(worker);
+    case LOAD_OP_CLOSE:
+        order_id = g_array_index(worker->orders, int, 0);
+        if (!dao_close_order(worker->db, order_id)) {
+            return false;
+        }
+        g_array_remove_index(worker->orders, 0);
+        load_forget_items(worker, order_id);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool load_failed_busy(LoadWorker *worker) {
+    int code = sqlite3_errcode(worker->db->handle) & 0xff;
+    return worker->gave_up || code == SQLITE_BUSY || code == SQLITE_LOCKED;
+}
+
+/* La latencia incluye las esperas por lock y los reintentos: es lo que nota el mozo. */
+static void load_step(LoadWorker *worker, LoadOp op) {
+    LoadOpStats *stats = &worker->ops[op];
+    gint64 started = g_get_monotonic_time();
+    gint64 elapsed;
+    int attempt = 0;
+    bool ok = false;
+    bool busy = false;
+    worker->current = op;
+    worker->op_busy = false;
+    while (true) {
+        worker->gave_up = false;
+        ok = load_execute(worker, op);
+        busy = !ok && load_failed_busy(worker);
+        if (ok || !busy || attempt >= worker->run->options->retries) {
+            break;
+        }
+        attempt = attempt + 1;
+        stats->retries = stats->retries + 1;
+        g_usleep((gulong)(1000 * attempt + load_random_below(&worker->random, 1000)));
+    }
+    elapsed = g_get_monotonic_time() - started;
+    if (worker->op_busy) {
+        stats->busy_waits = stats->busy_waits + 1;
+    }
+    if (ok) {
+        g_array_append_val(stats->samples, elapsed);
+    } else if (busy) {
+        stats->busy_failures = stats->busy_failures + 1;
+    } else {
+        stats->errors = stats->errors + 1;
+    }
+}
+
+static gpointer load_worker_run(gpointer data) {
+    LoadWorker *worker = (LoadWorker *)data;
+    LoadRun *run = worker->run;
+    worker->opened = database_open(&worker->db, run->path, run->profile, NULL);
+    if (worker->opened) {
+        sqlite3_busy_handler(worker->db->handle, load_busy_handler, worker);
+    }
+    g_atomic_int_inc(&run->ready);
+    while (!g_atomic_int_get(&run->go)) {
+        g_usleep(1000);
+    }
+    while (worker->opened && g_get_monotonic_time() < run->deadline) {
+        load_step(worker, load_pick_op(worker));
+        if (run->options->think_ms > 0) {
+            g_usleep((gulong)run->options->think_ms * 1000);
+        }
+    }
+    database_close(worker->db);
+    worker->db = NULL;
+    return NULL;
+}
+
+static void load_append_counters(GString *json, const LoadOpStats *stats) {
+    g_string_append_printf(json, "\"busy_waits\": %ld, \"busy_sleeps\": %ld, \"lock_wait_ms\": %.1f, \"retries\": %ld, \"busy_failures\": %ld, \"errors\": %ld", stats->busy_waits,
+                           stats->busy_sleeps, (double)stats->lock_wait_us / 1000.0, stats->retries, stats->busy_failures, stats->errors);
+}
+
+static void load_add_counters(LoadOpStats *total, const LoadOpStats *stats) {
+    total->busy_waits = total->busy_waits + stats->busy_waits;
+    total->busy_sleeps = total->busy_sleeps + stats->busy_sleeps;
+    total->lock_wait_us = total->lock_wait_us + stats->lock_wait_us;
+    total->retries = total->retries + stats->retries;
+    total->busy_failures = total->busy_failures + stats->busy_failures;
+    total->errors = total->errors + stats->errors;
+}
+
+/* Junta las muestras de todas las terminales por operación y escribe el bloque de la configuración. */
+static void load_report(GString *json, const StorageProfile *profile, LoadWorker *workers, int count, double elapsed_s, bool first) {
+    LoadOpStats total;
+    GString *operations = g_string_new(NULL);
+    long completed = 0;
+    int op = 0;
+    memset(&total, 0, sizeof(LoadOpStats));
+    while (op < LOAD_OP_COUNT) {
+        LoadOpStats merged;
+        BenchSummary summary;
+        int index = 0;
+        memset(&merged, 0, sizeof(LoadOpStats));
+        merged.samples = g_array_new(FALSE, FALSE, sizeof(gint64));
+        while (index < count) {
+            const LoadOpStats *stats = &workers[index].ops[op];
+            g_array_append_vals(merged.samples, stats->samples->data, stats->samples->len);
+            load_add_counters(&merged, stats);
+            index = index + 1;
+        }
+        bench_summarize(merged.samples, &summary);
+        load_add_counters(&total, &merged);
+        completed = completed + (long)summary.count;
+        g_string_append_printf(operations, "%s\n        {\"name\": \"%s\", \"ok\": %u, ", op == 0 ? "" : ",", LOAD_OP_NAMES[op], summary.count);
+        load_append_counters(operations, &merged);
+        bench_append_summary_json(operations, &summary);
+        g_string_append(operations, "}");
+        fprintf(stderr, "  %-7s %8u ok  p50 %7lld us  p99 %8lld us  busy %ld  fallas %ld\n", LOAD_OP_NAMES[op], summary.count, (long long)summary.p50_us, (long long)summary.p99_us,
+                merged.busy_waits, merged.busy_failures + merged.errors);
+        g_array_unref(merged.samples);
+        op = op + 1;
+    }
+    g_string_append_printf(json, "%s\n    {\"journal_mode\": \"%s\", \"synchronous\": \"%s\", \"busy_timeout_ms\": %d, \"elapsed_s\": %.2f, \"ops\": %ld, \"throughput_ops_s\": %.1f, ",
+                           first ? "" : ",", profile->journal_mode, profile->synchronous, profile->busy_timeout_ms, elapsed_s, completed, elapsed_s > 0 ? completed / elapsed_s : 0.0);
+    load_append_counters(json, &total);
+    g_string_append_printf(json, ",\n      \"operations\": [%s\n      ]}", operations->str);
+    fprintf(stderr, "  %.1f ops/s, %ld operaciones con espera por lock, %.1f ms esperando\n", elapsed_s > 0 ? completed / elapsed_s : 0.0, total.busy_waits, (double)total.lock_wait_us / 1000.0);
+    g_string_free(operations, TRUE);
+}
+
+static bool load_prepare_database(const char *path, const StorageProfile *profile, const LoadOptions *options) {
+    Database *db = NULL;
+    BenchDataStats stats;
+    bool ok;
+    if (g_file_test(path, G_FILE_TEST_EXISTS)) {
+        fprintf(stderr, "%s ya existe: usar otro --dir o borrarla\n", path);
+        return false;
+    }
+    if (!database_open(&db, path, profile, NULL)) {
+        return false;
+    }
+    ok = database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL) && bench_data_generate(db, &options->scale, options->seed, &stats);
+    database_close(db);
+    return ok;
+}
+
+static bool load_run_profile(const LoadOptions *options, const StorageProfile *profile, GString *json, bool first) {
+    LoadRun run;
+    LoadWorker *workers = g_new0(LoadWorker, options->terminals);
+    GThread **threads = g_new0(GThread *, options->terminals);
+    gint64 started;
+    double elapsed_s;
+    bool ok = true;
+    int index = 0;
+    memset(&run, 0, sizeof(LoadRun));
+    run.options = options;
+    run.profile = profile;
+    snprintf(run.path, sizeof(run.path), "%s/load_%s_%s_%d.db", options->dir, profile->journal_mode, profile->synchronous, profile->busy_timeout_ms);
+    fprintf(stderr, "%s/%s busy_timeout=%d ms, %d terminales, %d s\n", profile->journal_mode, profile->synchronous, profile->busy_timeout_ms, options->terminals, options->duration_s);
+    if (!load_prepare_database(run.path, profile, options)) {
+        fprintf(stderr, "No se pudo preparar %s\n", run.path);
+        g_free(workers);
+        g_free(threads);
+        return false;
+    }
+    while (index < options->terminals) {
+        int op = 0;
+        workers[index].run = &run;
+        workers[index].number = index;
+        workers[index].random = options->seed + 7919u * (unsigned int)(index + 1);
+        workers[index].orders = g_array_new(FALSE, FALSE, sizeof(int));
+        workers[index].items = g_array_new(FALSE, FALSE, sizeof(LoadItem));
+        while (op < LOAD_OP_COUNT) {
+            workers[index].ops[op].samples = g_array_new(FALSE, FALSE, sizeof(gint64));
+            op = op + 1;
+        }
+        threads[index] = g_thread_new("terminal", load_worker_run, &workers[index]);
+        index = index + 1;
+    }
+    while (g_atomic_int_get(&run.ready) < options->terminals) {
+        g_usleep(1000);
+    }
+    started = g_get_monotonic_time();
+    run.deadline = started + (gint64)options->duration_s * G_USEC_PER_SEC;
+    g_atomic_int_set(&run.go, 1);
+    index = 0;
+    while (index < options->terminals) {
+        g_thread_join(threads[index]);
+        if (!workers[index].opened) {
+            ok = false;
+        }
+        index = index + 1;
+    }
+    elapsed_s = (double)(g_get_monotonic_time() - started) / G_USEC_PER_SEC;
+    if (ok) {
+        load_report(json, profile, workers, options->terminals, elapsed_s, first);
+    } else {
+        fprintf(stderr, "Alguna terminal no pudo abrir %s\n", run.path);
+    }
+    index = 0;
+    while (index < options->terminals) {
+        int op = 0;
+        while (op < LOAD_OP_COUNT) {
+            g_array_unref(workers[index].ops[op].samples);
+            op = op + 1;
+        }
+        g_array_unref(workers[index].orders);
+        g_array_unref(workers[index].items);
+        index = index + 1;
+    }
+    g_free(workers);
+    g_free(threads);
+    return ok;
+}
+
+static bool load_parse_int(const char *text, int *value) {
+    char *end = NULL;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0 || parsed > G_MAXINT) {
+        return false;
+    }
+    *value = (int)parsed;
+    return true;
+}
+
+/* Deja en value la forma canónica (mayúsculas) si está en allowed. */
+static bool load_allowed(char *value, size_t value_len, const char *const *allowed) {
+    int index = 0;
+    while (allowed[index] != NULL) {
+        if (g_ascii_strcasecmp(allowed[index], value) == 0) {
+            g_strlcpy(value, allowed[index], value_len);
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+/* "WAL,DELETE": hasta LOAD_MAX_PROFILES valores de allowed. */
+static bool load_parse_names(const char *text, char names[][16], int *count, const char *const *allowed) {
+    const char *cursor = text;
+    *count = 0;
+    while (*cursor != '\0') {
+        const char *comma = strchr(cursor, ',');
+        size_t length = comma == NULL ? strlen(cursor) : (size_t)(comma - cursor);
+        if (*count >= LOAD_MAX_PROFILES || length == 0 || length >= 16) {
+            return false;
+        }
+        memcpy(names[*count], cursor, length);
+        names[*count][length] = '\0';
+        if (!load_allowed(names[*count], 16, allowed)) {
+            return false;
+        }
+        *count = *count + 1;
+        cursor = comma == NULL ? cursor + length : comma + 1;
+    }
+    return *count > 0;
+}
+
+static bool load_parse_timeouts(const char *text, int *values, int *count) {
+    char buffer[64];
+    const char *cursor = text;
+    *count = 0;
+    while (*cursor != '\0') {
+        const char *comma = strchr(cursor, ',');
+        size_t length = comma == NULL ? strlen(cursor) : (size_t)(comma - cursor);
+        if (*count >= LOAD_MAX_PROFILES || length == 0 || length >= sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, cursor, length);
+        buffer[length] = '\0';
+        if (!load_parse_int(buffer, &values[*count])) {
+            return false;
+        }
+        *count = *count + 1;
+        cursor = comma == NULL ? cursor + length : comma + 1;
+    }
+    return *count > 0;
+}
+
+/* "create:1,add:6": las operaciones que no aparecen quedan en 0. */
+static bool load_parse_mix(const char *text, int *weights) {
+    char buffer[32];
+    const char *cursor = text;
+    int total = 0;
+    memset(weights, 0, sizeof(int) * LOAD_OP_COUNT);
+    while (*cursor != '\0') {
+        const char *comma = strchr(cursor, ',');
+        size_t length = comma == NULL ? strlen(cursor) : (size_t)(comma - cursor);
+        char *colon = NULL;
+        int op = 0;
+        if (length == 0 || length >= sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, cursor, length);
+        buffer[length] = '\0';
+        colon = strchr(buffer, ':');
+        if (colon == NULL) {
+            return false;
+        }
+        *colon = '\0';
+        while (op < LOAD_OP_COUNT && strcmp(LOAD_OP_NAMES[op], buffer) != 0) {
+            op = op + 1;
+        }
+        if (op == LOAD_OP_COUNT || !load_parse_int(colon + 1, &weights[op])) {
+            return false;
+        }
+        total = total + weights[op];
+        cursor = comma == NULL ? cursor + length : comma + 1;
+    }
+    return total > 0;
+}
+
+static void load_usage(void) {
+    fprintf(stderr,
+            "Uso: restaurant_load [opciones]\n"
+            "  --terminals=N           hilos, cada uno con su conexión (4)\n"
+            "  --duration=S            segundos por configuración (10)\n"
+            "  --think-ms=N            pausa entre operaciones de una terminal (0)\n"
+            "  --mix=OP:PESO,...       create, add, status, list, close (create:1,add:6,status:6,list:4,close:1)\n"
+            "  --journal-mode=A,B      WAL, DELETE, TRUNCATE, PERSIST, MEMORY (WAL,DELETE)\n"
+            "  --synchronous=A,B       OFF, NORMAL, FULL, EXTRA (NORMAL)\n"
+            "  --busy-timeout=MS,...   (5000)\n"
+            "  --retries=N             reintentos de la operación si agota el busy timeout (3)\n"
+            "  --scale=small|medium|large --seed=N\n"
+            "  --dir=RUTA              dónde crear las bases (temporal por defecto, se borra al final)\n"
+            "  --output=RUTA --label=TEXTO\n");
+}
+
+static bool load_parse_args(int argc, char **argv, LoadOptions *options) {
+    int arg_index = 1;
+    memset(options, 0, sizeof(LoadOptions));
+    bench_scale_preset("small", &options->scale);
+    options->terminals = 4;
+    options->duration_s = 10;
+    options->retries = 3;
+    options->seed = 42;
+    load_parse_mix("create:1,add:6,status:6,list:4,close:1", options->weights);
+    load_parse_names("WAL,DELETE", options->journal_modes, &options->journal_count, LOAD_JOURNAL_MODES);
+    load_parse_names("NORMAL", options->sync_levels, &options->sync_count, LOAD_SYNC_LEVELS);
+    load_parse_timeouts("5000", options->busy_timeouts, &options->busy_count);
+    while (arg_index < argc) {
+        const char *arg = argv[arg_index];
+        const char *value = strchr(arg, '=');
+        bool ok = true;
+        value = value == NULL ? "" : value + 1;
+        if (strncmp(arg, "--terminals=", 12) == 0) {
+            ok = load_parse_int(value, &options->terminals) && options->terminals > 0;
+        } else if (strncmp(arg, "--duration=", 11) == 0) {
+            ok = load_parse_int(value, &options->duration_s) && options->duration_s > 0;
+        } else if (strncmp(arg, "--think-ms=", 11) == 0) {
+            ok = load_parse_int(value, &options->think_ms);
+        } else if (strncmp(arg, "--mix=", 6) == 0) {
+            ok = load_parse_mix(value, options->weights);
+        } else if (strncmp(arg, "--journal-mode=", 15) == 0) {
+            ok = load_parse_names(value, options->journal_modes, &options->journal_count, LOAD_JOURNAL_MODES);
+        } else if (strncmp(arg, "--synchronous=", 14) == 0) {
+            ok = load_parse_names(value, options->sync_levels, &options->sync_count, LOAD_SYNC_LEVELS);
+        } else if (strncmp(arg, "--busy-timeout=", 15) == 0) {
+            ok = load_parse_timeouts(value, options->busy_timeouts, &options->busy_count);
+        } else if (strncmp(arg, "--retries=", 10) == 0) {
+            ok = load_parse_int(value, &options->retries);
+        } else if (strncmp(arg, "--scale=", 8) == 0) {
+            ok = bench_scale_preset(value, &options->scale);
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            int seed = 0;
+            ok = load_parse_int(value, &seed);
+            options->seed = (unsigned int)seed;
+        } else if (strncmp(arg, "--dir=", 6) == 0) {
+            g_strlcpy(options->dir, value, sizeof(options->dir));
+        } else if (strncmp(arg, "--output=", 9) == 0) {
+            g_strlcpy(options->output_path, value, sizeof(options->output_path));
+        } else if (strncmp(arg, "--label=", 8) == 0) {
+            g_strlcpy(options->label, value, sizeof(options->label));
+            /* Va tal cual dentro de una cadena JSON. */
+            g_strdelimit(options->label, "\"\\", '_');
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Opción inválida: %s\n", arg);
+            return false;
+        }
+        arg_index = arg_index + 1;
+    }
+    return true;
+}
+
+static void load_append_header(GString *json, const LoadOptions *options) {
+    const BenchScale *scale = &options->scale;
+    int op = 0;
+    g_string_append_printf(json, "{\n  \"label\": \"%s\",\n  \"sqlite_version\": \"%s\",\n  \"terminals\": %d,\n  \"duration_s\": %d,\n  \"think_ms\": %d,\n  \"retries\": %d,\n  \"seed\": %u,\n",
+                           options->label, sqlite3_libversion(), options->terminals, options->duration_s, options->think_ms, options->retries, options->seed);
+    g_string_append(json, "  \"mix\": {");
+    while (op < LOAD_OP_COUNT) {
+        g_string_append_printf(json, "%s\"%s\": %d", op == 0 ? "" : ", ", LOAD_OP_NAMES[op], options->weights[op]);
+        op = op + 1;
+    }
+    g_string_append_printf(json, "},\n  \"scale\": {\"tables\": %d, \"waiters\": %d, \"menu_items\": %d, \"days\": %d, \"orders_per_day\": %d, \"items_per_order\": %d, \"reservations_per_day\": %d},\n",
+                           scale->tables, scale->waiters, scale->menu_items, scale->days, scale->orders_per_day, scale->items_per_order, scale->reservations_per_day);
+    g_string_append(json, "  \"configurations\": [");
+}
+
+/* Solo se borran las bases de la corrida, y solo en el directorio temporal propio. */
+static void load_remove_work_dir(const char *path) {
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const char *name = NULL;
+    if (dir == NULL) {
+        return;
+    }
+    name = g_dir_read_name(dir);
+    while (name != NULL) {
+        char *file = g_build_filename(path, name, NULL);
+        g_remove(file);
+        g_free(file);
+        name = g_dir_read_name(dir);
+    }
+    g_dir_close(dir);
+    g_rmdir(path);
+}
+
+int main(int argc, char **argv) {
+    LoadOptions options;
+    StorageProfile profile;
+    AppConfig defaults;
+    GString *json = NULL;
+    bool temporary = false;
+    bool first = true;
+    bool ok = true;
+    int journal = 0;
+    if (!load_parse_args(argc, argv, &options)) {
+        load_usage();
+        return 2;
+    }
+    if (options.dir[0] == '\0') {
+        char *work_dir = g_dir_make_tmp("restaurant_load_XXXXXX", NULL);
+        if (work_dir == NULL) {
+            fprintf(stderr, "No se pudo crear el directorio de trabajo\n");
+            return 1;
+        }
+        g_strlcpy(options.dir, work_dir, sizeof(options.dir));
+        g_free(work_dir);
+        temporary = true;
+    }
+    /* El resto del perfil queda como en config.ini por defecto. */
+    config_default(&defaults);
+    json = g_string_new(NULL);
+    load_append_header(json, &options);
+    while (journal < options.journal_count) {
+        int sync = 0;
+        while (sync < options.sync_count) {
+            int busy = 0;
+            while (busy < options.busy_count) {
+                profile = defaults.storage;
+                g_strlcpy(profile.journal_mode, options.journal_modes[journal], sizeof(profile.journal_mode));
+                g_strlcpy(profile.synchronous, options.sync_levels[sync], sizeof(profile.synchronous));
+                profile.busy_timeout_ms = options.busy_timeouts[busy];
+                if (load_run_profile(&options, &profile, json, first)) {
+                    first = false;
+                } else {
+                    ok = false;
+                }
+                busy = busy + 1;
+            }
+            sync = sync + 1;
+        }
+        journal = journal + 1;
+    }
+    g_string_append(json, "\n  ]\n}\n");
+    if (options.output_path[0] != '\0') {
+        if (!g_file_set_contents(options.output_path, json->str, (gssize)json->len, NULL)) {
+            fprintf(stderr, "No se pudo escribir %s\n", options.output_path);
+            ok = false;
+        }
+    } else {
+        fputs(json->str, stdout);
+    }
+    g_string_free(json, TRUE);
+    if (temporary) {
+        load_remove_work_dir(options.dir);
+    }
+    return ok ? 0 : 1;
+}
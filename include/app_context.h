@@ -3,15 +3,37 @@
 
 #include <sqlite3.h>
 #include <gtk/gtk.h>
+#include "data/database.h"
+#include "data/change_bus.h"
+#include "data/dao_async.h"
+#include "data/maintenance.h"
+#include "data/snapshot_cache.h"
+#include "core/reservation_service.h"
+#include "core/status_queue.h"
 #include "util/config.h"
 #include "util/logger.h"
 #include "util/i18n.h"
+#include "util/metrics.h"
+#include "util/startup_trace.h"
 
 typedef struct AppContext {
-    sqlite3 *db;
+    Database *db;
+    DaoAsync async;
+    SnapshotCache snapshots;
+    ReservationBook reservations;
+    ChangeBus changes;
+    MaintenanceScheduler maintenance;
+    bool maintenance_pending;
+    StatusQueue statuses;
+    bool status_flush_pending;
     AppConfig config;
     Logger logger;
+    /* Lo comparten ctx->db y las conexiones de lectura; vive hasta después de cerrarlas. */
+    Metrics metrics;
     I18nCatalog catalog;
+    StartupTrace trace;
+    /* Distinto de NULL con --kitchen-display; vacío muestra todas las estaciones. */
+    const char *kitchen_station;
 } AppContext;
 
 #endif
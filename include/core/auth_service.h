@@ -5,6 +5,14 @@
 #include "app_context.h"
 #include "data/dao.h"
 
+typedef enum AuthResult {
+    AUTH_RESULT_OK = 0,
+    AUTH_RESULT_UNKNOWN_USER,
+    AUTH_RESULT_BAD_PASSWORD
+} AuthResult;
+
+AuthResult auth_check_credentials(Database *db, const char *username, const char *password, User *user_out);
+void auth_log_result(AppContext *ctx, AuthResult result);
 bool auth_login(AppContext *ctx, const char *username, const char *password, User *user_out);
 
 #endif
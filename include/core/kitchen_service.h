@@ -0,0 +1,27 @@
+#ifndef CORE_KITCHEN_SERVICE_H
+#define CORE_KITCHEN_SERVICE_H
+
+#include <stdbool.h>
+#include "data/dao.h"
+#include "data/database.h"
+
+/*
+ * Estado del sondeo de una pantalla de cocina. Hay un solo sondeo en curso por
+ * pantalla: el trabajo de lectura lo actualiza y el hilo principal lo lee recién
+ * en el callback.
+ */
+typedef struct KitchenFeed {
+    char station[32];
+    bool loaded;
+    long long seq;
+    unsigned long polls;
+    unsigned long skipped;
+} KitchenFeed;
+
+void kitchen_feed_init(KitchenFeed *feed, const char *station);
+/* La primera vez visita los pendientes; después solo lo que cambió. changed indica si se consultó. */
+bool kitchen_service_poll(Database *db, KitchenFeed *feed, DaoKitchenTicketVisitor visitor, void *user_data, bool *changed);
+/* pedido → preparacion → listo → servido; NULL si el estado no avanza. */
+const char *kitchen_service_next_status(const char *status);
+
+#endif
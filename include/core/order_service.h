@@ -2,11 +2,17 @@
 #define CORE_ORDER_SERVICE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "app_context.h"
+#include "data/dao.h"
 
 bool order_service_create(AppContext *ctx, int table_id, int user_id, int *order_id);
 bool order_service_add_item(AppContext *ctx, int order_id, int menu_item_id, const char *notes);
+bool order_service_add_items(AppContext *ctx, int order_id, const OrderItemRequest *items, int count);
 bool order_service_update_status(AppContext *ctx, int order_item_id, const char *status);
+bool order_service_flush_statuses(AppContext *ctx);
+bool order_service_pending_status(AppContext *ctx, int order_item_id, char *status, size_t status_len);
+bool order_service_close(AppContext *ctx, int order_id);
 bool order_service_calculate_totals(AppContext *ctx, int order_id, double tip_rate, double discount, double *subtotal, double *tax, double *total);
 
 #endif
@@ -4,6 +4,15 @@
 #include <stdbool.h>
 #include "app_context.h"
 
+typedef struct ReportRangeStats {
+    int days;
+    int workers;
+    long rows;
+    double elapsed_s;
+} ReportRangeStats;
+
 bool report_service_export_daily(AppContext *ctx, const char *date_str, const char *output_csv_path);
+bool report_service_rebuild_rollups(AppContext *ctx);
+bool report_service_export_range(AppContext *ctx, const char *from_date, const char *to_date, bool combined, const char *output_dir, ReportRangeStats *stats);
 
 #endif
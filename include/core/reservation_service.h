@@ -0,0 +1,46 @@
+#ifndef CORE_RESERVATION_SERVICE_H
+#define CORE_RESERVATION_SERVICE_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include "data/dao.h"
+#include "data/database.h"
+
+/*
+ * Agenda de reservas en memoria: un árbol de intervalos por mesa con
+ * [reserved_at, reserved_at + seating_minutes). Se valida contra los contadores
+ * 'tables' y 'reservations' de table_versions; si otra conexión tocó las
+ * reservas se recarga desde la última hora de servicio en adelante. Se comparte
+ * entre el hilo escritor y los lectores bajo lock.
+ */
+typedef struct ReservationBook {
+    GMutex lock;
+    GHashTable *tables;
+    GHashTable *entries;
+    int seating_minutes;
+    int tables_version;
+    int reservations_version;
+    unsigned long table_loads;
+    unsigned long reloads;
+} ReservationBook;
+
+void reservation_book_init(ReservationBook *book, int seating_minutes);
+void reservation_book_clear(ReservationBook *book);
+/*
+ * 'YYYY-MM-DD HH:MM' (segundos opcionales) a minutos desde 1970-01-01, sin zona
+ * horaria. Rechaza fechas imposibles y texto sobrante.
+ */
+bool reservation_parse_minutes(const char *text, long long *minutes);
+/* minutes <= 0 usa la duración configurada. Si la mesa está tomada deja la reserva que choca en conflict_id. */
+bool reservation_book_table_free(ReservationBook *book, Database *db, int table_id, const char *when, int minutes, bool *is_free, int *conflict_id);
+/* Mesas con capacity >= party_size libres en ese horario, de la más chica a la más grande. */
+bool reservation_book_free_tables(ReservationBook *book, Database *db, const char *when, int minutes, int party_size, GArray *table_ids);
+/*
+ * Valida e inserta en la misma transacción; si choca devuelve false con
+ * conflict_id > 0. Guarda when normalizado como 'YYYY-MM-DD HH:MM'.
+ */
+bool reservation_book_create(ReservationBook *book, Database *db, int table_id, const char *name, const char *phone, const char *when, const char *notes,
+                             int *reservation_id, int *conflict_id);
+bool reservation_book_cancel(ReservationBook *book, Database *db, int reservation_id);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef CORE_STATUS_QUEUE_H
+#define CORE_STATUS_QUEUE_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "data/dao.h"
+
+typedef struct StatusQueueBatch {
+    OrderItemStatusChange *entries;
+    int count;
+    int capacity;
+    gint64 oldest_us;
+} StatusQueueBatch;
+
+/*
+ * Cambios de estado de cocina pendientes de escribir. Por ítem solo se guarda el
+ * último estado. Un único hilo (el escritor) toma el lote con status_queue_take y
+ * lo cierra con status_queue_finish; mientras tanto sigue visible en las consultas.
+ */
+typedef struct StatusQueue {
+    GMutex lock;
+    StatusQueueBatch pending;
+    StatusQueueBatch in_flight;
+} StatusQueue;
+
+void status_queue_init(StatusQueue *queue);
+int status_queue_put(StatusQueue *queue, int order_item_id, const char *status, gint64 now_us);
+void status_queue_discard(StatusQueue *queue, int order_item_id);
+int status_queue_take(StatusQueue *queue, const OrderItemStatusChange **entries);
+void status_queue_finish(StatusQueue *queue, bool committed);
+bool status_queue_lookup(StatusQueue *queue, int order_item_id, char *status, size_t status_len);
+int status_queue_count(StatusQueue *queue);
+gint64 status_queue_oldest(StatusQueue *queue);
+void status_queue_clear(StatusQueue *queue);
+
+#endif
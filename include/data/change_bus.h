@@ -0,0 +1,68 @@
+#ifndef DATA_CHANGE_BUS_H
+#define DATA_CHANGE_BUS_H
+
+#include <glib.h>
+#include <sqlite3.h>
+#include <stdbool.h>
+#include "data/database.h"
+
+typedef enum ChangeTable {
+    CHANGE_TABLE_ORDERS = 0,
+    CHANGE_TABLE_ORDER_ITEMS,
+    CHANGE_TABLE_TABLES,
+    CHANGE_TABLE_MENU_ITEMS,
+    CHANGE_TABLE_RESERVATIONS,
+    CHANGE_TABLE_USERS,
+    CHANGE_TABLE_COUNT
+} ChangeTable;
+
+typedef enum ChangeOp {
+    CHANGE_OP_INSERT = 0,
+    CHANGE_OP_UPDATE,
+    CHANGE_OP_DELETE
+} ChangeOp;
+
+/* rowid 0 significa "la tabla entera": el lote superó CHANGE_BUS_MAX_EVENTS. */
+typedef struct ChangeEvent {
+    ChangeTable table;
+    ChangeOp op;
+    sqlite3_int64 rowid;
+} ChangeEvent;
+
+#define CHANGE_BUS_MAX_EVENTS 512
+
+/* Los eventos son avisos de "esta fila pudo cambiar": el suscriptor vuelve a leerla. */
+typedef void (*ChangeListener)(const ChangeEvent *events, int count, gpointer user_data);
+
+typedef struct ChangeSubscriber {
+    guint id;
+    ChangeListener listener;
+    gpointer user_data;
+} ChangeSubscriber;
+
+/*
+ * Bus de cambios alimentado por los hooks de update/commit/rollback de la
+ * conexión escritora. Los eventos de una transacción se juntan en el hilo
+ * escritor y, cuando el commit terminó, se entregan en el GMainContext de quien
+ * llamó a change_bus_init. Lo escrito por fuera de database_prepare/release
+ * se entrega con la siguiente sentencia liberada. Suscribir y desuscribir solo
+ * desde ese hilo.
+ */
+typedef struct ChangeBus {
+    GMainContext *main_context;
+    GArray *pending;
+    /* Confirmado pero todavía no entregado: el commit puede no haber vuelto. */
+    GArray *committed;
+    GArray *subscribers;
+    guint next_id;
+    gint detached;
+} ChangeBus;
+
+void change_bus_init(ChangeBus *bus);
+void change_bus_attach(ChangeBus *bus, Database *db);
+void change_bus_detach(ChangeBus *bus, Database *db);
+guint change_bus_subscribe(ChangeBus *bus, ChangeListener listener, gpointer user_data);
+void change_bus_unsubscribe(ChangeBus *bus, guint id);
+void change_bus_clear(ChangeBus *bus);
+
+#endif
@@ -2,6 +2,8 @@
 #define DATA_DAO_H
 
 #include <sqlite3.h>
+#include "data/database.h"
+#include "util/arena.h"
 #include <stdbool.h>
 #include <time.h>
 
@@ -27,6 +29,7 @@ typedef struct TableStatus {
     char name[64];
     char status[16];
     int waiter_id;
+    int capacity;
 } TableStatus;
 
 typedef struct OrderItem {
@@ -46,20 +49,180 @@ typedef struct Reservation {
     char notes[256];
 } Reservation;
 
-bool dao_get_user_by_username(sqlite3 *db, const char *username, User *user);
-bool dao_create_order(sqlite3 *db, int table_id, int user_id, int *order_id);
-bool dao_add_item_to_order(sqlite3 *db, int order_id, int menu_item_id, const char *notes);
-bool dao_update_order_item_status(sqlite3 *db, int order_item_id, const char *status);
-bool dao_calculate_order_totals(sqlite3 *db, int order_id, double tax_rate, double tip_rate, double discount, double *subtotal, double *tax, double *total);
-bool dao_export_daily_report(sqlite3 *db, const char *date_str, const char *path);
-bool dao_list_tables(sqlite3 *db, TableStatus **tables, int *count);
-bool dao_list_menu_items(sqlite3 *db, MenuItem **items, int *count);
-bool dao_list_open_orders(sqlite3 *db, int **order_ids, int *count);
-bool dao_list_order_items(sqlite3 *db, int order_id, OrderItem **items, int *count);
-bool dao_create_reservation(sqlite3 *db, int table_id, const char *name, const char *phone, const char *reserved_at, const char *notes);
-bool dao_list_reservations(sqlite3 *db, Reservation **reservations, int *count);
+/* Cursor de paginación por (reserved_at, id): la página siguiente empieza después de esta fila. */
+typedef struct ReservationKey {
+    char reserved_at[32];
+    int id;
+} ReservationKey;
+
+typedef struct SalesTotals {
+    double revenue;
+    double cost;
+    int item_count;
+    int order_count;
+} SalesTotals;
+
+typedef struct OrderItemRequest {
+    int menu_item_id;
+    const char *notes;
+    int quantity;
+} OrderItemRequest;
+
+typedef struct OrderItemStatusChange {
+    int order_item_id;
+    char status[16];
+} OrderItemStatusChange;
+
+/* Vistas de fila: los punteros apuntan al statement y solo valen durante el callback. */
+typedef struct TableRowView {
+    int id;
+    const char *name;
+    const char *status;
+    int waiter_id;
+    int capacity;
+} TableRowView;
+
+typedef struct MenuItemView {
+    int id;
+    const char *name;
+    const char *category;
+    double price;
+    double cost;
+    int stock;
+    const char *photo;
+} MenuItemView;
+
+typedef struct UserView {
+    int id;
+    const char *username;
+    const char *role;
+    const char *password_hash;
+} UserView;
+
+typedef struct OrderSummaryView {
+    int id;
+    int table_id;
+    int item_count;
+    double subtotal;
+} OrderSummaryView;
+
+typedef struct OrderItemView {
+    int id;
+    int order_id;
+    int menu_item_id;
+    const char *status;
+    const char *notes;
+} OrderItemView;
+
+/* active es falso cuando el ítem ya no corresponde a cocina (servido, anulado o comanda cerrada). */
+typedef struct KitchenTicketView {
+    int id;
+    int order_id;
+    int table_id;
+    const char *item_name;
+    const char *station;
+    const char *status;
+    const char *notes;
+    const char *ordered_at;
+    bool active;
+} KitchenTicketView;
+
+typedef struct ReservationView {
+    int id;
+    int table_id;
+    const char *customer_name;
+    const char *customer_phone;
+    const char *reserved_at;
+    const char *notes;
+} ReservationView;
+
+/* Resultado con cadenas en arena: los textos repetidos (categoría, estado) se internan
+   y filas y cadenas se liberan juntas con dao_result_set_free. */
+typedef struct DaoResultSet {
+    Arena arena;
+    ArenaInterner strings;
+    void *rows;
+    size_t row_size;
+    int count;
+    int capacity;
+    bool failed;
+} DaoResultSet;
+
+typedef struct DailyReportRowView {
+    int order_id;
+    const char *table_name;
+    const char *waiter_name;
+    double total;
+} DailyReportRowView;
+
+/* Los visitors devuelven false para cortar la iteración. */
+typedef bool (*DaoTableVisitor)(const TableRowView *row, void *user_data);
+typedef bool (*DaoMenuItemVisitor)(const MenuItemView *row, void *user_data);
+typedef bool (*DaoUserVisitor)(const UserView *row, void *user_data);
+typedef bool (*DaoTableVersionVisitor)(const char *table_name, int version, void *user_data);
+typedef bool (*DaoOrderIdVisitor)(int order_id, void *user_data);
+typedef bool (*DaoOrderSummaryVisitor)(const OrderSummaryView *row, void *user_data);
+typedef bool (*DaoOrderItemVisitor)(const OrderItemView *row, void *user_data);
+typedef bool (*DaoDailyReportVisitor)(const DailyReportRowView *row, void *user_data);
+typedef bool (*DaoReservationVisitor)(const ReservationView *row, void *user_data);
+typedef bool (*DaoKitchenTicketVisitor)(const KitchenTicketView *row, void *user_data);
+
+bool dao_get_user_by_username(Database *db, const char *username, User *user);
+bool dao_create_order(Database *db, int table_id, int user_id, int *order_id);
+bool dao_add_item_to_order(Database *db, int order_id, int menu_item_id, const char *notes);
+bool dao_add_items_to_order(Database *db, int order_id, const OrderItemRequest *items, int count);
+bool dao_close_order(Database *db, int order_id);
+bool dao_rebuild_rollups(Database *db);
+bool dao_sum_daily_sales(Database *db, const char *from_date, const char *to_date, SalesTotals *totals);
+/* Solo cambia ítems de comandas abiertas: una cerrada ya sumó a sales_daily*. Un ítem que no aplica no es error. */
+bool dao_update_order_item_status(Database *db, int order_item_id, const char *status);
+bool dao_update_order_item_statuses(Database *db, const OrderItemStatusChange *changes, int count, int *applied);
+bool dao_calculate_order_totals(Database *db, int order_id, double tax_rate, double tip_rate, double discount, double *subtotal, double *tax, double *total);
+bool dao_visit_daily_report(Database *db, const char *date_str, DaoDailyReportVisitor visitor, void *user_data);
+bool dao_export_daily_report(Database *db, const char *date_str, const char *path);
+bool dao_visit_tables(Database *db, DaoTableVisitor visitor, void *user_data);
+bool dao_visit_menu_items(Database *db, DaoMenuItemVisitor visitor, void *user_data);
+bool dao_visit_users(Database *db, DaoUserVisitor visitor, void *user_data);
+bool dao_visit_table_versions(Database *db, DaoTableVersionVisitor visitor, void *user_data);
+bool dao_get_data_version(Database *db, int *data_version);
+bool dao_visit_open_orders(Database *db, DaoOrderIdVisitor visitor, void *user_data);
+bool dao_visit_open_order_summaries(Database *db, DaoOrderSummaryVisitor visitor, void *user_data);
+bool dao_visit_order_items(Database *db, int order_id, DaoOrderItemVisitor visitor, void *user_data);
+/* Lecturas de una sola fila para actualizaciones incrementales; found/visitor indican si la fila existe. */
+bool dao_get_open_order_summary(Database *db, int order_id, OrderSummaryView *summary, bool *found);
+bool dao_visit_order_item(Database *db, int order_item_id, DaoOrderItemVisitor visitor, void *user_data);
+/*
+ * Con since_seq < 0 visita los ítems pendientes de comandas abiertas por antigüedad;
+ * si no, los que cambiaron después de since_seq. seq queda con la secuencia leída
+ * en la misma transacción. station vacío incluye todas las estaciones.
+ */
+bool dao_visit_kitchen_tickets(Database *db, const char *station, long long since_seq, DaoKitchenTicketVisitor visitor, void *user_data, long long *seq);
+bool dao_visit_reservations(Database *db, DaoReservationVisitor visitor, void *user_data);
+bool dao_list_tables(Database *db, TableStatus **tables, int *count);
+bool dao_list_menu_items(Database *db, MenuItem **items, int *count);
+bool dao_list_users(Database *db, User **users, int *count);
+bool dao_list_open_orders(Database *db, int **order_ids, int *count);
+bool dao_list_order_items(Database *db, int order_id, OrderItem **items, int *count);
+bool dao_create_reservation(Database *db, int table_id, const char *name, const char *phone, const char *reserved_at, const char *notes, int *reservation_id);
+bool dao_cancel_reservation(Database *db, int reservation_id);
+bool dao_list_reservations(Database *db, Reservation **reservations, int *count);
+/*
+ * Reservas con from <= reserved_at < to en orden (reserved_at, id), de a limit filas.
+ * after_key NULL pide la primera página; si no, la que sigue a esa fila.
+ */
+bool dao_visit_reservations_window(Database *db, const char *from, const char *to, const ReservationKey *after_key, int limit, DaoReservationVisitor visitor, void *user_data);
+bool dao_list_reservations_window(Database *db, const char *from, const char *to, const ReservationKey *after_key, int limit, Reservation **reservations, int *count);
+/* Filas: TableRowView, MenuItemView, int, OrderItemView y ReservationView respectivamente. */
+bool dao_query_tables(Database *db, DaoResultSet *set);
+bool dao_query_menu_items(Database *db, DaoResultSet *set);
+bool dao_query_open_orders(Database *db, DaoResultSet *set);
+bool dao_query_order_items(Database *db, int order_id, DaoResultSet *set);
+bool dao_query_reservations(Database *db, DaoResultSet *set);
+size_t dao_result_set_memory(const DaoResultSet *set);
+void dao_result_set_free(DaoResultSet *set);
 void dao_free_tables(TableStatus *tables);
 void dao_free_menu_items(MenuItem *items);
+void dao_free_users(User *users);
 void dao_free_order_ids(int *order_ids);
 void dao_free_order_items(OrderItem *items);
 void dao_free_reservations(Reservation *reservations);
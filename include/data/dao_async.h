@@ -0,0 +1,38 @@
+#ifndef DATA_DAO_ASYNC_H
+#define DATA_DAO_ASYNC_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include "data/database.h"
+#include "util/config.h"
+#include "util/logger.h"
+
+typedef bool (*DaoJobFunc)(Database *db, gpointer job_data);
+typedef void (*DaoJobDone)(bool ok, gpointer job_data, gpointer user_data);
+
+typedef struct DaoWorker DaoWorker;
+
+/*
+ * Un hilo escritor dueño de la conexión principal y N hilos lectores, cada uno
+ * con su propia conexión de solo lectura. Los callbacks `done` se ejecutan en el
+ * GMainContext del hilo que llamó a dao_async_open.
+ */
+typedef struct DaoAsync {
+    GMainContext *main_context;
+    GAsyncQueue *read_queue;
+    GAsyncQueue *write_queue;
+    DaoWorker *writer;
+    DaoWorker *readers;
+    int reader_count;
+    gint detached;
+    /* El del escritor: espera en cola y ejecución de cada trabajo, por tipo de cola. */
+    Metrics *metrics;
+} DaoAsync;
+
+bool dao_async_open(DaoAsync *pool, Database *writer, const char *path, const StorageProfile *profile, int reader_count, Logger *logger);
+void dao_async_read(DaoAsync *pool, DaoJobFunc func, gpointer job_data, GDestroyNotify free_data, DaoJobDone done, gpointer user_data);
+void dao_async_write(DaoAsync *pool, DaoJobFunc func, gpointer job_data, GDestroyNotify free_data, DaoJobDone done, gpointer user_data);
+void dao_async_detach(DaoAsync *pool);
+void dao_async_close(DaoAsync *pool);
+
+#endif
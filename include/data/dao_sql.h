@@ -0,0 +1,72 @@
+#ifndef DATA_DAO_SQL_H
+#define DATA_DAO_SQL_H
+
+/* Todo el SQL fijo de dao.c y database.c vive aquí para poder recorrerlo desde las pruebas
+   de planes de consulta. Las direcciones son estables, como exige la caché de sentencias. */
+typedef enum DaoPlanExpectation {
+    DAO_PLAN_ANY,
+    DAO_PLAN_NO_TEMP_SORT,
+    DAO_PLAN_INDEXED
+} DaoPlanExpectation;
+
+typedef struct DaoSqlStatement {
+    const char *name;
+    const char *sql;
+    DaoPlanExpectation plan;
+} DaoSqlStatement;
+
+extern const char DAO_SQL_USER_BY_USERNAME[];
+extern const char DAO_SQL_ORDER_INSERT[];
+extern const char DAO_SQL_TABLE_OCCUPY[];
+extern const char DAO_SQL_ORDER_ITEM_INSERT[];
+extern const char DAO_SQL_ORDER_ITEM_SET_STATUS[];
+extern const char DAO_SQL_ORDER_SUBTOTAL[];
+extern const char DAO_SQL_DAILY_REPORT[];
+extern const char DAO_SQL_TABLES_LIST[];
+extern const char DAO_SQL_MENU_ITEMS_LIST[];
+extern const char DAO_SQL_USERS_LIST[];
+extern const char DAO_SQL_DATA_VERSION[];
+extern const char DAO_SQL_TABLE_VERSIONS[];
+extern const char DAO_SQL_OPEN_ORDERS[];
+extern const char DAO_SQL_OPEN_ORDER_SUMMARIES[];
+extern const char DAO_SQL_ORDER_ITEMS_BY_ORDER[];
+extern const char DAO_SQL_ORDER_ITEM_BY_ID[];
+extern const char DAO_SQL_OPEN_ORDER_SUMMARY_BY_ID[];
+extern const char DAO_SQL_KITCHEN_SEQ[];
+extern const char DAO_SQL_KITCHEN_PENDING[];
+extern const char DAO_SQL_KITCHEN_CHANGES[];
+extern const char DAO_SQL_RESERVATION_INSERT[];
+extern const char DAO_SQL_RESERVATION_DELETE[];
+extern const char DAO_SQL_RESERVATIONS_LIST[];
+extern const char DAO_SQL_RESERVATIONS_WINDOW[];
+extern const char DAO_SQL_ORDER_CLOSE[];
+extern const char DAO_SQL_TABLE_RELEASE[];
+extern const char DAO_SQL_ROLLUP_DAILY_ADD[];
+extern const char DAO_SQL_ROLLUP_WAITER_ADD[];
+extern const char DAO_SQL_ROLLUP_TABLE_ADD[];
+extern const char DAO_SQL_ROLLUP_ITEM_ADD[];
+extern const char DAO_SQL_ROLLUP_DAILY_CLEAR[];
+extern const char DAO_SQL_ROLLUP_WAITER_CLEAR[];
+extern const char DAO_SQL_ROLLUP_TABLE_CLEAR[];
+extern const char DAO_SQL_ROLLUP_ITEM_CLEAR[];
+extern const char DAO_SQL_ROLLUP_DAILY_REBUILD[];
+extern const char DAO_SQL_ROLLUP_WAITER_REBUILD[];
+extern const char DAO_SQL_ROLLUP_TABLE_REBUILD[];
+extern const char DAO_SQL_ROLLUP_ITEM_REBUILD[];
+extern const char DAO_SQL_SALES_RANGE_TOTAL[];
+extern const char DAO_SQL_BEGIN[];
+extern const char DAO_SQL_COMMIT[];
+extern const char DAO_SQL_ROLLBACK[];
+extern const char DAO_SQL_SCHEMA_VERSION_CREATE[];
+extern const char DAO_SQL_SCHEMA_VERSION_CURRENT[];
+extern const char DAO_SQL_SCHEMA_VERSION_INSERT[];
+extern const char DAO_SQL_SCHEMA_USER_VERSION[];
+extern const char DAO_SQL_SEED_NEEDED[];
+extern const char DAO_SQL_SEED_USER[];
+extern const char DAO_SQL_SEED_TABLE[];
+extern const char DAO_SQL_SEED_MENU_ITEM[];
+extern const char DAO_SQL_SEED_RESERVATION[];
+
+const DaoSqlStatement *dao_sql_statements(int *count);
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <sqlite3.h>
 #include <stdbool.h>
+#include "data/statement_cache.h"
+#include "util/config.h"
 #include "util/logger.h"
 
 typedef struct Migration {
@@ -10,9 +12,44 @@ typedef struct Migration {
     const char *sql;
 } Migration;
 
-bool database_open(sqlite3 **db, const char *path, Logger *logger);
-void database_close(sqlite3 *db);
-bool database_apply_migrations(sqlite3 *db, const Migration *migrations, int migration_count, Logger *logger);
-bool database_seed(sqlite3 *db, Logger *logger);
+typedef void (*DatabaseCommitListener)(void *user_data);
+
+typedef struct Database {
+    sqlite3 *handle;
+    StatementCache statements;
+    /* Registro de métricas compartido por todas las conexiones; NULL no mide. */
+    Metrics *metrics;
+    /* PRAGMA data_version y total_changes con que esta conexión validó por última vez la caché de instantáneas. */
+    bool snapshot_stamped;
+    int snapshot_data_version;
+    int snapshot_total_changes;
+    /* Ídem para el sondeo de la pantalla de cocina, más la secuencia que esta conexión ya entregó. */
+    bool kitchen_stamped;
+    int kitchen_data_version;
+    int kitchen_total_changes;
+    long long kitchen_seq;
+    /*
+     * Se llama al liberar una sentencia sin transacción abierta: el commit que
+     * haya hecho ya terminó y es visible para las demás conexiones.
+     */
+    DatabaseCommitListener after_commit;
+    void *after_commit_data;
+} Database;
+
+bool database_open(Database **db, const char *path, const StorageProfile *profile, Logger *logger);
+bool database_open_readonly(Database **db, const char *path, const StorageProfile *profile, Logger *logger);
+void database_close(Database *db);
+sqlite3_stmt *database_prepare(Database *db, const char *sql);
+void database_release(Database *db, sqlite3_stmt *stmt);
+bool database_begin(Database *db);
+bool database_commit(Database *db);
+void database_rollback(Database *db);
+void database_set_metrics(Database *db, Metrics *metrics);
+void database_set_after_commit(Database *db, DatabaseCommitListener listener, void *user_data);
+void database_statement_stats(const Database *db, unsigned long *hits, unsigned long *misses);
+bool database_schema_is_current(Database *db, const Migration *migrations, int migration_count);
+bool database_apply_migrations(Database *db, const Migration *migrations, int migration_count, Logger *logger);
+bool database_needs_seed(Database *db, bool *needed);
+bool database_seed(Database *db, Logger *logger);
 
 #endif
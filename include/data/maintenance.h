@@ -0,0 +1,36 @@
+#ifndef DATA_MAINTENANCE_H
+#define DATA_MAINTENANCE_H
+
+#include <stdbool.h>
+#include <time.h>
+#include "data/database.h"
+#include "util/logger.h"
+
+typedef enum MaintenanceTask {
+    MAINTENANCE_TASK_NONE = 0,
+    MAINTENANCE_TASK_CHECKPOINT_PASSIVE,
+    MAINTENANCE_TASK_CHECKPOINT_TRUNCATE,
+    MAINTENANCE_TASK_OPTIMIZE,
+    MAINTENANCE_TASK_INCREMENTAL_VACUUM
+} MaintenanceTask;
+
+typedef struct MaintenanceScheduler {
+    Database *db;
+    Logger *logger;
+    int last_total_changes;
+    int idle_ticks;
+    bool wal_mode;
+    bool dirty_wal;
+    time_t last_optimize;
+    time_t last_vacuum;
+    int optimize_interval_s;
+    int vacuum_interval_s;
+    int truncate_after_idle_ticks;
+    int vacuum_pages_per_tick;
+} MaintenanceScheduler;
+
+void maintenance_init(MaintenanceScheduler *scheduler, Database *db, Logger *logger);
+MaintenanceTask maintenance_tick(MaintenanceScheduler *scheduler, time_t now);
+void maintenance_finish(MaintenanceScheduler *scheduler);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef DATA_MIGRATIONS_H
+#define DATA_MIGRATIONS_H
+
+#include "data/database.h"
+
+/* Replicadas en migrations/ para referencia; el orden del arreglo es el de aplicación. */
+extern const Migration MIGRATIONS[];
+extern const int MIGRATION_COUNT;
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef DATA_SNAPSHOT_CACHE_H
+#define DATA_SNAPSHOT_CACHE_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "data/dao.h"
+#include "data/database.h"
+
+typedef enum SnapshotKind {
+    SNAPSHOT_MENU_ITEMS = 0,
+    SNAPSHOT_TABLES = 1,
+    SNAPSHOT_USERS = 2,
+    SNAPSHOT_KIND_COUNT = 3
+} SnapshotKind;
+
+/*
+ * Copia inmutable de una tabla chica. Filas: MenuItem, TableStatus o User según
+ * kind, en el orden del listado del DAO. Se comparte entre hilos con conteo de
+ * referencias: quien la obtiene con snapshot_cache_acquire la suelta con snapshot_release.
+ */
+typedef struct Snapshot {
+    gint refs;
+    SnapshotKind kind;
+    int version;
+    void *rows;
+    size_t row_size;
+    int count;
+    int *slots;
+    int slot_mask;
+} Snapshot;
+
+/*
+ * Caché de proceso para menú, mesas y usuarios. Cada conexión la valida con
+ * PRAGMA data_version y sqlite3_total_changes; solo si otra conexión (o ella
+ * misma) escribió se leen los contadores de table_versions, y solo se
+ * reconstruyen las tablas cuyo contador cambió.
+ */
+typedef struct SnapshotCache {
+    GMutex lock;
+    Snapshot *snapshots[SNAPSHOT_KIND_COUNT];
+    unsigned long hits;
+    unsigned long validations;
+    unsigned long rebuilds;
+} SnapshotCache;
+
+void snapshot_cache_init(SnapshotCache *cache);
+Snapshot *snapshot_cache_acquire(SnapshotCache *cache, Database *db, SnapshotKind kind);
+void snapshot_cache_clear(SnapshotCache *cache);
+void snapshot_release(Snapshot *snapshot);
+const MenuItem *snapshot_menu_item(const Snapshot *snapshot, int id);
+const TableStatus *snapshot_table(const Snapshot *snapshot, int id);
+const User *snapshot_user(const Snapshot *snapshot, int id);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef DATA_STATEMENT_CACHE_H
+#define DATA_STATEMENT_CACHE_H
+
+#include <sqlite3.h>
+#include <stdbool.h>
+#include "util/metrics.h"
+
+/* Las sentencias se indexan por la dirección del SQL, que debe ser un literal estático. */
+typedef struct StatementCacheEntry {
+    const char *sql;
+    sqlite3_stmt *stmt;
+    /* Latencia entre database_prepare y database_release; NULL sin métricas. */
+    MetricsHistogram *latency;
+    gint64 started_us;
+} StatementCacheEntry;
+
+typedef struct StatementCache {
+    StatementCacheEntry *entries;
+    int count;
+    int capacity;
+    unsigned long hits;
+    unsigned long misses;
+} StatementCache;
+
+void statement_cache_init(StatementCache *cache);
+sqlite3_stmt *statement_cache_acquire(StatementCache *cache, sqlite3 *db, const char *sql);
+StatementCacheEntry *statement_cache_entry(StatementCache *cache, sqlite3_stmt *stmt);
+void statement_cache_release(StatementCache *cache, sqlite3_stmt *stmt);
+void statement_cache_clear(StatementCache *cache);
+
+#endif
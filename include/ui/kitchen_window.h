@@ -0,0 +1,10 @@
+#ifndef UI_KITCHEN_WINDOW_H
+#define UI_KITCHEN_WINDOW_H
+
+#include <gtk/gtk.h>
+#include "app_context.h"
+
+/* Pantalla de cocina de --kitchen-display: tickets pendientes de ctx->kitchen_station. */
+GtkWidget *ui_kitchen_window_new(AppContext *ctx, GtkApplication *app);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef UI_ROW_MODEL_H
+#define UI_ROW_MODEL_H
+
+#include <gtk/gtk.h>
+#include <stdbool.h>
+
+/* Fila de texto tal como la arman los trabajos de lectura; secondary y extra son opcionales. */
+typedef struct UiTextRow {
+    int id;
+    char *primary;
+    char *secondary;
+    char *extra;
+} UiTextRow;
+
+void ui_text_row_clear(gpointer data);
+
+/*
+ * GListModel sobre un GArray de UiTextRow. Las filas viven como structs planos;
+ * el objeto UiRowItem se crea recién cuando GtkListView pide una posición
+ * visible, así que una lista de 100k filas no crea 100k objetos ni widgets.
+ */
+#define UI_TYPE_ROW_ITEM (ui_row_item_get_type())
+G_DECLARE_FINAL_TYPE(UiRowItem, ui_row_item, UI, ROW_ITEM, GObject)
+
+#define UI_TYPE_ROW_MODEL (ui_row_model_get_type())
+G_DECLARE_FINAL_TYPE(UiRowModel, ui_row_model, UI, ROW_MODEL, GObject)
+
+UiRowModel *ui_row_model_new(void);
+/* Reemplaza todas las filas; el modelo toma una referencia al arreglo. */
+void ui_row_model_set_rows(UiRowModel *model, GArray *rows);
+void ui_row_model_clear(UiRowModel *model);
+/* Agrega las filas al final (una página más); se adueña de sus textos. */
+void ui_row_model_append_rows(UiRowModel *model, GArray *rows);
+/* Reemplaza la fila con el mismo id o la agrega; se adueña de los textos de row. */
+void ui_row_model_upsert(UiRowModel *model, UiTextRow *row, bool prepend);
+void ui_row_model_remove(UiRowModel *model, int id);
+const UiTextRow *ui_row_model_get_row(UiRowModel *model, guint position);
+guint ui_row_model_get_count(UiRowModel *model);
+
+/* Fábrica de filas reciclables: una etiqueta por texto no vacío. */
+GtkListItemFactory *ui_row_factory_new(GtkOrientation orientation);
+/* GtkListView dentro de un GtkScrolledWindow; devuelve el scroll y deja la vista en list_view. */
+GtkWidget *ui_row_list_new(UiRowModel *model, GtkOrientation orientation, GtkWidget **list_view);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef UTIL_ARENA_H
+#define UTIL_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Arena por bloques: las asignaciones no se liberan una a una, todo se suelta con arena_free. */
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock *head;
+    size_t block_size;
+    size_t bytes_reserved;
+    size_t bytes_used;
+} Arena;
+
+typedef struct ArenaInterner {
+    const char **slots;
+    size_t capacity;
+    size_t count;
+} ArenaInterner;
+
+void arena_init(Arena *arena, size_t block_size);
+void *arena_alloc(Arena *arena, size_t size);
+char *arena_strdup(Arena *arena, const char *text);
+void arena_free(Arena *arena);
+
+void arena_interner_init(ArenaInterner *interner);
+const char *arena_intern(ArenaInterner *interner, Arena *arena, const char *text);
+void arena_interner_free(ArenaInterner *interner);
+
+#endif
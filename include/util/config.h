@@ -3,12 +3,57 @@
 
 #include <stdbool.h>
 
+typedef struct StorageProfile {
+    char journal_mode[16];
+    char synchronous[16];
+    int cache_size_kib;
+    long long mmap_size;
+    char temp_store[16];
+    int busy_timeout_ms;
+    char auto_vacuum[16];
+    int maintenance_interval_s;
+    int read_connections;
+} StorageProfile;
+
+/* Cola de cambios de estado de cocina: se escriben en lote cada flush_interval_ms o al llegar a max_entries. */
+typedef struct StatusQueueProfile {
+    int flush_interval_ms;
+    int max_entries;
+    int max_delay_ms;
+} StatusQueueProfile;
+
+/* Log: con async los registros pasan por un buffer circular; overflow es "drop" o "block" y format "text" o "json". */
+typedef struct LogProfile {
+    char level[8];
+    char format[8];
+    bool async;
+    int buffer_records;
+    char overflow[8];
+} LogProfile;
+
+/* Volcado periódico de métricas a path; format "prometheus" o "json", dump_interval_s en 0 lo apaga. */
+typedef struct MetricsProfile {
+    char path[512];
+    char format[12];
+    int dump_interval_s;
+} MetricsProfile;
+
 typedef struct AppConfig {
     char database_path[512];
     char locale[16];
     char currency[8];
     double tax_rate;
     char receipt_output_dir[512];
+    StorageProfile storage;
+    StatusQueueProfile status_queue;
+    LogProfile log;
+    MetricsProfile metrics;
+    /* Cada cuánto la pantalla de cocina pregunta si hubo cambios. */
+    int kitchen_poll_ms;
+    /* Días hacia atrás y hacia adelante de hoy que muestra la lista de reservas. */
+    int reservations_window_days;
+    /* Minutos que se considera ocupada una mesa reservada. */
+    int reservation_seating_min;
 } AppConfig;
 
 bool config_load(AppConfig *config, const char *path);
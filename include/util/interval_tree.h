@@ -0,0 +1,26 @@
+#ifndef UTIL_INTERVAL_TREE_H
+#define UTIL_INTERVAL_TREE_H
+
+#include <stdbool.h>
+
+/*
+ * Árbol de intervalos semiabiertos [start, end): AVL ordenado por (start, id)
+ * y aumentado con el mayor end de cada subárbol, así que insertar, quitar y
+ * buscar un solapamiento cuestan O(log n).
+ */
+typedef struct IntervalNode IntervalNode;
+
+typedef struct IntervalTree {
+    IntervalNode *root;
+    int count;
+} IntervalTree;
+
+void interval_tree_init(IntervalTree *tree);
+/* Falla si ya hay un intervalo con el mismo (start, id) o si end <= start. */
+bool interval_tree_insert(IntervalTree *tree, long long start, long long end, int id);
+bool interval_tree_remove(IntervalTree *tree, long long start, int id);
+/* true si algún intervalo se solapa con [start, end); deja su id en id si no es NULL. */
+bool interval_tree_find_overlap(const IntervalTree *tree, long long start, long long end, int *id);
+void interval_tree_clear(IntervalTree *tree);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <glib.h>
 
 typedef enum LogLevel {
     LOG_LEVEL_DEBUG = 0,
@@ -11,16 +12,103 @@ typedef enum LogLevel {
     LOG_LEVEL_ERROR = 3
 } LogLevel;
 
+/* Los mensajes más largos se truncan al copiarlos al buffer. */
+#define LOGGER_MESSAGE_MAX 512
+#define LOGGER_COMPONENT_MAX 24
+#define LOGGER_FIELDS_MAX 256
+
+/* Texto: "HH:MM:SS [NIVEL] componente: mensaje k=v"; JSON: un objeto por línea en <fecha>.jsonl. */
+typedef enum LogFormat {
+    LOG_FORMAT_TEXT = 0,
+    LOG_FORMAT_JSON = 1
+} LogFormat;
+
+typedef enum LogFieldType {
+    LOG_FIELD_INT = 0,
+    LOG_FIELD_DOUBLE,
+    LOG_FIELD_STRING
+} LogFieldType;
+
+/* Campo clave=valor; se arma con LOG_INT, LOG_DOUBLE o LOG_STR y se pasa con LOG_FIELDS. */
+typedef struct LogField {
+    const char *key;
+    LogFieldType type;
+    long long int_value;
+    double double_value;
+    const char *string_value;
+} LogField;
+
+#define LOG_INT(key, value) ((LogField){(key), LOG_FIELD_INT, (long long)(value), 0.0, NULL})
+#define LOG_DOUBLE(key, value) ((LogField){(key), LOG_FIELD_DOUBLE, 0, (double)(value), NULL})
+#define LOG_STR(key, value) ((LogField){(key), LOG_FIELD_STRING, 0, 0.0, (value)})
+#define LOG_FIELDS(...) (const LogField[]){__VA_ARGS__}, (int)(sizeof((const LogField[]){__VA_ARGS__}) / sizeof(LogField))
+
+/* Casillero del buffer circular; sequence indica si está libre o listo para escribir. */
+typedef struct LogRecord {
+    gint sequence;
+    LogLevel level;
+    gint64 time_us;
+    char component[LOGGER_COMPONENT_MAX];
+    char message[LOGGER_MESSAGE_MAX];
+    char fields[LOGGER_FIELDS_MAX];
+} LogRecord;
+
+/*
+ * Cola acotada de varios productores y un consumidor, sin locks: cada productor
+ * reserva un casillero con compare-and-exchange sobre head y lo publica
+ * actualizando su sequence; el hilo escritor es el único que avanza tail.
+ */
+typedef struct LogRing {
+    LogRecord *slots;
+    guint mask;
+    gint head;
+    guint tail;
+} LogRing;
+
 typedef struct Logger {
     FILE *file;
     LogLevel level;
     char current_date[16];
     char directory[512];
+    GMutex lock;
+    gint64 stamp_second;
+    char stamp_time[16];
+    char stamp_date_time[24];
+    LogFormat format;
+    bool async;
+    bool block_when_full;
+    LogRing ring;
+    GThread *flusher;
+    GCond wake;
+    gint flusher_idle;
+    gint stopping;
+    gint dropped;
+    int dropped_reported;
+    unsigned long written;
+    unsigned long batches;
 } Logger;
 
 bool logger_init(Logger *logger, const char *directory, LogLevel level);
+/*
+ * Pasa a modo asíncrono: logger_log copia el registro al buffer y vuelve; un hilo
+ * arma las líneas y las escribe en lote con un fflush por lote. Con el buffer
+ * lleno block_when_full espera lugar y, si no, descarta el registro y lo cuenta.
+ * ERROR nunca se descarta. logger_close escribe todo lo pendiente antes de cerrar.
+ */
+bool logger_start_async(Logger *logger, int buffer_records, bool block_when_full);
 void logger_close(Logger *logger);
 void logger_log(Logger *logger, LogLevel level, const char *component, const char *message);
+/* El nivel se compara antes de formatear: un DEBUG apagado no cuesta el vsnprintf. */
+void logger_logf(Logger *logger, LogLevel level, const char *component, const char *format, ...) G_GNUC_PRINTF(4, 5);
+/* Uso: logger_log_fields(logger, LOG_LEVEL_ERROR, "order", "No se pudo crear la comanda", LOG_FIELDS(LOG_INT("table_id", id))). */
+void logger_log_fields(Logger *logger, LogLevel level, const char *component, const char *message, const LogField *fields, int field_count);
+/* Para argumentos caros de calcular: consultar antes de armarlos. */
+bool logger_enabled(const Logger *logger, LogLevel level);
+/* Cambia el formato y reabre el archivo del día con la extensión que corresponde; antes de logger_start_async. */
+bool logger_set_format(Logger *logger, LogFormat format);
+LogFormat logger_format_from_string(const char *text);
 void logger_set_level(Logger *logger, LogLevel level);
+/* DEBUG, INFO, WARN o ERROR; cualquier otro texto devuelve fallback. */
+LogLevel logger_level_from_string(const char *text, LogLevel fallback);
 
 #endif
@@ -0,0 +1,112 @@
+#ifndef UTIL_METRICS_H
+#define UTIL_METRICS_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+/*
+ * Histogramas log-lineales en microsegundos: 4 sub-buckets por potencia de dos
+ * (error relativo <= 25%) hasta ~134 s; lo que exceda cae en el último. Registrar
+ * una muestra son tres sumas atómicas, sin locks.
+ */
+#define METRICS_SUB_BUCKET_BITS 2
+#define METRICS_BUCKETS 108
+#define METRICS_MAX_STATEMENTS 128
+#define METRICS_NAME_MAX 48
+
+typedef struct MetricsHistogram {
+    char family[16];
+    char name[METRICS_NAME_MAX];
+    gint buckets[METRICS_BUCKETS];
+    gint max_us;
+    gsize sum_us;
+} MetricsHistogram;
+
+/* Operaciones fijas: se indexan sin buscar por nombre. */
+typedef enum MetricsOp {
+    METRICS_OP_DAO_CREATE_ORDER = 0,
+    METRICS_OP_DAO_ADD_ITEM,
+    METRICS_OP_DAO_ADD_ITEMS,
+    METRICS_OP_DAO_CLOSE_ORDER,
+    METRICS_OP_DAO_UPDATE_STATUS,
+    METRICS_OP_DAO_UPDATE_STATUSES,
+    METRICS_OP_DAO_ORDER_TOTALS,
+    METRICS_OP_DAO_EXPORT_DAILY_REPORT,
+    METRICS_OP_DAO_REBUILD_ROLLUPS,
+    METRICS_OP_AUTH_LOGIN,
+    METRICS_OP_ORDER_CREATE,
+    METRICS_OP_ORDER_ADD_ITEMS,
+    METRICS_OP_ORDER_FLUSH_STATUSES,
+    METRICS_OP_ORDER_CLOSE,
+    METRICS_OP_ORDER_TOTALS,
+    METRICS_OP_REPORT_DAILY,
+    METRICS_OP_REPORT_RANGE,
+    METRICS_OP_RESERVATION_CREATE,
+    METRICS_OP_UI_READ_WAIT,
+    METRICS_OP_UI_READ_RUN,
+    METRICS_OP_UI_WRITE_WAIT,
+    METRICS_OP_UI_WRITE_RUN,
+    METRICS_OP_COUNT
+} MetricsOp;
+
+typedef enum MetricsCounter {
+    METRICS_COUNTER_LOGINS_OK = 0,
+    METRICS_COUNTER_LOGINS_FAILED,
+    METRICS_COUNTER_ORDERS_CREATED,
+    METRICS_COUNTER_ITEMS_ADDED,
+    METRICS_COUNTER_ORDERS_CLOSED,
+    METRICS_COUNTER_JOBS_FAILED,
+    METRICS_COUNTER_COUNT
+} MetricsCounter;
+
+typedef enum MetricsGauge {
+    METRICS_GAUGE_READ_QUEUE = 0,
+    METRICS_GAUGE_WRITE_QUEUE,
+    METRICS_GAUGE_STATUS_QUEUE,
+    METRICS_GAUGE_COUNT
+} MetricsGauge;
+
+typedef enum MetricsFormat {
+    METRICS_FORMAT_PROMETHEUS = 0,
+    METRICS_FORMAT_JSON = 1
+} MetricsFormat;
+
+/* Las sentencias SQL se registran al prepararse por primera vez; el puntero devuelto es estable. */
+typedef struct Metrics {
+    GMutex lock;
+    gint64 started_us;
+    MetricsHistogram ops[METRICS_OP_COUNT];
+    MetricsHistogram *statements[METRICS_MAX_STATEMENTS];
+    gint statement_count;
+    gint counters[METRICS_COUNTER_COUNT];
+    gint gauges[METRICS_GAUGE_COUNT];
+} Metrics;
+
+/* Resumen de un histograma en milisegundos; los percentiles son el borde superior del bucket. */
+typedef struct MetricsSummary {
+    char family[16];
+    char name[METRICS_NAME_MAX];
+    long long count;
+    double sum_ms;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+} MetricsSummary;
+
+void metrics_init(Metrics *metrics);
+void metrics_clear(Metrics *metrics);
+void metrics_histogram_record(MetricsHistogram *histogram, gint64 elapsed_us);
+/* Todas aceptan metrics en NULL (sin métricas) y no hacen nada. */
+void metrics_observe(Metrics *metrics, MetricsOp op, gint64 started_us);
+MetricsHistogram *metrics_statement(Metrics *metrics, const char *name);
+void metrics_count(Metrics *metrics, MetricsCounter counter, int delta);
+void metrics_gauge_set(Metrics *metrics, MetricsGauge gauge, int value);
+bool metrics_summarize(const MetricsHistogram *histogram, MetricsSummary *summary);
+/* Histogramas con al menos una muestra, en orden: operaciones y después sentencias. */
+GArray *metrics_snapshot(Metrics *metrics);
+GString *metrics_render(Metrics *metrics, MetricsFormat format);
+bool metrics_write_file(Metrics *metrics, const char *path, MetricsFormat format);
+MetricsFormat metrics_format_from_string(const char *text);
+
+#endif
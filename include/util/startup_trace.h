@@ -0,0 +1,46 @@
+#ifndef UTIL_STARTUP_TRACE_H
+#define UTIL_STARTUP_TRACE_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "util/logger.h"
+
+#define STARTUP_TRACE_MAX_PHASES 32
+
+typedef enum StartupTraceFormat {
+    STARTUP_TRACE_TABLE = 0,
+    STARTUP_TRACE_JSON = 1
+} StartupTraceFormat;
+
+/* Los nombres de fase deben ser literales: se guardan por puntero. */
+typedef struct StartupTracePhase {
+    const char *name;
+    gint64 start_us;
+    gint64 end_us;
+    bool shutdown;
+} StartupTracePhase;
+
+/*
+ * Tiempos monotónicos de cada fase del arranque (hasta el primer cuadro) y del
+ * cierre. Con enabled en false todas las funciones son no-ops.
+ */
+typedef struct StartupTrace {
+    bool enabled;
+    StartupTraceFormat format;
+    int budget_ms;
+    gint64 origin_us;
+    gint64 last_us;
+    gint64 first_frame_us;
+    bool shutting_down;
+    StartupTracePhase phases[STARTUP_TRACE_MAX_PHASES];
+    int count;
+} StartupTrace;
+
+void startup_trace_init(StartupTrace *trace, int argc, char **argv);
+void startup_trace_mark(StartupTrace *trace, const char *phase);
+void startup_trace_first_frame(StartupTrace *trace);
+void startup_trace_begin_shutdown(StartupTrace *trace);
+bool startup_trace_report(const StartupTrace *trace, Logger *logger, FILE *out);
+
+#endif
@@ -0,0 +1,28 @@
+-- Totales acumulados por comanda y precio unitario congelado al pedir.
+ALTER TABLE order_items ADD COLUMN unit_price REAL NOT NULL DEFAULT 0;
+ALTER TABLE orders ADD COLUMN subtotal REAL NOT NULL DEFAULT 0;
+ALTER TABLE orders ADD COLUMN item_count INTEGER NOT NULL DEFAULT 0;
+
+UPDATE order_items SET unit_price = IFNULL((SELECT price FROM menu_items WHERE id = order_items.menu_item_id), 0);
+UPDATE orders SET
+    subtotal = IFNULL((SELECT ROUND(SUM(unit_price), 2) FROM order_items WHERE order_id = orders.id AND status <> 'anulado'), 0),
+    item_count = (SELECT COUNT(*) FROM order_items WHERE order_id = orders.id AND status <> 'anulado');
+
+CREATE TRIGGER IF NOT EXISTS trg_order_items_insert AFTER INSERT ON order_items
+WHEN NEW.status <> 'anulado'
+BEGIN
+    UPDATE orders SET subtotal = ROUND(subtotal + NEW.unit_price, 2), item_count = item_count + 1 WHERE id = NEW.order_id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_order_items_delete AFTER DELETE ON order_items
+WHEN OLD.status <> 'anulado'
+BEGIN
+    UPDATE orders SET subtotal = ROUND(subtotal - OLD.unit_price, 2), item_count = item_count - 1 WHERE id = OLD.order_id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_order_items_update AFTER UPDATE OF order_id, unit_price, status ON order_items
+WHEN OLD.order_id <> NEW.order_id OR OLD.unit_price <> NEW.unit_price OR (OLD.status = 'anulado') <> (NEW.status = 'anulado')
+BEGIN
+    UPDATE orders SET subtotal = ROUND(subtotal - OLD.unit_price, 2), item_count = item_count - 1 WHERE id = OLD.order_id AND OLD.status <> 'anulado';
+    UPDATE orders SET subtotal = ROUND(subtotal + NEW.unit_price, 2), item_count = item_count + 1 WHERE id = NEW.order_id AND NEW.status <> 'anulado';
+END;
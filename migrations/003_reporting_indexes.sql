@@ -0,0 +1,15 @@
+-- Fecha de negocio almacenada para filtrar reportes por índice.
+ALTER TABLE orders ADD COLUMN business_date TEXT;
+UPDATE orders SET business_date = DATE(created_at);
+
+CREATE TRIGGER IF NOT EXISTS trg_orders_business_date AFTER INSERT ON orders
+WHEN NEW.business_date IS NULL
+BEGIN
+    UPDATE orders SET business_date = DATE(NEW.created_at) WHERE id = NEW.id;
+END;
+
+CREATE INDEX IF NOT EXISTS idx_orders_business_date ON orders(business_date);
+CREATE INDEX IF NOT EXISTS idx_orders_status_created ON orders(status, created_at);
+CREATE INDEX IF NOT EXISTS idx_reservations_reserved_at ON reservations(reserved_at);
+CREATE INDEX IF NOT EXISTS idx_reservations_table_reserved ON reservations(table_id, reserved_at);
+CREATE INDEX IF NOT EXISTS idx_payments_order ON payments(order_id);
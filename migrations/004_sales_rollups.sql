@@ -0,0 +1,42 @@
+-- Costo congelado por ítem, cierre de comandas y acumulados diarios de ventas.
+ALTER TABLE order_items ADD COLUMN unit_cost REAL NOT NULL DEFAULT 0;
+UPDATE order_items SET unit_cost = IFNULL((SELECT cost FROM menu_items WHERE id = order_items.menu_item_id), 0);
+ALTER TABLE orders ADD COLUMN closed_at TEXT;
+
+CREATE TABLE IF NOT EXISTS sales_daily (
+    business_date TEXT PRIMARY KEY,
+    revenue REAL NOT NULL DEFAULT 0,
+    cost REAL NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    order_count INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS sales_daily_waiter (
+    business_date TEXT NOT NULL,
+    waiter_id INTEGER NOT NULL,
+    revenue REAL NOT NULL DEFAULT 0,
+    cost REAL NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    order_count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY(business_date, waiter_id)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS sales_daily_table (
+    business_date TEXT NOT NULL,
+    table_id INTEGER NOT NULL,
+    revenue REAL NOT NULL DEFAULT 0,
+    cost REAL NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    order_count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY(business_date, table_id)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS sales_daily_item (
+    business_date TEXT NOT NULL,
+    menu_item_id INTEGER NOT NULL,
+    revenue REAL NOT NULL DEFAULT 0,
+    cost REAL NOT NULL DEFAULT 0,
+    item_count INTEGER NOT NULL DEFAULT 0,
+    order_count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY(business_date, menu_item_id)
+) WITHOUT ROWID;
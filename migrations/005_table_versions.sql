@@ -0,0 +1,52 @@
+-- Contador de cambios por tabla para validar las instantáneas en memoria de menú, mesas y usuarios.
+CREATE TABLE IF NOT EXISTS table_versions (
+    name TEXT PRIMARY KEY,
+    version INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID;
+
+INSERT OR IGNORE INTO table_versions(name, version) VALUES ('menu_items', 0), ('tables', 0), ('users', 0);
+
+CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_insert AFTER INSERT ON menu_items
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_update AFTER UPDATE ON menu_items
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_delete AFTER DELETE ON menu_items
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_tables_version_insert AFTER INSERT ON tables
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'tables';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_tables_version_update AFTER UPDATE ON tables
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'tables';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_tables_version_delete AFTER DELETE ON tables
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'tables';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_users_version_insert AFTER INSERT ON users
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'users';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_users_version_update AFTER UPDATE ON users
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'users';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_users_version_delete AFTER DELETE ON users
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'users';
+END;
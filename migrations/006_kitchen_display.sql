@@ -0,0 +1,32 @@
+-- Pantalla de cocina: estación por plato y secuencia de cambios por ítem para consultar solo lo nuevo.
+ALTER TABLE menu_items ADD COLUMN station TEXT NOT NULL DEFAULT 'cocina';
+UPDATE menu_items SET station = 'barra' WHERE category = 'Bebida';
+UPDATE menu_items SET station = 'postres' WHERE category = 'Postre';
+
+ALTER TABLE order_items ADD COLUMN change_seq INTEGER NOT NULL DEFAULT 0;
+
+INSERT OR IGNORE INTO table_versions(name, version) VALUES ('order_items', 0);
+
+CREATE TRIGGER IF NOT EXISTS trg_order_items_seq_insert AFTER INSERT ON order_items
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';
+    UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items') WHERE id = NEW.id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_order_items_seq_status AFTER UPDATE OF status ON order_items
+WHEN OLD.status <> NEW.status
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';
+    UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items') WHERE id = NEW.id;
+END;
+
+-- Al cerrar o reabrir una comanda sus ítems pendientes cambian de visibilidad en cocina.
+CREATE TRIGGER IF NOT EXISTS trg_orders_seq_status AFTER UPDATE OF status ON orders
+WHEN OLD.status <> NEW.status
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';
+    UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items')
+    WHERE order_id = NEW.id AND status IN ('pedido', 'preparacion', 'listo');
+END;
+
+CREATE INDEX IF NOT EXISTS idx_order_items_change_seq ON order_items(change_seq);
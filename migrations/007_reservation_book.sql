@@ -0,0 +1,19 @@
+-- Agenda de reservas: capacidad por mesa y contador de cambios de reservas para validar el índice en memoria.
+ALTER TABLE tables ADD COLUMN capacity INTEGER NOT NULL DEFAULT 4;
+
+INSERT OR IGNORE INTO table_versions(name, version) VALUES ('reservations', 0);
+
+CREATE TRIGGER IF NOT EXISTS trg_reservations_version_insert AFTER INSERT ON reservations
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'reservations';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_reservations_version_update AFTER UPDATE ON reservations
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'reservations';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_reservations_version_delete AFTER DELETE ON reservations
+BEGIN
+    UPDATE table_versions SET version = version + 1 WHERE name = 'reservations';
+END;
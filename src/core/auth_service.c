@@ -13,21 +13,43 @@ static void auth_compute_hash(const char *username, const char *password, char *
     hash_sha256_hex((const unsigned char *)buffer, strlen(buffer), output, output_len);
 }
 
-bool auth_login(AppContext *ctx, const char *username, const char *password, User *user_out) {
+static AuthResult auth_check_user(Database *db, const char *username, const char *password, User *user_out) {
     User user;
     char expected_hash[65];
-    if (!dao_get_user_by_username(ctx->db, username, &user)) {
-        logger_log(&ctx->logger, LOG_LEVEL_WARN, "auth", "Usuario inexistente");
-        return false;
+    if (!dao_get_user_by_username(db, username, &user)) {
+        return AUTH_RESULT_UNKNOWN_USER;
     }
     auth_compute_hash(username, password, expected_hash, sizeof(expected_hash));
     if (strcmp(expected_hash, user.password_hash) != 0) {
-        logger_log(&ctx->logger, LOG_LEVEL_WARN, "auth", "Password inválido");
-        return false;
+        return AUTH_RESULT_BAD_PASSWORD;
     }
     if (user_out != NULL) {
         *user_out = user;
     }
-    logger_log(&ctx->logger, LOG_LEVEL_INFO, "auth", "Login exitoso");
-    return true;
+    return AUTH_RESULT_OK;
+}
+
+AuthResult auth_check_credentials(Database *db, const char *username, const char *password, User *user_out) {
+    gint64 started_us = g_get_monotonic_time();
+    AuthResult result = auth_check_user(db, username, password, user_out);
+    Metrics *metrics = db == NULL ? NULL : db->metrics;
+    metrics_observe(metrics, METRICS_OP_AUTH_LOGIN, started_us);
+    metrics_count(metrics, result == AUTH_RESULT_OK ? METRICS_COUNTER_LOGINS_OK : METRICS_COUNTER_LOGINS_FAILED, 1);
+    return result;
+}
+
+void auth_log_result(AppContext *ctx, AuthResult result) {
+    if (result == AUTH_RESULT_UNKNOWN_USER) {
+        logger_log(&ctx->logger, LOG_LEVEL_WARN, "auth", "Usuario inexistente");
+    } else if (result == AUTH_RESULT_BAD_PASSWORD) {
+        logger_log(&ctx->logger, LOG_LEVEL_WARN, "auth", "Password inválido");
+    } else {
+        logger_log(&ctx->logger, LOG_LEVEL_INFO, "auth", "Login exitoso");
+    }
+}
+
+bool auth_login(AppContext *ctx, const char *username, const char *password, User *user_out) {
+    AuthResult result = auth_check_credentials(ctx->db, username, password, user_out);
+    auth_log_result(ctx, result);
+    return result == AUTH_RESULT_OK;
 }
@@ -0,0 +1,59 @@
+#include "core/kitchen_service.h"
+#include <string.h>
+
+static const char *const KITCHEN_STATUS_FLOW[] = {"pedido", "preparacion", "listo", "servido"};
+
+void kitchen_feed_init(KitchenFeed *feed, const char *station) {
+    memset(feed, 0, sizeof(KitchenFeed));
+    if (station != NULL) {
+        strncpy(feed->station, station, sizeof(feed->station) - 1);
+    }
+}
+
+/*
+ * Sin commits de otras conexiones (data_version) ni propios (total_changes) desde
+ * que esta conexión entregó feed->seq, no hay nada nuevo y no se consulta.
+ */
+static bool kitchen_connection_unchanged(Database *db, const KitchenFeed *feed, int data_version, int total_changes) {
+    return feed->loaded && db->kitchen_stamped && db->kitchen_data_version == data_version && db->kitchen_total_changes == total_changes &&
+           feed->seq >= db->kitchen_seq;
+}
+
+bool kitchen_service_poll(Database *db, KitchenFeed *feed, DaoKitchenTicketVisitor visitor, void *user_data, bool *changed) {
+    int data_version = 0;
+    int total_changes;
+    long long seq = 0;
+    *changed = false;
+    feed->polls = feed->polls + 1;
+    if (!dao_get_data_version(db, &data_version)) {
+        return false;
+    }
+    total_changes = sqlite3_total_changes(db->handle);
+    if (kitchen_connection_unchanged(db, feed, data_version, total_changes)) {
+        feed->skipped = feed->skipped + 1;
+        return true;
+    }
+    if (!dao_visit_kitchen_tickets(db, feed->station, feed->loaded ? feed->seq : -1, visitor, user_data, &seq)) {
+        return false;
+    }
+    db->kitchen_stamped = true;
+    db->kitchen_data_version = data_version;
+    db->kitchen_total_changes = total_changes;
+    db->kitchen_seq = seq;
+    feed->seq = seq;
+    feed->loaded = true;
+    *changed = true;
+    return true;
+}
+
+const char *kitchen_service_next_status(const char *status) {
+    int index = 0;
+    int last = (int)(sizeof(KITCHEN_STATUS_FLOW) / sizeof(KITCHEN_STATUS_FLOW[0])) - 1;
+    while (index < last) {
+        if (strcmp(status, KITCHEN_STATUS_FLOW[index]) == 0) {
+            return KITCHEN_STATUS_FLOW[index + 1];
+        }
+        index = index + 1;
+    }
+    return NULL;
+}
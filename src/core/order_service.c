@@ -1,34 +1,112 @@
 #include "core/order_service.h"
 #include "data/dao.h"
 #include <stdio.h>
+#include <string.h>
 
 bool order_service_create(AppContext *ctx, int table_id, int user_id, int *order_id) {
-    if (!dao_create_order(ctx->db, table_id, user_id, order_id)) {
-        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo crear la comanda");
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_create_order(ctx->db, table_id, user_id, order_id);
+    metrics_observe(&ctx->metrics, METRICS_OP_ORDER_CREATE, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo crear la comanda", LOG_FIELDS(LOG_INT("table_id", table_id), LOG_INT("user_id", user_id)));
         return false;
     }
+    metrics_count(&ctx->metrics, METRICS_COUNTER_ORDERS_CREATED, 1);
     return true;
 }
 
 bool order_service_add_item(AppContext *ctx, int order_id, int menu_item_id, const char *notes) {
     if (!dao_add_item_to_order(ctx->db, order_id, menu_item_id, notes)) {
-        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo agregar el ítem");
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo agregar el ítem", LOG_FIELDS(LOG_INT("order_id", order_id), LOG_INT("menu_item_id", menu_item_id)));
         return false;
     }
+    metrics_count(&ctx->metrics, METRICS_COUNTER_ITEMS_ADDED, 1);
+    return true;
+}
+
+bool order_service_add_items(AppContext *ctx, int order_id, const OrderItemRequest *items, int count) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_add_items_to_order(ctx->db, order_id, items, count);
+    metrics_observe(&ctx->metrics, METRICS_OP_ORDER_ADD_ITEMS, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudieron agregar los ítems", LOG_FIELDS(LOG_INT("order_id", order_id), LOG_INT("count", count)));
+        return false;
+    }
+    metrics_count(&ctx->metrics, METRICS_COUNTER_ITEMS_ADDED, count);
     return true;
 }
 
 bool order_service_update_status(AppContext *ctx, int order_item_id, const char *status) {
-    if (!dao_update_order_item_status(ctx->db, order_item_id, status)) {
-        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo actualizar el estado");
+    const StatusQueueProfile *profile = &ctx->config.status_queue;
+    gint64 now = g_get_monotonic_time();
+    gint64 oldest;
+    int pending;
+    /* Una anulación cambia el subtotal de la comanda: se escribe al instante, igual que con la cola apagada. */
+    if (profile->max_delay_ms <= 0 || strcmp(status, "anulado") == 0) {
+        status_queue_discard(&ctx->statuses, order_item_id);
+        if (!dao_update_order_item_status(ctx->db, order_item_id, status)) {
+            logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo actualizar el estado", LOG_FIELDS(LOG_INT("order_item_id", order_item_id), LOG_STR("status", status)));
+            return false;
+        }
+        return true;
+    }
+    pending = status_queue_put(&ctx->statuses, order_item_id, status, now);
+    oldest = status_queue_oldest(&ctx->statuses);
+    if (pending >= profile->max_entries || now - oldest >= (gint64)profile->max_delay_ms * 1000) {
+        order_service_flush_statuses(ctx);
+    }
+    return true;
+}
+
+bool order_service_flush_statuses(AppContext *ctx) {
+    const OrderItemStatusChange *entries = NULL;
+    int count = status_queue_take(&ctx->statuses, &entries);
+    int applied = 0;
+    gint64 started_us;
+    bool ok;
+    if (count == 0) {
+        return true;
+    }
+    started_us = g_get_monotonic_time();
+    ok = dao_update_order_item_statuses(ctx->db, entries, count, &applied);
+    status_queue_finish(&ctx->statuses, ok);
+    metrics_observe(&ctx->metrics, METRICS_OP_ORDER_FLUSH_STATUSES, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudieron escribir los estados pendientes", LOG_FIELDS(LOG_INT("count", count)));
+        return false;
+    }
+    if (applied < count) {
+        logger_logf(&ctx->logger, LOG_LEVEL_WARN, "order", "%d de %d estados sin ítem (ítems borrados)", count - applied, count);
+    }
+    return true;
+}
+
+bool order_service_pending_status(AppContext *ctx, int order_item_id, char *status, size_t status_len) {
+    return status_queue_lookup(&ctx->statuses, order_item_id, status, status_len);
+}
+
+bool order_service_close(AppContext *ctx, int order_id) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok;
+    if (!order_service_flush_statuses(ctx)) {
+        return false;
+    }
+    ok = dao_close_order(ctx->db, order_id);
+    metrics_observe(&ctx->metrics, METRICS_OP_ORDER_CLOSE, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo cerrar la comanda", LOG_FIELDS(LOG_INT("order_id", order_id)));
         return false;
     }
+    metrics_count(&ctx->metrics, METRICS_COUNTER_ORDERS_CLOSED, 1);
     return true;
 }
 
 bool order_service_calculate_totals(AppContext *ctx, int order_id, double tip_rate, double discount, double *subtotal, double *tax, double *total) {
-    if (!dao_calculate_order_totals(ctx->db, order_id, ctx->config.tax_rate, tip_rate, discount, subtotal, tax, total)) {
-        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo calcular el total");
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_calculate_order_totals(ctx->db, order_id, ctx->config.tax_rate, tip_rate, discount, subtotal, tax, total);
+    metrics_observe(&ctx->metrics, METRICS_OP_ORDER_TOTALS, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "order", "No se pudo calcular el total", LOG_FIELDS(LOG_INT("order_id", order_id)));
         return false;
     }
     return true;
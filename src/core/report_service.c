@@ -1,11 +1,210 @@
 #include "core/report_service.h"
 #include "data/dao.h"
+#include <stdio.h>
+#include <string.h>
+
+#define REPORT_RANGE_MAX_DAYS 3660
 
 bool report_service_export_daily(AppContext *ctx, const char *date_str, const char *output_csv_path) {
-    if (!dao_export_daily_report(ctx->db, date_str, output_csv_path)) {
-        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudo exportar el reporte");
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_export_daily_report(ctx->db, date_str, output_csv_path);
+    metrics_observe(&ctx->metrics, METRICS_OP_REPORT_DAILY, started_us);
+    if (!ok) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudo exportar el reporte", LOG_FIELDS(LOG_STR("date", date_str), LOG_STR("path", output_csv_path)));
         return false;
     }
-    logger_log(&ctx->logger, LOG_LEVEL_INFO, "report", "Reporte diario exportado");
+    logger_log_fields(&ctx->logger, LOG_LEVEL_INFO, "report", "Reporte diario exportado", LOG_FIELDS(LOG_STR("date", date_str), LOG_STR("path", output_csv_path)));
     return true;
 }
+
+bool report_service_rebuild_rollups(AppContext *ctx) {
+    if (!dao_rebuild_rollups(ctx->db)) {
+        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudieron reconstruir los acumulados");
+        return false;
+    }
+    logger_log(&ctx->logger, LOG_LEVEL_INFO, "report", "Acumulados de ventas reconstruidos");
+    return true;
+}
+
+typedef struct ReportDay {
+    char date[16];
+    GString *csv;
+    long rows;
+    bool ok;
+} ReportDay;
+
+typedef struct ReportRangeJob {
+    AppContext *ctx;
+    ReportDay *days;
+    int day_count;
+    bool combined;
+    gint next_day;
+} ReportRangeJob;
+
+typedef struct ReportRowSink {
+    ReportDay *day;
+    bool combined;
+} ReportRowSink;
+
+static bool report_parse_date(const char *text, GDate *date) {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    char extra = '\0';
+    if (text == NULL || sscanf(text, "%4d-%2d-%2d%c", &year, &month, &day, &extra) != 3) {
+        return false;
+    }
+    if (!g_date_valid_dmy((GDateDay)day, (GDateMonth)month, (GDateYear)year)) {
+        return false;
+    }
+    g_date_clear(date, 1);
+    g_date_set_dmy(date, (GDateDay)day, (GDateMonth)month, (GDateYear)year);
+    return true;
+}
+
+static bool report_append_row(const DailyReportRowView *row, void *user_data) {
+    ReportRowSink *sink = (ReportRowSink *)user_data;
+    if (sink->combined) {
+        g_string_append_printf(sink->day->csv, "%s,", sink->day->date);
+    }
+    g_string_append_printf(sink->day->csv, "%d,%s,%s,%.2f\n", row->order_id, row->table_name, row->waiter_name, row->total);
+    sink->day->rows = sink->day->rows + 1;
+    return true;
+}
+
+/* Cada hilo usa su propia conexión de solo lectura y toma días hasta agotar el rango. */
+static gpointer report_range_worker(gpointer data) {
+    ReportRangeJob *job = (ReportRangeJob *)data;
+    Database *db = NULL;
+    int index;
+    if (!database_open_readonly(&db, job->ctx->config.database_path, &job->ctx->config.storage, &job->ctx->logger)) {
+        return NULL;
+    }
+    database_set_metrics(db, &job->ctx->metrics);
+    index = g_atomic_int_add(&job->next_day, 1);
+    while (index < job->day_count) {
+        ReportRowSink sink;
+        sink.day = &job->days[index];
+        sink.combined = job->combined;
+        sink.day->ok = dao_visit_daily_report(db, sink.day->date, report_append_row, &sink);
+        index = g_atomic_int_add(&job->next_day, 1);
+    }
+    database_close(db);
+    return NULL;
+}
+
+static bool report_write_file(const char *path, const char *header, const GString *body) {
+    FILE *file = fopen(path, "w");
+    bool ok;
+    if (file == NULL) {
+        return false;
+    }
+    ok = fputs(header, file) >= 0 && fwrite(body->str, 1, body->len, file) == body->len;
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+static bool report_write_range(ReportRangeJob *job, const char *output_dir) {
+    char path[512];
+    int index = 0;
+    if (job->combined) {
+        GString *all = g_string_new(NULL);
+        bool ok;
+        while (index < job->day_count) {
+            g_string_append_len(all, job->days[index].csv->str, (gssize)job->days[index].csv->len);
+            index = index + 1;
+        }
+        snprintf(path, sizeof(path), "%s/ventas_%s_%s.csv", output_dir, job->days[0].date, job->days[job->day_count - 1].date);
+        ok = report_write_file(path, "date,order_id,table,waiter,total\n", all);
+        g_string_free(all, TRUE);
+        return ok;
+    }
+    while (index < job->day_count) {
+        snprintf(path, sizeof(path), "%s/ventas_%s.csv", output_dir, job->days[index].date);
+        if (!report_write_file(path, "order_id,table,waiter,total\n", job->days[index].csv)) {
+            return false;
+        }
+        index = index + 1;
+    }
+    return true;
+}
+
+bool report_service_export_range(AppContext *ctx, const char *from_date, const char *to_date, bool combined, const char *output_dir, ReportRangeStats *stats) {
+    ReportRangeJob job;
+    GDate from;
+    GDate to;
+    GThread **threads = NULL;
+    gint64 started = g_get_monotonic_time();
+    int worker_count;
+    int index = 0;
+    bool ok = true;
+    if (!report_parse_date(from_date, &from) || !report_parse_date(to_date, &to) || g_date_compare(&from, &to) > 0) {
+        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "report", "Rango de fechas inválido");
+        return false;
+    }
+    memset(&job, 0, sizeof(job));
+    job.ctx = ctx;
+    job.combined = combined;
+    job.day_count = g_date_days_between(&from, &to) + 1;
+    if (job.day_count > REPORT_RANGE_MAX_DAYS) {
+        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "report", "Rango de fechas demasiado largo");
+        return false;
+    }
+    job.days = g_new0(ReportDay, job.day_count);
+    while (index < job.day_count) {
+        snprintf(job.days[index].date, sizeof(job.days[index].date), "%04d-%02d-%02d", (int)g_date_get_year(&from), (int)g_date_get_month(&from), (int)g_date_get_day(&from));
+        job.days[index].csv = g_string_new(NULL);
+        g_date_add_days(&from, 1);
+        index = index + 1;
+    }
+    worker_count = MAX(ctx->config.storage.read_connections, (int)g_get_num_processors());
+    worker_count = MIN(worker_count, job.day_count);
+    threads = g_new0(GThread *, worker_count);
+    index = 0;
+    while (index < worker_count) {
+        threads[index] = g_thread_new("report", report_range_worker, &job);
+        index = index + 1;
+    }
+    index = 0;
+    while (index < worker_count) {
+        g_thread_join(threads[index]);
+        index = index + 1;
+    }
+    g_free(threads);
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(ReportRangeStats));
+        stats->days = job.day_count;
+        stats->workers = worker_count;
+    }
+    index = 0;
+    while (index < job.day_count) {
+        if (!job.days[index].ok) {
+            logger_log_fields(&ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudo leer el día", LOG_FIELDS(LOG_STR("date", job.days[index].date)));
+            ok = false;
+        }
+        if (stats != NULL) {
+            stats->rows = stats->rows + job.days[index].rows;
+        }
+        index = index + 1;
+    }
+    if (ok && !report_write_range(&job, output_dir)) {
+        logger_log(&ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudo escribir el reporte");
+        ok = false;
+    }
+    if (stats != NULL) {
+        stats->elapsed_s = (double)(g_get_monotonic_time() - started) / G_USEC_PER_SEC;
+    }
+    metrics_observe(&ctx->metrics, METRICS_OP_REPORT_RANGE, started);
+    index = 0;
+    while (index < job.day_count) {
+        g_string_free(job.days[index].csv, TRUE);
+        index = index + 1;
+    }
+    g_free(job.days);
+    if (ok) {
+        logger_log(&ctx->logger, LOG_LEVEL_INFO, "report", "Reporte por rango exportado");
+    }
+    return ok;
+}
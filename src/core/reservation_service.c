@@ -0,0 +1,362 @@
+#include "core/reservation_service.h"
+#include "util/interval_tree.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct BookTable {
+    int id;
+    int capacity;
+    unsigned long seen;
+    IntervalTree reservations;
+} BookTable;
+
+typedef struct BookEntry {
+    int table_id;
+    long long start;
+} BookEntry;
+
+typedef struct BookVersions {
+    int tables;
+    int reservations;
+} BookVersions;
+
+typedef struct BookLoad {
+    ReservationBook *book;
+    unsigned long pass;
+    int added;
+} BookLoad;
+
+static void reservation_book_table_free_func(gpointer data) {
+    BookTable *table = (BookTable *)data;
+    interval_tree_clear(&table->reservations);
+    g_free(table);
+}
+
+void reservation_book_init(ReservationBook *book, int seating_minutes) {
+    memset(book, 0, sizeof(ReservationBook));
+    g_mutex_init(&book->lock);
+    book->tables = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, reservation_book_table_free_func);
+    book->entries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    book->seating_minutes = seating_minutes > 0 ? seating_minutes : 120;
+    book->tables_version = -1;
+    book->reservations_version = -1;
+}
+
+void reservation_book_clear(ReservationBook *book) {
+    if (book == NULL || book->tables == NULL) {
+        return;
+    }
+    g_hash_table_destroy(book->tables);
+    g_hash_table_destroy(book->entries);
+    g_mutex_clear(&book->lock);
+    memset(book, 0, sizeof(ReservationBook));
+}
+
+static long long reservation_days_from_civil(int year, int month, int day) {
+    int shifted = month <= 2 ? year - 1 : year;
+    int era = (shifted >= 0 ? shifted : shifted - 399) / 400;
+    int year_of_era = shifted - era * 400;
+    int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return (long long)era * 146097 + day_of_era - 719468;
+}
+
+/*
+ * 'YYYY-MM-DD HH:MM' con segundos opcionales; mes, día y hora pueden venir con
+ * un dígito. No acepta fechas imposibles ni texto sobrante.
+ */
+static bool reservation_parse_fields(const char *text, int *year, int *month, int *day, int *hour, int *minute) {
+    int second = 0;
+    int consumed = 0;
+    int extra = 0;
+    size_t length = 0;
+    if (text == NULL) {
+        return false;
+    }
+    length = strlen(text);
+    if (strspn(text, "0123456789-: ") != length || strchr(text, ' ') != strrchr(text, ' ') || strspn(text, "0123456789") != 4) {
+        return false;
+    }
+    if (sscanf(text, "%4d-%2d-%2d %2d:%2d%n", year, month, day, hour, minute, &consumed) != 5) {
+        return false;
+    }
+    if (text[consumed] == ':') {
+        if (sscanf(text + consumed, ":%2d%n", &second, &extra) != 1 || extra != 3) {
+            return false;
+        }
+        consumed = consumed + extra;
+    }
+    if ((size_t)consumed != length || *hour < 0 || *hour > 23 || *minute < 0 || *minute > 59 || second < 0 || second > 59) {
+        return false;
+    }
+    return *month >= 1 && *month <= 12 && *day >= 1 && *day <= 31 && g_date_valid_dmy((GDateDay)*day, (GDateMonth)*month, (GDateYear)*year);
+}
+
+bool reservation_parse_minutes(const char *text, long long *minutes) {
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    if (!reservation_parse_fields(text, &year, &month, &day, &hour, &minute)) {
+        return false;
+    }
+    *minutes = reservation_days_from_civil(year, month, day) * 1440 + hour * 60 + minute;
+    return true;
+}
+
+static bool reservation_visit_version(const char *table_name, int version, void *user_data) {
+    BookVersions *versions = (BookVersions *)user_data;
+    if (strcmp(table_name, "tables") == 0) {
+        versions->tables = version;
+    } else if (strcmp(table_name, "reservations") == 0) {
+        versions->reservations = version;
+    }
+    return true;
+}
+
+static bool reservation_visit_table(const TableRowView *row, void *user_data) {
+    BookLoad *load = (BookLoad *)user_data;
+    BookTable *table = g_hash_table_lookup(load->book->tables, GINT_TO_POINTER(row->id));
+    if (table == NULL) {
+        table = g_new0(BookTable, 1);
+        table->id = row->id;
+        interval_tree_init(&table->reservations);
+        g_hash_table_insert(load->book->tables, GINT_TO_POINTER(row->id), table);
+        load->added = load->added + 1;
+    }
+    table->capacity = row->capacity;
+    table->seen = load->pass;
+    return true;
+}
+
+static gboolean reservation_table_unseen(gpointer key, gpointer value, gpointer user_data) {
+    (void)key;
+    return ((BookTable *)value)->seen != *(unsigned long *)user_data;
+}
+
+static void reservation_book_add(ReservationBook *book, int reservation_id, int table_id, long long start) {
+    BookTable *table = g_hash_table_lookup(book->tables, GINT_TO_POINTER(table_id));
+    BookEntry *entry = NULL;
+    if (table == NULL || !interval_tree_insert(&table->reservations, start, start + book->seating_minutes, reservation_id)) {
+        return;
+    }
+    entry = g_new(BookEntry, 1);
+    entry->table_id = table_id;
+    entry->start = start;
+    g_hash_table_replace(book->entries, GINT_TO_POINTER(reservation_id), entry);
+}
+
+static void reservation_book_remove(ReservationBook *book, int reservation_id) {
+    BookEntry *entry = g_hash_table_lookup(book->entries, GINT_TO_POINTER(reservation_id));
+    BookTable *table = NULL;
+    if (entry == NULL) {
+        return;
+    }
+    table = g_hash_table_lookup(book->tables, GINT_TO_POINTER(entry->table_id));
+    if (table != NULL) {
+        interval_tree_remove(&table->reservations, entry->start, reservation_id);
+    }
+    g_hash_table_remove(book->entries, GINT_TO_POINTER(reservation_id));
+}
+
+static bool reservation_visit_reservation(const ReservationView *row, void *user_data) {
+    ReservationBook *book = (ReservationBook *)user_data;
+    long long start = 0;
+    if (reservation_parse_minutes(row->reserved_at, &start)) {
+        reservation_book_add(book, row->id, row->table_id, start);
+    }
+    return true;
+}
+
+static void reservation_clear_table(gpointer key, gpointer value, gpointer user_data) {
+    (void)key;
+    (void)user_data;
+    interval_tree_clear(&((BookTable *)value)->reservations);
+}
+
+/* Las reservas que ya terminaron no pueden chocar con una nueva: se cargan desde hace una duración. */
+static bool reservation_book_reload(ReservationBook *book, Database *db) {
+    time_t since = time(NULL) - (time_t)book->seating_minutes * 60;
+    struct tm tm_since;
+    char from[32];
+#ifdef _WIN32
+    localtime_s(&tm_since, &since);
+#else
+    localtime_r(&since, &tm_since);
+#endif
+    strftime(from, sizeof(from), "%Y-%m-%d %H:%M", &tm_since);
+    g_hash_table_foreach(book->tables, reservation_clear_table, NULL);
+    g_hash_table_remove_all(book->entries);
+    book->reloads = book->reloads + 1;
+    return dao_visit_reservations_window(db, from, "9999-12-31", NULL, -1, reservation_visit_reservation, book);
+}
+
+static bool reservation_book_sync(ReservationBook *book, Database *db) {
+    BookVersions versions = {-1, -1};
+    if (!dao_visit_table_versions(db, reservation_visit_version, &versions)) {
+        return false;
+    }
+    /* El contador de mesas cambia con cada ocupación; solo se releen capacidades. */
+    if (versions.tables != book->tables_version) {
+        BookLoad load;
+        guint removed;
+        book->table_loads = book->table_loads + 1;
+        load.book = book;
+        load.pass = book->table_loads;
+        load.added = 0;
+        book->tables_version = -1;
+        if (!dao_visit_tables(db, reservation_visit_table, &load)) {
+            return false;
+        }
+        removed = g_hash_table_foreach_remove(book->tables, reservation_table_unseen, &load.pass);
+        book->tables_version = versions.tables;
+        /* Una mesa nueva o borrada cambia qué reservas entran en la agenda. */
+        if (load.added > 0 || removed > 0) {
+            book->reservations_version = -1;
+        }
+    }
+    if (versions.reservations != book->reservations_version) {
+        book->reservations_version = -1;
+        if (!reservation_book_reload(book, db)) {
+            return false;
+        }
+        book->reservations_version = versions.reservations;
+    }
+    return true;
+}
+
+static bool reservation_table_check(ReservationBook *book, int table_id, long long start, int minutes, bool *is_free, int *conflict_id) {
+    BookTable *table = g_hash_table_lookup(book->tables, GINT_TO_POINTER(table_id));
+    int conflict = 0;
+    if (table == NULL) {
+        return false;
+    }
+    *is_free = !interval_tree_find_overlap(&table->reservations, start, start + (minutes > 0 ? minutes : book->seating_minutes), &conflict);
+    if (conflict_id != NULL) {
+        *conflict_id = conflict;
+    }
+    return true;
+}
+
+bool reservation_book_table_free(ReservationBook *book, Database *db, int table_id, const char *when, int minutes, bool *is_free, int *conflict_id) {
+    long long start = 0;
+    bool ok = false;
+    if (!reservation_parse_minutes(when, &start)) {
+        return false;
+    }
+    g_mutex_lock(&book->lock);
+    ok = reservation_book_sync(book, db) && reservation_table_check(book, table_id, start, minutes, is_free, conflict_id);
+    g_mutex_unlock(&book->lock);
+    return ok;
+}
+
+static gint reservation_compare_tables(gconstpointer left, gconstpointer right) {
+    const BookTable *a = *(const BookTable *const *)left;
+    const BookTable *b = *(const BookTable *const *)right;
+    if (a->capacity != b->capacity) {
+        return a->capacity < b->capacity ? -1 : 1;
+    }
+    return a->id < b->id ? -1 : (a->id > b->id ? 1 : 0);
+}
+
+bool reservation_book_free_tables(ReservationBook *book, Database *db, const char *when, int minutes, int party_size, GArray *table_ids) {
+    GArray *candidates = NULL;
+    GHashTableIter iter;
+    gpointer value = NULL;
+    long long start = 0;
+    guint index = 0;
+    if (!reservation_parse_minutes(when, &start)) {
+        return false;
+    }
+    g_mutex_lock(&book->lock);
+    if (!reservation_book_sync(book, db)) {
+        g_mutex_unlock(&book->lock);
+        return false;
+    }
+    candidates = g_array_new(FALSE, FALSE, sizeof(BookTable *));
+    g_hash_table_iter_init(&iter, book->tables);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        BookTable *table = (BookTable *)value;
+        if (table->capacity >= party_size) {
+            g_array_append_val(candidates, table);
+        }
+    }
+    g_array_sort(candidates, reservation_compare_tables);
+    while (index < candidates->len) {
+        BookTable *table = g_array_index(candidates, BookTable *, index);
+        bool is_free = false;
+        if (reservation_table_check(book, table->id, start, minutes, &is_free, NULL) && is_free) {
+            g_array_append_val(table_ids, table->id);
+        }
+        index = index + 1;
+    }
+    g_mutex_unlock(&book->lock);
+    g_array_unref(candidates);
+    return true;
+}
+
+/*
+ * La verificación y el INSERT van en la misma transacción: si otra terminal
+ * reservó entre medio, la sincronización lo ve o el commit falla por
+ * SQLITE_BUSY, pero nunca quedan dos reservas superpuestas.
+ */
+bool reservation_book_create(ReservationBook *book, Database *db, int table_id, const char *name, const char *phone, const char *when, const char *notes,
+                             int *reservation_id, int *conflict_id) {
+    long long start = 0;
+    bool is_free = false;
+    int created = 0;
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    char reserved_at[20];
+    gint64 started_us = g_get_monotonic_time();
+    *conflict_id = 0;
+    if (!reservation_parse_fields(when, &year, &month, &day, &hour, &minute)) {
+        return false;
+    }
+    /* reserved_at se compara como texto (ventana, cursor, ORDER BY): siempre con ancho fijo. */
+    snprintf(reserved_at, sizeof(reserved_at), "%04d-%02d-%02d %02d:%02d", year, month, day, hour, minute);
+    start = reservation_days_from_civil(year, month, day) * 1440 + hour * 60 + minute;
+    g_mutex_lock(&book->lock);
+    if (!database_begin(db)) {
+        g_mutex_unlock(&book->lock);
+        return false;
+    }
+    if (!reservation_book_sync(book, db) || !reservation_table_check(book, table_id, start, 0, &is_free, conflict_id) || !is_free ||
+        !dao_create_reservation(db, table_id, name, phone, reserved_at, notes, &created) || !database_commit(db)) {
+        database_rollback(db);
+        g_mutex_unlock(&book->lock);
+        metrics_observe(db->metrics, METRICS_OP_RESERVATION_CREATE, started_us);
+        return false;
+    }
+    /* El trigger sumó uno al contador: la agenda sigue al día sin recargar. */
+    reservation_book_add(book, created, table_id, start);
+    book->reservations_version = book->reservations_version + 1;
+    g_mutex_unlock(&book->lock);
+    metrics_observe(db->metrics, METRICS_OP_RESERVATION_CREATE, started_us);
+    if (reservation_id != NULL) {
+        *reservation_id = created;
+    }
+    return true;
+}
+
+bool reservation_book_cancel(ReservationBook *book, Database *db, int reservation_id) {
+    g_mutex_lock(&book->lock);
+    if (!database_begin(db)) {
+        g_mutex_unlock(&book->lock);
+        return false;
+    }
+    if (!reservation_book_sync(book, db) || !dao_cancel_reservation(db, reservation_id) || !database_commit(db)) {
+        database_rollback(db);
+        g_mutex_unlock(&book->lock);
+        return false;
+    }
+    reservation_book_remove(book, reservation_id);
+    book->reservations_version = book->reservations_version + 1;
+    g_mutex_unlock(&book->lock);
+    return true;
+}
@@ -0,0 +1,148 @@
+#include "core/status_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+static OrderItemStatusChange *status_queue_find(StatusQueueBatch *batch, int order_item_id) {
+    int index = 0;
+    while (index < batch->count) {
+        if (batch->entries[index].order_item_id == order_item_id) {
+            return &batch->entries[index];
+        }
+        index = index + 1;
+    }
+    return NULL;
+}
+
+static bool status_queue_append(StatusQueueBatch *batch, int order_item_id, const char *status) {
+    OrderItemStatusChange *entry = NULL;
+    if (batch->count == batch->capacity) {
+        int new_capacity = batch->capacity == 0 ? 32 : batch->capacity * 2;
+        OrderItemStatusChange *new_entries = realloc(batch->entries, sizeof(OrderItemStatusChange) * new_capacity);
+        if (new_entries == NULL) {
+            return false;
+        }
+        batch->entries = new_entries;
+        batch->capacity = new_capacity;
+    }
+    entry = &batch->entries[batch->count];
+    entry->order_item_id = order_item_id;
+    strncpy(entry->status, status, sizeof(entry->status) - 1);
+    entry->status[sizeof(entry->status) - 1] = '\0';
+    batch->count = batch->count + 1;
+    return true;
+}
+
+void status_queue_init(StatusQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    memset(queue, 0, sizeof(StatusQueue));
+    g_mutex_init(&queue->lock);
+}
+
+int status_queue_put(StatusQueue *queue, int order_item_id, const char *status, gint64 now_us) {
+    OrderItemStatusChange *entry = NULL;
+    int count;
+    g_mutex_lock(&queue->lock);
+    entry = status_queue_find(&queue->pending, order_item_id);
+    if (entry != NULL) {
+        strncpy(entry->status, status, sizeof(entry->status) - 1);
+        entry->status[sizeof(entry->status) - 1] = '\0';
+    } else if (status_queue_append(&queue->pending, order_item_id, status) && queue->pending.count == 1) {
+        queue->pending.oldest_us = now_us;
+    }
+    count = queue->pending.count;
+    g_mutex_unlock(&queue->lock);
+    return count;
+}
+
+void status_queue_discard(StatusQueue *queue, int order_item_id) {
+    OrderItemStatusChange *entry = NULL;
+    g_mutex_lock(&queue->lock);
+    entry = status_queue_find(&queue->pending, order_item_id);
+    if (entry != NULL) {
+        *entry = queue->pending.entries[queue->pending.count - 1];
+        queue->pending.count = queue->pending.count - 1;
+    }
+    g_mutex_unlock(&queue->lock);
+}
+
+int status_queue_take(StatusQueue *queue, const OrderItemStatusChange **entries) {
+    StatusQueueBatch swap;
+    int count;
+    g_mutex_lock(&queue->lock);
+    if (queue->in_flight.count > 0) {
+        g_mutex_unlock(&queue->lock);
+        *entries = NULL;
+        return 0;
+    }
+    swap = queue->in_flight;
+    queue->in_flight = queue->pending;
+    queue->pending = swap;
+    queue->pending.count = 0;
+    count = queue->in_flight.count;
+    *entries = queue->in_flight.entries;
+    g_mutex_unlock(&queue->lock);
+    return count;
+}
+
+void status_queue_finish(StatusQueue *queue, bool committed) {
+    int index = 0;
+    g_mutex_lock(&queue->lock);
+    /* Si el lote falló vuelve a la cola, salvo los ítems que ya tienen un estado más nuevo. */
+    while (!committed && index < queue->in_flight.count) {
+        OrderItemStatusChange *entry = &queue->in_flight.entries[index];
+        if (status_queue_find(&queue->pending, entry->order_item_id) == NULL) {
+            status_queue_append(&queue->pending, entry->order_item_id, entry->status);
+        }
+        index = index + 1;
+    }
+    if (!committed && queue->in_flight.count > 0) {
+        queue->pending.oldest_us = queue->in_flight.oldest_us;
+    }
+    queue->in_flight.count = 0;
+    g_mutex_unlock(&queue->lock);
+}
+
+bool status_queue_lookup(StatusQueue *queue, int order_item_id, char *status, size_t status_len) {
+    OrderItemStatusChange *entry = NULL;
+    bool found = false;
+    g_mutex_lock(&queue->lock);
+    entry = status_queue_find(&queue->pending, order_item_id);
+    if (entry == NULL) {
+        entry = status_queue_find(&queue->in_flight, order_item_id);
+    }
+    if (entry != NULL && status != NULL && status_len > 0) {
+        strncpy(status, entry->status, status_len - 1);
+        status[status_len - 1] = '\0';
+        found = true;
+    }
+    g_mutex_unlock(&queue->lock);
+    return found;
+}
+
+int status_queue_count(StatusQueue *queue) {
+    int count;
+    g_mutex_lock(&queue->lock);
+    count = queue->pending.count;
+    g_mutex_unlock(&queue->lock);
+    return count;
+}
+
+gint64 status_queue_oldest(StatusQueue *queue) {
+    gint64 oldest;
+    g_mutex_lock(&queue->lock);
+    oldest = queue->pending.count > 0 ? queue->pending.oldest_us : 0;
+    g_mutex_unlock(&queue->lock);
+    return oldest;
+}
+
+void status_queue_clear(StatusQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    free(queue->pending.entries);
+    free(queue->in_flight.entries);
+    g_mutex_clear(&queue->lock);
+    memset(queue, 0, sizeof(StatusQueue));
+}
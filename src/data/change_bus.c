@@ -0,0 +1,178 @@
+#include "data/change_bus.h"
+#include <string.h>
+
+static const char *const CHANGE_TABLE_NAMES[CHANGE_TABLE_COUNT] = {"orders", "order_items", "tables", "menu_items", "reservations", "users"};
+
+typedef struct ChangeBatch {
+    ChangeBus *bus;
+    GArray *events;
+} ChangeBatch;
+
+static bool change_bus_table_from_name(const char *name, ChangeTable *table) {
+    int index = 0;
+    while (index < CHANGE_TABLE_COUNT) {
+        if (strcmp(name, CHANGE_TABLE_NAMES[index]) == 0) {
+            *table = (ChangeTable)index;
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+static bool change_bus_contains(GArray *events, ChangeTable table, ChangeOp op, sqlite3_int64 rowid) {
+    guint index = 0;
+    while (index < events->len) {
+        ChangeEvent *event = &g_array_index(events, ChangeEvent, index);
+        if (event->table == table && event->rowid == rowid && (event->op == op || rowid == 0)) {
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+/* Corre en el hilo escritor, dentro de la sentencia: solo acumula. */
+static void change_bus_on_update(void *user_data, int op, const char *database_name, const char *table_name, sqlite3_int64 rowid) {
+    ChangeBus *bus = (ChangeBus *)user_data;
+    ChangeEvent event;
+    (void)database_name;
+    if (!change_bus_table_from_name(table_name, &event.table)) {
+        return;
+    }
+    event.op = op == SQLITE_INSERT ? CHANGE_OP_INSERT : (op == SQLITE_DELETE ? CHANGE_OP_DELETE : CHANGE_OP_UPDATE);
+    event.rowid = rowid;
+    if (bus->pending->len >= CHANGE_BUS_MAX_EVENTS) {
+        event.op = CHANGE_OP_UPDATE;
+        event.rowid = 0;
+    }
+    if (!change_bus_contains(bus->pending, event.table, event.op, event.rowid)) {
+        g_array_append_val(bus->pending, event);
+    }
+}
+
+static void change_bus_batch_free(ChangeBatch *batch) {
+    g_array_unref(batch->events);
+    g_free(batch);
+}
+
+static gboolean change_bus_dispatch(gpointer data) {
+    ChangeBatch *batch = (ChangeBatch *)data;
+    ChangeBus *bus = batch->bus;
+    guint index = 0;
+    if (!g_atomic_int_get(&bus->detached)) {
+        /* Se copia la lista: un suscriptor puede desuscribirse durante la entrega. */
+        GArray *subscribers = g_array_copy(bus->subscribers);
+        while (index < subscribers->len) {
+            ChangeSubscriber *subscriber = &g_array_index(subscribers, ChangeSubscriber, index);
+            subscriber->listener((const ChangeEvent *)(void *)batch->events->data, (int)batch->events->len, subscriber->user_data);
+            index = index + 1;
+        }
+        g_array_unref(subscribers);
+    }
+    change_bus_batch_free(batch);
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * El hook corre antes de que el commit sea visible para otras conexiones: si
+ * se entregara acá, un lector podría releer la fila vieja. Solo pasa el lote a
+ * committed; change_bus_after_commit lo entrega cuando el commit ya volvió. Si
+ * el commit fallara después de este punto, los suscriptores releen filas que
+ * no cambiaron, lo cual es inofensivo.
+ */
+static int change_bus_on_commit(void *user_data) {
+    ChangeBus *bus = (ChangeBus *)user_data;
+    guint index = 0;
+    while (index < bus->pending->len) {
+        ChangeEvent *event = &g_array_index(bus->pending, ChangeEvent, index);
+        if (!change_bus_contains(bus->committed, event->table, event->op, event->rowid)) {
+            g_array_append_val(bus->committed, *event);
+        }
+        index = index + 1;
+    }
+    g_array_set_size(bus->pending, 0);
+    return 0;
+}
+
+/* database_release la llama en el hilo escritor cuando no queda transacción abierta. */
+static void change_bus_after_commit(void *user_data) {
+    ChangeBus *bus = (ChangeBus *)user_data;
+    ChangeBatch *batch = NULL;
+    if (bus->committed->len == 0) {
+        return;
+    }
+    batch = g_new0(ChangeBatch, 1);
+    batch->bus = bus;
+    batch->events = bus->committed;
+    bus->committed = g_array_new(FALSE, FALSE, sizeof(ChangeEvent));
+    g_main_context_invoke_full(bus->main_context, G_PRIORITY_DEFAULT, change_bus_dispatch, batch, NULL);
+}
+
+static void change_bus_on_rollback(void *user_data) {
+    ChangeBus *bus = (ChangeBus *)user_data;
+    g_array_set_size(bus->pending, 0);
+}
+
+void change_bus_init(ChangeBus *bus) {
+    if (bus == NULL) {
+        return;
+    }
+    memset(bus, 0, sizeof(ChangeBus));
+    bus->main_context = g_main_context_ref_thread_default();
+    bus->pending = g_array_new(FALSE, FALSE, sizeof(ChangeEvent));
+    bus->committed = g_array_new(FALSE, FALSE, sizeof(ChangeEvent));
+    bus->subscribers = g_array_new(FALSE, FALSE, sizeof(ChangeSubscriber));
+    bus->next_id = 1;
+}
+
+void change_bus_attach(ChangeBus *bus, Database *db) {
+    sqlite3_update_hook(db->handle, change_bus_on_update, bus);
+    sqlite3_commit_hook(db->handle, change_bus_on_commit, bus);
+    sqlite3_rollback_hook(db->handle, change_bus_on_rollback, bus);
+    database_set_after_commit(db, change_bus_after_commit, bus);
+}
+
+void change_bus_detach(ChangeBus *bus, Database *db) {
+    g_atomic_int_set(&bus->detached, 1);
+    sqlite3_update_hook(db->handle, NULL, NULL);
+    sqlite3_commit_hook(db->handle, NULL, NULL);
+    sqlite3_rollback_hook(db->handle, NULL, NULL);
+    database_set_after_commit(db, NULL, NULL);
+}
+
+guint change_bus_subscribe(ChangeBus *bus, ChangeListener listener, gpointer user_data) {
+    ChangeSubscriber subscriber;
+    subscriber.id = bus->next_id;
+    subscriber.listener = listener;
+    subscriber.user_data = user_data;
+    bus->next_id = bus->next_id + 1;
+    g_array_append_val(bus->subscribers, subscriber);
+    return subscriber.id;
+}
+
+void change_bus_unsubscribe(ChangeBus *bus, guint id) {
+    guint index = 0;
+    while (index < bus->subscribers->len) {
+        if (g_array_index(bus->subscribers, ChangeSubscriber, index).id == id) {
+            g_array_remove_index(bus->subscribers, index);
+            return;
+        }
+        index = index + 1;
+    }
+}
+
+void change_bus_clear(ChangeBus *bus) {
+    if (bus == NULL || bus->main_context == NULL) {
+        return;
+    }
+    g_atomic_int_set(&bus->detached, 1);
+    /* Los lotes ya encolados solo liberan memoria porque el bus está desacoplado. */
+    while (g_main_context_iteration(bus->main_context, FALSE)) {
+    }
+    g_array_unref(bus->pending);
+    g_array_unref(bus->committed);
+    g_array_unref(bus->subscribers);
+    g_main_context_unref(bus->main_context);
+    memset(bus, 0, sizeof(ChangeBus));
+}
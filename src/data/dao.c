@@ -1,17 +1,51 @@
 #include "data/dao.h"
+#include "data/dao_sql.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-bool dao_get_user_by_username(sqlite3 *db, const char *username, User *user) {
-    const char *sql = "SELECT id, username, role, password_hash FROM users WHERE username = ?";
+static const char *dao_column_text(sqlite3_stmt *stmt, int column) {
+    const char *text = (const char *)sqlite3_column_text(stmt, column);
+    return text == NULL ? "" : text;
+}
+
+static void dao_copy_text(char *dest, size_t dest_len, const char *src) {
+    strncpy(dest, src, dest_len - 1);
+    dest[dest_len - 1] = '\0';
+}
+
+static bool dao_grow(void **rows, int *capacity, int count, size_t item_size) {
+    int new_capacity;
+    void *new_rows;
+    if (count < *capacity) {
+        return true;
+    }
+    new_capacity = *capacity == 0 ? 8 : *capacity * 2;
+    new_rows = realloc(*rows, item_size * new_capacity);
+    if (new_rows == NULL) {
+        return false;
+    }
+    *rows = new_rows;
+    *capacity = new_capacity;
+    return true;
+}
+
+/* Latencia de las llamadas compuestas; cada sentencia ya se mide en database_prepare/release. */
+static void dao_observe(Database *db, MetricsOp op, gint64 started_us) {
+    if (db != NULL) {
+        metrics_observe(db->metrics, op, started_us);
+    }
+}
+
+bool dao_get_user_by_username(Database *db, const char *username, User *user) {
+    const char *sql = DAO_SQL_USER_BY_USERNAME;
     sqlite3_stmt *stmt = NULL;
     int rc;
     if (user == NULL) {
         return false;
     }
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
         return false;
     }
     sqlite3_bind_text(stmt, 1, username, -1, SQLITE_TRANSIENT);
@@ -24,95 +58,333 @@ bool dao_get_user_by_username(sqlite3 *db, const char *username, User *user) {
         user->role[sizeof(user->role) - 1] = '\0';
         strncpy(user->password_hash, (const char *)sqlite3_column_text(stmt, 3), sizeof(user->password_hash) - 1);
         user->password_hash[sizeof(user->password_hash) - 1] = '\0';
-        sqlite3_finalize(stmt);
+        database_release(db, stmt);
         return true;
     }
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     return false;
 }
 
-bool dao_create_order(sqlite3 *db, int table_id, int user_id, int *order_id) {
-    const char *sql_insert = "INSERT INTO orders(table_id, waiter_id, status, created_at) VALUES(?, ?, 'abierta', CURRENT_TIMESTAMP)";
-    const char *sql_update = "UPDATE tables SET status='ocupada', waiter_id = ? WHERE id = ?";
+static bool dao_create_order_run(Database *db, int table_id, int user_id, int *order_id) {
+    const char *sql_insert = DAO_SQL_ORDER_INSERT;
+    const char *sql_update = DAO_SQL_TABLE_OCCUPY;
     sqlite3_stmt *stmt = NULL;
     int rc;
-    if (sqlite3_exec(db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+    if (!database_begin(db)) {
         return false;
     }
-    rc = sqlite3_prepare_v2(db, sql_insert, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+    stmt = database_prepare(db, sql_insert);
+    if (stmt == NULL) {
+        database_rollback(db);
         return false;
     }
     sqlite3_bind_int(stmt, 1, table_id);
     sqlite3_bind_int(stmt, 2, user_id);
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     if (rc != SQLITE_DONE) {
-        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+        database_rollback(db);
         return false;
     }
     if (order_id != NULL) {
-        *order_id = (int)sqlite3_last_insert_rowid(db);
+        *order_id = (int)sqlite3_last_insert_rowid(db->handle);
     }
-    rc = sqlite3_prepare_v2(db, sql_update, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+    stmt = database_prepare(db, sql_update);
+    if (stmt == NULL) {
+        database_rollback(db);
         return false;
     }
     sqlite3_bind_int(stmt, 1, user_id);
     sqlite3_bind_int(stmt, 2, table_id);
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     if (rc != SQLITE_DONE) {
-        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+        database_rollback(db);
         return false;
     }
-    if (sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
-        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+    if (!database_commit(db)) {
+        database_rollback(db);
         return false;
     }
     return true;
 }
 
-bool dao_add_item_to_order(sqlite3 *db, int order_id, int menu_item_id, const char *notes) {
-    const char *sql = "INSERT INTO order_items(order_id, menu_item_id, status, notes) VALUES(?, ?, 'pedido', ?)";
+bool dao_create_order(Database *db, int table_id, int user_id, int *order_id) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_create_order_run(db, table_id, user_id, order_id);
+    dao_observe(db, METRICS_OP_DAO_CREATE_ORDER, started_us);
+    return ok;
+}
+
+bool dao_add_item_to_order(Database *db, int order_id, int menu_item_id, const char *notes) {
+    const char *sql = DAO_SQL_ORDER_ITEM_INSERT;
     sqlite3_stmt *stmt = NULL;
+    gint64 started_us = g_get_monotonic_time();
     int rc;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, order_id);
+    sqlite3_bind_text(stmt, 2, notes == NULL ? "" : notes, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 3, menu_item_id);
+    rc = sqlite3_step(stmt);
+    database_release(db, stmt);
+    dao_observe(db, METRICS_OP_DAO_ADD_ITEM, started_us);
+    return rc == SQLITE_DONE && sqlite3_changes(db->handle) == 1;
+}
+
+/* Cada unidad es una fila propia para que cocina pueda seguir su estado por separado. */
+static bool dao_add_items_to_order_run(Database *db, int order_id, const OrderItemRequest *items, int count) {
+    const char *sql = DAO_SQL_ORDER_ITEM_INSERT;
+    sqlite3_stmt *stmt = NULL;
+    int index = 0;
+    int unit;
+    int rc = SQLITE_DONE;
+    if (items == NULL || count <= 0) {
+        return false;
+    }
+    if (!database_begin(db)) {
+        return false;
+    }
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
+        database_rollback(db);
         return false;
     }
     sqlite3_bind_int(stmt, 1, order_id);
-    sqlite3_bind_int(stmt, 2, menu_item_id);
-    sqlite3_bind_text(stmt, 3, notes == NULL ? "" : notes, -1, SQLITE_TRANSIENT);
+    while (index < count && rc == SQLITE_DONE) {
+        if (items[index].quantity <= 0) {
+            rc = SQLITE_MISUSE;
+            break;
+        }
+        sqlite3_bind_text(stmt, 2, items[index].notes == NULL ? "" : items[index].notes, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, items[index].menu_item_id);
+        unit = 0;
+        while (unit < items[index].quantity && rc == SQLITE_DONE) {
+            rc = sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (rc == SQLITE_DONE && sqlite3_changes(db->handle) != 1) {
+                rc = SQLITE_NOTFOUND;
+            }
+            unit = unit + 1;
+        }
+        index = index + 1;
+    }
+    database_release(db, stmt);
+    if (rc != SQLITE_DONE) {
+        database_rollback(db);
+        return false;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    return true;
+}
+
+bool dao_add_items_to_order(Database *db, int order_id, const OrderItemRequest *items, int count) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_add_items_to_order_run(db, order_id, items, count);
+    dao_observe(db, METRICS_OP_DAO_ADD_ITEMS, started_us);
+    return ok;
+}
+
+static bool dao_step_with_id(Database *db, const char *sql, int id, int *changes) {
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    if (id > 0) {
+        sqlite3_bind_int(stmt, 1, id);
+    }
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
+    if (changes != NULL) {
+        *changes = sqlite3_changes(db->handle);
+    }
     return rc == SQLITE_DONE;
 }
 
-bool dao_update_order_item_status(sqlite3 *db, int order_item_id, const char *status) {
-    const char *sql = "UPDATE order_items SET status = ? WHERE id = ?";
+/* El cierre y la suma a los acumulados diarios van en la misma transacción. */
+static bool dao_close_order_run(Database *db, int order_id) {
+    static const char *const rollups[] = {
+        DAO_SQL_ROLLUP_DAILY_ADD,
+        DAO_SQL_ROLLUP_WAITER_ADD,
+        DAO_SQL_ROLLUP_TABLE_ADD,
+        DAO_SQL_ROLLUP_ITEM_ADD
+    };
+    int changes = 0;
+    int index = 0;
+    if (!database_begin(db)) {
+        return false;
+    }
+    if (!dao_step_with_id(db, DAO_SQL_ORDER_CLOSE, order_id, &changes) || changes != 1) {
+        database_rollback(db);
+        return false;
+    }
+    if (!dao_step_with_id(db, DAO_SQL_TABLE_RELEASE, order_id, NULL)) {
+        database_rollback(db);
+        return false;
+    }
+    while (index < (int)(sizeof(rollups) / sizeof(rollups[0]))) {
+        if (!dao_step_with_id(db, rollups[index], order_id, NULL)) {
+            database_rollback(db);
+            return false;
+        }
+        index = index + 1;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    return true;
+}
+
+bool dao_close_order(Database *db, int order_id) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_close_order_run(db, order_id);
+    dao_observe(db, METRICS_OP_DAO_CLOSE_ORDER, started_us);
+    return ok;
+}
+
+static bool dao_rebuild_rollups_run(Database *db) {
+    static const char *const statements[] = {
+        DAO_SQL_ROLLUP_DAILY_CLEAR,
+        DAO_SQL_ROLLUP_WAITER_CLEAR,
+        DAO_SQL_ROLLUP_TABLE_CLEAR,
+        DAO_SQL_ROLLUP_ITEM_CLEAR,
+        DAO_SQL_ROLLUP_DAILY_REBUILD,
+        DAO_SQL_ROLLUP_WAITER_REBUILD,
+        DAO_SQL_ROLLUP_TABLE_REBUILD,
+        DAO_SQL_ROLLUP_ITEM_REBUILD
+    };
+    int index = 0;
+    if (!database_begin(db)) {
+        return false;
+    }
+    while (index < (int)(sizeof(statements) / sizeof(statements[0]))) {
+        if (!dao_step_with_id(db, statements[index], 0, NULL)) {
+            database_rollback(db);
+            return false;
+        }
+        index = index + 1;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    return true;
+}
+
+bool dao_rebuild_rollups(Database *db) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_rebuild_rollups_run(db);
+    dao_observe(db, METRICS_OP_DAO_REBUILD_ROLLUPS, started_us);
+    return ok;
+}
+
+bool dao_sum_daily_sales(Database *db, const char *from_date, const char *to_date, SalesTotals *totals) {
+    const char *sql = DAO_SQL_SALES_RANGE_TOTAL;
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+    if (totals == NULL) {
+        return false;
+    }
+    memset(totals, 0, sizeof(SalesTotals));
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, from_date, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, to_date, -1, SQLITE_TRANSIENT);
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        totals->revenue = sqlite3_column_double(stmt, 0);
+        totals->cost = sqlite3_column_double(stmt, 1);
+        totals->item_count = sqlite3_column_int(stmt, 2);
+        totals->order_count = sqlite3_column_int(stmt, 3);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_ROW;
+}
+
+bool dao_update_order_item_status(Database *db, int order_item_id, const char *status) {
+    const char *sql = DAO_SQL_ORDER_ITEM_SET_STATUS;
     sqlite3_stmt *stmt = NULL;
+    gint64 started_us = g_get_monotonic_time();
     int rc;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
         return false;
     }
     sqlite3_bind_text(stmt, 1, status, -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 2, order_item_id);
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
+    dao_observe(db, METRICS_OP_DAO_UPDATE_STATUS, started_us);
     return rc == SQLITE_DONE;
 }
 
-bool dao_calculate_order_totals(sqlite3 *db, int order_id, double tax_rate, double tip_rate, double discount, double *subtotal, double *tax, double *total) {
-    const char *sql = "SELECT SUM(m.price) FROM order_items oi JOIN menu_items m ON m.id = oi.menu_item_id WHERE oi.order_id = ?";
+static bool dao_update_order_item_statuses_run(Database *db, const OrderItemStatusChange *changes, int count, int *applied) {
+    const char *sql = DAO_SQL_ORDER_ITEM_SET_STATUS;
+    sqlite3_stmt *stmt = NULL;
+    int index = 0;
+    int rc = SQLITE_DONE;
+    int updated = 0;
+    if (changes == NULL || count <= 0) {
+        return false;
+    }
+    if (!database_begin(db)) {
+        return false;
+    }
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
+        database_rollback(db);
+        return false;
+    }
+    while (index < count && rc == SQLITE_DONE) {
+        sqlite3_bind_text(stmt, 1, changes[index].status, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, changes[index].order_item_id);
+        rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        /* Un ítem borrado mientras esperaba en la cola no invalida el resto del lote. */
+        if (rc == SQLITE_DONE) {
+            updated = updated + sqlite3_changes(db->handle);
+        }
+        index = index + 1;
+    }
+    database_release(db, stmt);
+    if (rc != SQLITE_DONE) {
+        database_rollback(db);
+        return false;
+    }
+    if (!database_commit(db)) {
+        database_rollback(db);
+        return false;
+    }
+    if (applied != NULL) {
+        *applied = updated;
+    }
+    return true;
+}
+
+bool dao_update_order_item_statuses(Database *db, const OrderItemStatusChange *changes, int count, int *applied) {
+    gint64 started_us = g_get_monotonic_time();
+    bool ok = dao_update_order_item_statuses_run(db, changes, count, applied);
+    dao_observe(db, METRICS_OP_DAO_UPDATE_STATUSES, started_us);
+    return ok;
+}
+
+bool dao_calculate_order_totals(Database *db, int order_id, double tax_rate, double tip_rate, double discount, double *subtotal, double *tax, double *total) {
+    const char *sql = DAO_SQL_ORDER_SUBTOTAL;
     sqlite3_stmt *stmt = NULL;
+    gint64 started_us = g_get_monotonic_time();
     int rc;
     double sum = 0.0;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    stmt = database_prepare(db, sql);
+    if (stmt == NULL) {
         return false;
     }
     sqlite3_bind_int(stmt, 1, order_id);
@@ -120,7 +392,7 @@ bool dao_calculate_order_totals(sqlite3 *db, int order_id, double tax_rate, doub
     if (rc == SQLITE_ROW) {
         sum = sqlite3_column_double(stmt, 0);
     }
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
     if (subtotal != NULL) {
         *subtotal = sum;
     }
@@ -132,201 +404,503 @@ bool dao_calculate_order_totals(sqlite3 *db, int order_id, double tax_rate, doub
         double tax_value = sum * tax_rate;
         *total = sum - discount + tip_value + tax_value;
     }
+    dao_observe(db, METRICS_OP_DAO_ORDER_TOTALS, started_us);
     return true;
 }
 
-bool dao_export_daily_report(sqlite3 *db, const char *date_str, const char *path) {
-    const char *sql = "SELECT o.id, t.name, u.username, SUM(m.price) FROM orders o JOIN tables t ON o.table_id = t.id JOIN users u ON o.waiter_id = u.id JOIN order_items oi ON oi.order_id = o.id JOIN menu_items m ON m.id = oi.menu_item_id WHERE DATE(o.created_at) = ? GROUP BY o.id, t.name, u.username";
-    sqlite3_stmt *stmt = NULL;
-    FILE *file = NULL;
+bool dao_visit_daily_report(Database *db, const char *date_str, DaoDailyReportVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_DAILY_REPORT;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
     int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, date_str, -1, SQLITE_TRANSIENT);
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        DailyReportRowView row;
+        row.order_id = sqlite3_column_int(stmt, 0);
+        row.table_name = dao_column_text(stmt, 1);
+        row.waiter_name = dao_column_text(stmt, 2);
+        row.total = sqlite3_column_double(stmt, 3);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+static bool dao_write_report_row(const DailyReportRowView *row, void *user_data) {
+    fprintf((FILE *)user_data, "%d,%s,%s,%.2f\n", row->order_id, row->table_name, row->waiter_name, row->total);
+    return true;
+}
+
+bool dao_export_daily_report(Database *db, const char *date_str, const char *path) {
+    FILE *file = NULL;
+    gint64 started_us = g_get_monotonic_time();
+    bool ok;
     file = fopen(path, "w");
     if (file == NULL) {
         return false;
     }
     fprintf(file, "order_id,table,waiter,total\n");
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fclose(file);
+    ok = dao_visit_daily_report(db, date_str, dao_write_report_row, file);
+    fclose(file);
+    dao_observe(db, METRICS_OP_DAO_EXPORT_DAILY_REPORT, started_us);
+    return ok;
+}
+
+bool dao_visit_tables(Database *db, DaoTableVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_TABLES_LIST;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
         return false;
     }
-    sqlite3_bind_text(stmt, 1, date_str, -1, SQLITE_TRANSIENT);
     rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        int order_id = sqlite3_column_int(stmt, 0);
-        const char *table_name = (const char *)sqlite3_column_text(stmt, 1);
-        const char *waiter_name = (const char *)sqlite3_column_text(stmt, 2);
-        double total = sqlite3_column_double(stmt, 3);
-        fprintf(file, "%d,%s,%s,%.2f\n", order_id, table_name, waiter_name, total);
+        TableRowView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.name = dao_column_text(stmt, 1);
+        row.status = dao_column_text(stmt, 2);
+        row.waiter_id = sqlite3_column_int(stmt, 3);
+        row.capacity = sqlite3_column_int(stmt, 4);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    fclose(file);
-    return true;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
 }
 
-bool dao_list_tables(sqlite3 *db, TableStatus **tables, int *count) {
-    const char *sql = "SELECT id, name, status, IFNULL(waiter_id, 0) FROM tables ORDER BY id";
-    sqlite3_stmt *stmt = NULL;
+bool dao_visit_users(Database *db, DaoUserVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_USERS_LIST;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
     int rc;
-    int capacity = 0;
-    int local_count = 0;
-    TableStatus *local_tables = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    if (stmt == NULL) {
         return false;
     }
     rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        if (local_count == capacity) {
-            int new_capacity = capacity == 0 ? 8 : capacity * 2;
-            TableStatus *new_tables = realloc(local_tables, sizeof(TableStatus) * new_capacity);
-            if (new_tables == NULL) {
-                sqlite3_finalize(stmt);
-                free(local_tables);
-                return false;
-            }
-            local_tables = new_tables;
-            capacity = new_capacity;
+        UserView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.username = dao_column_text(stmt, 1);
+        row.role = dao_column_text(stmt, 2);
+        row.password_hash = dao_column_text(stmt, 3);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
         }
-        local_tables[local_count].id = sqlite3_column_int(stmt, 0);
-        strncpy(local_tables[local_count].name, (const char *)sqlite3_column_text(stmt, 1), sizeof(local_tables[local_count].name) - 1);
-        local_tables[local_count].name[sizeof(local_tables[local_count].name) - 1] = '\0';
-        strncpy(local_tables[local_count].status, (const char *)sqlite3_column_text(stmt, 2), sizeof(local_tables[local_count].status) - 1);
-        local_tables[local_count].status[sizeof(local_tables[local_count].status) - 1] = '\0';
-        local_tables[local_count].waiter_id = sqlite3_column_int(stmt, 3);
-        local_count = local_count + 1;
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    *tables = local_tables;
-    if (count != NULL) {
-        *count = local_count;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool dao_visit_table_versions(Database *db, DaoTableVersionVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_TABLE_VERSIONS;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
     }
-    return true;
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        if (!visitor(dao_column_text(stmt, 0), sqlite3_column_int(stmt, 1), user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
 }
 
-bool dao_list_menu_items(sqlite3 *db, MenuItem **items, int *count) {
-    const char *sql = "SELECT id, name, category, price, cost, stock, IFNULL(photo, '') FROM menu_items ORDER BY category, name";
-    sqlite3_stmt *stmt = NULL;
+bool dao_get_data_version(Database *db, int *data_version) {
+    const char *sql = DAO_SQL_DATA_VERSION;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
     int rc;
-    int capacity = 0;
-    int local_count = 0;
-    MenuItem *local_items = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    if (stmt == NULL) {
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *data_version = sqlite3_column_int(stmt, 0);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_ROW;
+}
+
+bool dao_visit_menu_items(Database *db, DaoMenuItemVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_MENU_ITEMS_LIST;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
         return false;
     }
     rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        if (local_count == capacity) {
-            int new_capacity = capacity == 0 ? 8 : capacity * 2;
-            MenuItem *new_items = realloc(local_items, sizeof(MenuItem) * new_capacity);
-            if (new_items == NULL) {
-                sqlite3_finalize(stmt);
-                free(local_items);
-                return false;
-            }
-            local_items = new_items;
-            capacity = new_capacity;
+        MenuItemView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.name = dao_column_text(stmt, 1);
+        row.category = dao_column_text(stmt, 2);
+        row.price = sqlite3_column_double(stmt, 3);
+        row.cost = sqlite3_column_double(stmt, 4);
+        row.stock = sqlite3_column_int(stmt, 5);
+        row.photo = dao_column_text(stmt, 6);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
         }
-        local_items[local_count].id = sqlite3_column_int(stmt, 0);
-        strncpy(local_items[local_count].name, (const char *)sqlite3_column_text(stmt, 1), sizeof(local_items[local_count].name) - 1);
-        local_items[local_count].name[sizeof(local_items[local_count].name) - 1] = '\0';
-        strncpy(local_items[local_count].category, (const char *)sqlite3_column_text(stmt, 2), sizeof(local_items[local_count].category) - 1);
-        local_items[local_count].category[sizeof(local_items[local_count].category) - 1] = '\0';
-        local_items[local_count].price = sqlite3_column_double(stmt, 3);
-        local_items[local_count].cost = sqlite3_column_double(stmt, 4);
-        local_items[local_count].stock = sqlite3_column_int(stmt, 5);
-        strncpy(local_items[local_count].photo, (const char *)sqlite3_column_text(stmt, 6), sizeof(local_items[local_count].photo) - 1);
-        local_items[local_count].photo[sizeof(local_items[local_count].photo) - 1] = '\0';
-        local_count = local_count + 1;
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    *items = local_items;
-    if (count != NULL) {
-        *count = local_count;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool dao_visit_open_orders(Database *db, DaoOrderIdVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_OPEN_ORDERS;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
     }
-    return true;
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        if (!visitor(sqlite3_column_int(stmt, 0), user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
 }
 
-bool dao_list_open_orders(sqlite3 *db, int **order_ids, int *count) {
-    const char *sql = "SELECT id FROM orders WHERE status='abierta' ORDER BY created_at DESC";
-    sqlite3_stmt *stmt = NULL;
+bool dao_visit_open_order_summaries(Database *db, DaoOrderSummaryVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_OPEN_ORDER_SUMMARIES;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
     int rc;
-    int capacity = 0;
-    int local_count = 0;
-    int *local_ids = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    if (stmt == NULL) {
         return false;
     }
     rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        if (local_count == capacity) {
-            int new_capacity = capacity == 0 ? 8 : capacity * 2;
-            int *new_ids = realloc(local_ids, sizeof(int) * new_capacity);
-            if (new_ids == NULL) {
-                sqlite3_finalize(stmt);
-                free(local_ids);
-                return false;
-            }
-            local_ids = new_ids;
-            capacity = new_capacity;
+        OrderSummaryView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.table_id = sqlite3_column_int(stmt, 1);
+        row.item_count = sqlite3_column_int(stmt, 2);
+        row.subtotal = sqlite3_column_double(stmt, 3);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
         }
-        local_ids[local_count] = sqlite3_column_int(stmt, 0);
-        local_count = local_count + 1;
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    *order_ids = local_ids;
-    if (count != NULL) {
-        *count = local_count;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool dao_visit_order_items(Database *db, int order_id, DaoOrderItemVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_ORDER_ITEMS_BY_ORDER;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
     }
-    return true;
+    sqlite3_bind_int(stmt, 1, order_id);
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        OrderItemView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.order_id = sqlite3_column_int(stmt, 1);
+        row.menu_item_id = sqlite3_column_int(stmt, 2);
+        row.status = dao_column_text(stmt, 3);
+        row.notes = dao_column_text(stmt, 4);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
 }
 
-bool dao_list_order_items(sqlite3 *db, int order_id, OrderItem **items, int *count) {
-    const char *sql = "SELECT id, order_id, menu_item_id, status, IFNULL(notes, '') FROM order_items WHERE order_id = ?";
-    sqlite3_stmt *stmt = NULL;
+bool dao_get_open_order_summary(Database *db, int order_id, OrderSummaryView *summary, bool *found) {
+    const char *sql = DAO_SQL_OPEN_ORDER_SUMMARY_BY_ID;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
     int rc;
-    int capacity = 0;
-    int local_count = 0;
-    OrderItem *local_items = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    *found = false;
+    if (stmt == NULL) {
         return false;
     }
     sqlite3_bind_int(stmt, 1, order_id);
     rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        summary->id = sqlite3_column_int(stmt, 0);
+        summary->table_id = sqlite3_column_int(stmt, 1);
+        summary->item_count = sqlite3_column_int(stmt, 2);
+        summary->subtotal = sqlite3_column_double(stmt, 3);
+        *found = true;
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_ROW || rc == SQLITE_DONE;
+}
+
+bool dao_visit_order_item(Database *db, int order_item_id, DaoOrderItemVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_ORDER_ITEM_BY_ID;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, order_item_id);
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        OrderItemView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.order_id = sqlite3_column_int(stmt, 1);
+        row.menu_item_id = sqlite3_column_int(stmt, 2);
+        row.status = dao_column_text(stmt, 3);
+        row.notes = dao_column_text(stmt, 4);
+        visitor(&row, user_data);
+    }
+    database_release(db, stmt);
+    return rc == SQLITE_ROW || rc == SQLITE_DONE;
+}
+
+static bool dao_visit_kitchen_rows(Database *db, const char *station, long long since_seq, DaoKitchenTicketVisitor visitor, void *user_data) {
+    const char *sql = since_seq < 0 ? DAO_SQL_KITCHEN_PENDING : DAO_SQL_KITCHEN_CHANGES;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, station != NULL ? station : "", -1, SQLITE_TRANSIENT);
+    if (since_seq >= 0) {
+        sqlite3_bind_int64(stmt, 2, since_seq);
+    }
+    rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        if (local_count == capacity) {
-            int new_capacity = capacity == 0 ? 8 : capacity * 2;
-            OrderItem *new_items = realloc(local_items, sizeof(OrderItem) * new_capacity);
-            if (new_items == NULL) {
-                sqlite3_finalize(stmt);
-                free(local_items);
-                return false;
-            }
-            local_items = new_items;
-            capacity = new_capacity;
+        KitchenTicketView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.order_id = sqlite3_column_int(stmt, 1);
+        row.table_id = sqlite3_column_int(stmt, 2);
+        row.item_name = dao_column_text(stmt, 3);
+        row.station = dao_column_text(stmt, 4);
+        row.status = dao_column_text(stmt, 5);
+        row.notes = dao_column_text(stmt, 6);
+        row.ordered_at = dao_column_text(stmt, 7);
+        row.active = sqlite3_column_int(stmt, 8) != 0;
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
         }
-        local_items[local_count].id = sqlite3_column_int(stmt, 0);
-        local_items[local_count].order_id = sqlite3_column_int(stmt, 1);
-        local_items[local_count].menu_item_id = sqlite3_column_int(stmt, 2);
-        strncpy(local_items[local_count].status, (const char *)sqlite3_column_text(stmt, 3), sizeof(local_items[local_count].status) - 1);
-        local_items[local_count].status[sizeof(local_items[local_count].status) - 1] = '\0';
-        strncpy(local_items[local_count].notes, (const char *)sqlite3_column_text(stmt, 4), sizeof(local_items[local_count].notes) - 1);
-        local_items[local_count].notes[sizeof(local_items[local_count].notes) - 1] = '\0';
-        local_count = local_count + 1;
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    *items = local_items;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool dao_visit_kitchen_tickets(Database *db, const char *station, long long since_seq, DaoKitchenTicketVisitor visitor, void *user_data, long long *seq) {
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+    /* Secuencia y filas en la misma lectura: lo que llegue después tiene secuencia mayor. */
+    if (!database_begin(db)) {
+        return false;
+    }
+    stmt = database_prepare(db, DAO_SQL_KITCHEN_SEQ);
+    if (stmt == NULL) {
+        database_rollback(db);
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *seq = sqlite3_column_int64(stmt, 0);
+    }
+    database_release(db, stmt);
+    if (rc != SQLITE_ROW || !dao_visit_kitchen_rows(db, station, since_seq, visitor, user_data)) {
+        database_rollback(db);
+        return false;
+    }
+    return database_commit(db);
+}
+
+typedef struct DaoArrayCollector {
+    void *rows;
+    int count;
+    int capacity;
+    bool failed;
+} DaoArrayCollector;
+
+static bool dao_collect_table(const TableRowView *row, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    TableStatus *table;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(TableStatus))) {
+        collector->failed = true;
+        return false;
+    }
+    table = (TableStatus *)collector->rows + collector->count;
+    table->id = row->id;
+    dao_copy_text(table->name, sizeof(table->name), row->name);
+    dao_copy_text(table->status, sizeof(table->status), row->status);
+    table->waiter_id = row->waiter_id;
+    table->capacity = row->capacity;
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collect_menu_item(const MenuItemView *row, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    MenuItem *item;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(MenuItem))) {
+        collector->failed = true;
+        return false;
+    }
+    item = (MenuItem *)collector->rows + collector->count;
+    item->id = row->id;
+    dao_copy_text(item->name, sizeof(item->name), row->name);
+    dao_copy_text(item->category, sizeof(item->category), row->category);
+    item->price = row->price;
+    item->cost = row->cost;
+    item->stock = row->stock;
+    dao_copy_text(item->photo, sizeof(item->photo), row->photo);
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collect_user(const UserView *row, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    User *user;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(User))) {
+        collector->failed = true;
+        return false;
+    }
+    user = (User *)collector->rows + collector->count;
+    user->id = row->id;
+    dao_copy_text(user->username, sizeof(user->username), row->username);
+    dao_copy_text(user->role, sizeof(user->role), row->role);
+    dao_copy_text(user->password_hash, sizeof(user->password_hash), row->password_hash);
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collect_order_id(int order_id, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(int))) {
+        collector->failed = true;
+        return false;
+    }
+    ((int *)collector->rows)[collector->count] = order_id;
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collect_order_item(const OrderItemView *row, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    OrderItem *item;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(OrderItem))) {
+        collector->failed = true;
+        return false;
+    }
+    item = (OrderItem *)collector->rows + collector->count;
+    item->id = row->id;
+    item->order_id = row->order_id;
+    item->menu_item_id = row->menu_item_id;
+    dao_copy_text(item->status, sizeof(item->status), row->status);
+    dao_copy_text(item->notes, sizeof(item->notes), row->notes);
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collect_reservation(const ReservationView *row, void *user_data) {
+    DaoArrayCollector *collector = (DaoArrayCollector *)user_data;
+    Reservation *reservation;
+    if (!dao_grow(&collector->rows, &collector->capacity, collector->count, sizeof(Reservation))) {
+        collector->failed = true;
+        return false;
+    }
+    reservation = (Reservation *)collector->rows + collector->count;
+    reservation->id = row->id;
+    reservation->table_id = row->table_id;
+    dao_copy_text(reservation->customer_name, sizeof(reservation->customer_name), row->customer_name);
+    dao_copy_text(reservation->customer_phone, sizeof(reservation->customer_phone), row->customer_phone);
+    dao_copy_text(reservation->reserved_at, sizeof(reservation->reserved_at), row->reserved_at);
+    dao_copy_text(reservation->notes, sizeof(reservation->notes), row->notes);
+    collector->count = collector->count + 1;
+    return true;
+}
+
+static bool dao_collector_finish(bool visited, DaoArrayCollector *collector, void **rows, int *count) {
+    if (!visited || collector->failed) {
+        free(collector->rows);
+        return false;
+    }
+    *rows = collector->rows;
     if (count != NULL) {
-        *count = local_count;
+        *count = collector->count;
+    }
+    return true;
+}
+
+bool dao_list_tables(Database *db, TableStatus **tables, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_tables(db, dao_collect_table, &collector), &collector, &rows, count)) {
+        return false;
+    }
+    *tables = (TableStatus *)rows;
+    return true;
+}
+
+bool dao_list_menu_items(Database *db, MenuItem **items, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_menu_items(db, dao_collect_menu_item, &collector), &collector, &rows, count)) {
+        return false;
+    }
+    *items = (MenuItem *)rows;
+    return true;
+}
+
+bool dao_list_users(Database *db, User **users, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_users(db, dao_collect_user, &collector), &collector, &rows, count)) {
+        return false;
+    }
+    *users = (User *)rows;
+    return true;
+}
+
+bool dao_list_open_orders(Database *db, int **order_ids, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_open_orders(db, dao_collect_order_id, &collector), &collector, &rows, count)) {
+        return false;
+    }
+    *order_ids = (int *)rows;
+    return true;
+}
+
+bool dao_list_order_items(Database *db, int order_id, OrderItem **items, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_order_items(db, order_id, dao_collect_order_item, &collector), &collector, &rows, count)) {
+        return false;
     }
+    *items = (OrderItem *)rows;
     return true;
 }
 
@@ -338,6 +912,10 @@ void dao_free_menu_items(MenuItem *items) {
     free(items);
 }
 
+void dao_free_users(User *users) {
+    free(users);
+}
+
 void dao_free_order_ids(int *order_ids) {
     free(order_ids);
 }
@@ -346,11 +924,11 @@ void dao_free_order_items(OrderItem *items) {
     free(items);
 }
 
-bool dao_create_reservation(sqlite3 *db, int table_id, const char *name, const char *phone, const char *reserved_at, const char *notes) {
-    const char *sql = "INSERT INTO reservations(table_id, customer_name, customer_phone, reserved_at, notes) VALUES(?, ?, ?, ?, ?)";
-    sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+bool dao_create_reservation(Database *db, int table_id, const char *name, const char *phone, const char *reserved_at, const char *notes, int *reservation_id) {
+    const char *sql = DAO_SQL_RESERVATION_INSERT;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
         return false;
     }
     sqlite3_bind_int(stmt, 1, table_id);
@@ -359,54 +937,255 @@ bool dao_create_reservation(sqlite3 *db, int table_id, const char *name, const c
     sqlite3_bind_text(stmt, 4, reserved_at, -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 5, notes == NULL ? "" : notes, -1, SQLITE_TRANSIENT);
     rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    database_release(db, stmt);
+    if (rc != SQLITE_DONE) {
+        return false;
+    }
+    if (reservation_id != NULL) {
+        *reservation_id = (int)sqlite3_last_insert_rowid(db->handle);
+    }
+    return true;
+}
+
+bool dao_cancel_reservation(Database *db, int reservation_id) {
+    int changes = 0;
+    return dao_step_with_id(db, DAO_SQL_RESERVATION_DELETE, reservation_id, &changes) && changes == 1;
+}
+
+bool dao_visit_reservations(Database *db, DaoReservationVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_RESERVATIONS_LIST;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        ReservationView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.table_id = sqlite3_column_int(stmt, 1);
+        row.customer_name = dao_column_text(stmt, 2);
+        row.customer_phone = dao_column_text(stmt, 3);
+        row.reserved_at = dao_column_text(stmt, 4);
+        row.notes = dao_column_text(stmt, 5);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    database_release(db, stmt);
     return rc == SQLITE_DONE;
 }
 
-bool dao_list_reservations(sqlite3 *db, Reservation **reservations, int *count) {
-    const char *sql = "SELECT id, table_id, customer_name, IFNULL(customer_phone,''), reserved_at, IFNULL(notes,'') FROM reservations ORDER BY reserved_at";
-    sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    int capacity = 0;
-    int local_count = 0;
-    Reservation *local_reservations = NULL;
-    if (rc != SQLITE_OK) {
+bool dao_list_reservations(Database *db, Reservation **reservations, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    memset(&collector, 0, sizeof(collector));
+    if (!dao_collector_finish(dao_visit_reservations(db, dao_collect_reservation, &collector), &collector, &rows, count)) {
+        return false;
+    }
+    *reservations = (Reservation *)rows;
+    return true;
+}
+
+bool dao_visit_reservations_window(Database *db, const char *from, const char *to, const ReservationKey *after_key, int limit, DaoReservationVisitor visitor, void *user_data) {
+    const char *sql = DAO_SQL_RESERVATIONS_WINDOW;
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
         return false;
     }
+    /* El índice por reserved_at termina en el rowid (id): la página siguiente se busca, no se recorre. */
+    if (after_key != NULL) {
+        sqlite3_bind_text(stmt, 1, after_key->reserved_at, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, after_key->id);
+    } else {
+        sqlite3_bind_text(stmt, 1, from, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, 0);
+    }
+    sqlite3_bind_text(stmt, 2, to, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 4, limit);
     rc = sqlite3_step(stmt);
     while (rc == SQLITE_ROW) {
-        if (local_count == capacity) {
-            int new_capacity = capacity == 0 ? 8 : capacity * 2;
-            Reservation *new_reservations = realloc(local_reservations, sizeof(Reservation) * new_capacity);
-            if (new_reservations == NULL) {
-                sqlite3_finalize(stmt);
-                free(local_reservations);
-                return false;
-            }
-            local_reservations = new_reservations;
-            capacity = new_capacity;
+        ReservationView row;
+        row.id = sqlite3_column_int(stmt, 0);
+        row.table_id = sqlite3_column_int(stmt, 1);
+        row.customer_name = dao_column_text(stmt, 2);
+        row.customer_phone = dao_column_text(stmt, 3);
+        row.reserved_at = dao_column_text(stmt, 4);
+        row.notes = dao_column_text(stmt, 5);
+        if (!visitor(&row, user_data)) {
+            rc = SQLITE_DONE;
+            break;
         }
-        local_reservations[local_count].id = sqlite3_column_int(stmt, 0);
-        local_reservations[local_count].table_id = sqlite3_column_int(stmt, 1);
-        strncpy(local_reservations[local_count].customer_name, (const char *)sqlite3_column_text(stmt, 2), sizeof(local_reservations[local_count].customer_name) - 1);
-        local_reservations[local_count].customer_name[sizeof(local_reservations[local_count].customer_name) - 1] = '\0';
-        strncpy(local_reservations[local_count].customer_phone, (const char *)sqlite3_column_text(stmt, 3), sizeof(local_reservations[local_count].customer_phone) - 1);
-        local_reservations[local_count].customer_phone[sizeof(local_reservations[local_count].customer_phone) - 1] = '\0';
-        strncpy(local_reservations[local_count].reserved_at, (const char *)sqlite3_column_text(stmt, 4), sizeof(local_reservations[local_count].reserved_at) - 1);
-        local_reservations[local_count].reserved_at[sizeof(local_reservations[local_count].reserved_at) - 1] = '\0';
-        strncpy(local_reservations[local_count].notes, (const char *)sqlite3_column_text(stmt, 5), sizeof(local_reservations[local_count].notes) - 1);
-        local_reservations[local_count].notes[sizeof(local_reservations[local_count].notes) - 1] = '\0';
-        local_count = local_count + 1;
         rc = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
-    *reservations = local_reservations;
-    if (count != NULL) {
-        *count = local_count;
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool dao_list_reservations_window(Database *db, const char *from, const char *to, const ReservationKey *after_key, int limit, Reservation **reservations, int *count) {
+    DaoArrayCollector collector;
+    void *rows = NULL;
+    bool visited;
+    memset(&collector, 0, sizeof(collector));
+    visited = dao_visit_reservations_window(db, from, to, after_key, limit, dao_collect_reservation, &collector);
+    if (!dao_collector_finish(visited, &collector, &rows, count)) {
+        return false;
     }
+    *reservations = (Reservation *)rows;
     return true;
 }
 
 void dao_free_reservations(Reservation *reservations) {
     free(reservations);
 }
+
+#define DAO_RESULT_BLOCK_SIZE 16384
+
+static void dao_result_set_init(DaoResultSet *set, size_t row_size) {
+    memset(set, 0, sizeof(DaoResultSet));
+    set->row_size = row_size;
+    arena_init(&set->arena, DAO_RESULT_BLOCK_SIZE);
+    arena_interner_init(&set->strings);
+}
+
+static const char *dao_result_text(DaoResultSet *set, const char *text, bool intern) {
+    const char *copy;
+    if (text[0] == '\0') {
+        return "";
+    }
+    copy = intern ? arena_intern(&set->strings, &set->arena, text) : arena_strdup(&set->arena, text);
+    if (copy == NULL) {
+        set->failed = true;
+        return "";
+    }
+    return copy;
+}
+
+static void *dao_result_next_row(DaoResultSet *set) {
+    void *row;
+    if (!dao_grow(&set->rows, &set->capacity, set->count, set->row_size)) {
+        set->failed = true;
+        return NULL;
+    }
+    row = (unsigned char *)set->rows + set->row_size * set->count;
+    set->count = set->count + 1;
+    return row;
+}
+
+static bool dao_result_table(const TableRowView *row, void *user_data) {
+    DaoResultSet *set = (DaoResultSet *)user_data;
+    TableRowView *copy = dao_result_next_row(set);
+    if (copy == NULL) {
+        return false;
+    }
+    copy->id = row->id;
+    copy->name = dao_result_text(set, row->name, false);
+    copy->status = dao_result_text(set, row->status, true);
+    copy->waiter_id = row->waiter_id;
+    copy->capacity = row->capacity;
+    return !set->failed;
+}
+
+static bool dao_result_menu_item(const MenuItemView *row, void *user_data) {
+    DaoResultSet *set = (DaoResultSet *)user_data;
+    MenuItemView *copy = dao_result_next_row(set);
+    if (copy == NULL) {
+        return false;
+    }
+    *copy = *row;
+    copy->name = dao_result_text(set, row->name, false);
+    copy->category = dao_result_text(set, row->category, true);
+    copy->photo = dao_result_text(set, row->photo, false);
+    return !set->failed;
+}
+
+static bool dao_result_order_id(int order_id, void *user_data) {
+    DaoResultSet *set = (DaoResultSet *)user_data;
+    int *copy = dao_result_next_row(set);
+    if (copy == NULL) {
+        return false;
+    }
+    *copy = order_id;
+    return true;
+}
+
+static bool dao_result_order_item(const OrderItemView *row, void *user_data) {
+    DaoResultSet *set = (DaoResultSet *)user_data;
+    OrderItemView *copy = dao_result_next_row(set);
+    if (copy == NULL) {
+        return false;
+    }
+    *copy = *row;
+    copy->status = dao_result_text(set, row->status, true);
+    copy->notes = dao_result_text(set, row->notes, false);
+    return !set->failed;
+}
+
+static bool dao_result_reservation(const ReservationView *row, void *user_data) {
+    DaoResultSet *set = (DaoResultSet *)user_data;
+    ReservationView *copy = dao_result_next_row(set);
+    if (copy == NULL) {
+        return false;
+    }
+    *copy = *row;
+    copy->customer_name = dao_result_text(set, row->customer_name, false);
+    copy->customer_phone = dao_result_text(set, row->customer_phone, false);
+    copy->reserved_at = dao_result_text(set, row->reserved_at, false);
+    copy->notes = dao_result_text(set, row->notes, false);
+    return !set->failed;
+}
+
+static bool dao_result_finish(bool visited, DaoResultSet *set) {
+    if (!visited || set->failed) {
+        dao_result_set_free(set);
+        return false;
+    }
+    return true;
+}
+
+bool dao_query_tables(Database *db, DaoResultSet *set) {
+    dao_result_set_init(set, sizeof(TableRowView));
+    return dao_result_finish(dao_visit_tables(db, dao_result_table, set), set);
+}
+
+bool dao_query_menu_items(Database *db, DaoResultSet *set) {
+    dao_result_set_init(set, sizeof(MenuItemView));
+    return dao_result_finish(dao_visit_menu_items(db, dao_result_menu_item, set), set);
+}
+
+bool dao_query_open_orders(Database *db, DaoResultSet *set) {
+    dao_result_set_init(set, sizeof(int));
+    return dao_result_finish(dao_visit_open_orders(db, dao_result_order_id, set), set);
+}
+
+bool dao_query_order_items(Database *db, int order_id, DaoResultSet *set) {
+    dao_result_set_init(set, sizeof(OrderItemView));
+    return dao_result_finish(dao_visit_order_items(db, order_id, dao_result_order_item, set), set);
+}
+
+bool dao_query_reservations(Database *db, DaoResultSet *set) {
+    dao_result_set_init(set, sizeof(ReservationView));
+    return dao_result_finish(dao_visit_reservations(db, dao_result_reservation, set), set);
+}
+
+size_t dao_result_set_memory(const DaoResultSet *set) {
+    if (set == NULL) {
+        return 0;
+    }
+    return set->arena.bytes_reserved + set->strings.capacity * sizeof(const char *) + set->row_size * (size_t)set->capacity;
+}
+
+void dao_result_set_free(DaoResultSet *set) {
+    if (set == NULL) {
+        return;
+    }
+    free(set->rows);
+    arena_interner_free(&set->strings);
+    arena_free(&set->arena);
+    set->rows = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
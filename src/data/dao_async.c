@@ -0,0 +1,174 @@
+#include "data/dao_async.h"
+#include <string.h>
+
+typedef struct DaoJob {
+    DaoAsync *pool;
+    DaoJobFunc func;
+    gpointer job_data;
+    GDestroyNotify free_data;
+    DaoJobDone done;
+    gpointer user_data;
+    gint64 queued_us;
+    bool ok;
+} DaoJob;
+
+struct DaoWorker {
+    DaoAsync *pool;
+    Database *db;
+    GAsyncQueue *queue;
+    GThread *thread;
+    bool owns_db;
+};
+
+static DaoJob dao_async_stop_job;
+
+static void dao_async_job_free(DaoJob *job) {
+    if (job->free_data != NULL) {
+        job->free_data(job->job_data);
+    }
+    g_free(job);
+}
+
+static gboolean dao_async_complete(gpointer data) {
+    DaoJob *job = (DaoJob *)data;
+    if (job->done != NULL && !g_atomic_int_get(&job->pool->detached)) {
+        job->done(job->ok, job->job_data, job->user_data);
+    }
+    dao_async_job_free(job);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer dao_async_worker_main(gpointer data) {
+    DaoWorker *worker = (DaoWorker *)data;
+    bool writer = worker->queue == worker->pool->write_queue;
+    while (TRUE) {
+        DaoJob *job = (DaoJob *)g_async_queue_pop(worker->queue);
+        gint64 started_us;
+        if (job == &dao_async_stop_job) {
+            break;
+        }
+        metrics_observe(worker->pool->metrics, writer ? METRICS_OP_UI_WRITE_WAIT : METRICS_OP_UI_READ_WAIT, job->queued_us);
+        started_us = g_get_monotonic_time();
+        job->ok = job->func(worker->db, job->job_data);
+        metrics_observe(worker->pool->metrics, writer ? METRICS_OP_UI_WRITE_RUN : METRICS_OP_UI_READ_RUN, started_us);
+        if (!job->ok) {
+            metrics_count(worker->pool->metrics, METRICS_COUNTER_JOBS_FAILED, 1);
+        }
+        g_main_context_invoke_full(worker->pool->main_context, G_PRIORITY_DEFAULT, dao_async_complete, job, NULL);
+    }
+    return NULL;
+}
+
+static bool dao_async_start_worker(DaoAsync *pool, DaoWorker *worker, Database *db, GAsyncQueue *queue, bool owns_db, const char *name) {
+    worker->pool = pool;
+    worker->db = db;
+    worker->queue = queue;
+    worker->owns_db = owns_db;
+    worker->thread = g_thread_new(name, dao_async_worker_main, worker);
+    return worker->thread != NULL;
+}
+
+bool dao_async_open(DaoAsync *pool, Database *writer, const char *path, const StorageProfile *profile, int reader_count, Logger *logger) {
+    int index = 0;
+    if (pool == NULL || writer == NULL) {
+        return false;
+    }
+    memset(pool, 0, sizeof(DaoAsync));
+    if (reader_count < 1) {
+        reader_count = 1;
+    }
+    pool->main_context = g_main_context_ref_thread_default();
+    pool->metrics = writer->metrics;
+    pool->read_queue = g_async_queue_new();
+    pool->write_queue = g_async_queue_new();
+    pool->writer = g_new0(DaoWorker, 1);
+    pool->readers = g_new0(DaoWorker, reader_count);
+    while (index < reader_count) {
+        Database *reader = NULL;
+        if (!database_open_readonly(&reader, path, profile, logger)) {
+            break;
+        }
+        database_set_metrics(reader, writer->metrics);
+        if (!dao_async_start_worker(pool, &pool->readers[index], reader, pool->read_queue, true, "dao-reader")) {
+            database_close(reader);
+            break;
+        }
+        index = index + 1;
+    }
+    pool->reader_count = index;
+    if (pool->reader_count == 0 || !dao_async_start_worker(pool, pool->writer, writer, pool->write_queue, false, "dao-writer")) {
+        dao_async_close(pool);
+        return false;
+    }
+    return true;
+}
+
+static void dao_async_submit(DaoAsync *pool, GAsyncQueue *queue, DaoJobFunc func, gpointer job_data, GDestroyNotify free_data, DaoJobDone done, gpointer user_data) {
+    DaoJob *job = g_new0(DaoJob, 1);
+    job->pool = pool;
+    job->func = func;
+    job->job_data = job_data;
+    job->free_data = free_data;
+    job->done = done;
+    job->user_data = user_data;
+    job->queued_us = g_get_monotonic_time();
+    g_async_queue_push(queue, job);
+    metrics_gauge_set(pool->metrics, queue == pool->write_queue ? METRICS_GAUGE_WRITE_QUEUE : METRICS_GAUGE_READ_QUEUE, g_async_queue_length(queue));
+}
+
+void dao_async_read(DaoAsync *pool, DaoJobFunc func, gpointer job_data, GDestroyNotify free_data, DaoJobDone done, gpointer user_data) {
+    dao_async_submit(pool, pool->read_queue, func, job_data, free_data, done, user_data);
+}
+
+void dao_async_write(DaoAsync *pool, DaoJobFunc func, gpointer job_data, GDestroyNotify free_data, DaoJobDone done, gpointer user_data) {
+    dao_async_submit(pool, pool->write_queue, func, job_data, free_data, done, user_data);
+}
+
+void dao_async_detach(DaoAsync *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    g_atomic_int_set(&pool->detached, 1);
+}
+
+static void dao_async_join_worker(DaoWorker *worker) {
+    if (worker->thread == NULL) {
+        return;
+    }
+    g_thread_join(worker->thread);
+    worker->thread = NULL;
+    if (worker->owns_db) {
+        database_close(worker->db);
+    }
+    worker->db = NULL;
+}
+
+void dao_async_close(DaoAsync *pool) {
+    int index = 0;
+    if (pool == NULL || pool->main_context == NULL) {
+        return;
+    }
+    dao_async_detach(pool);
+    if (pool->writer->thread != NULL) {
+        g_async_queue_push(pool->write_queue, &dao_async_stop_job);
+    }
+    while (index < pool->reader_count) {
+        g_async_queue_push(pool->read_queue, &dao_async_stop_job);
+        index = index + 1;
+    }
+    dao_async_join_worker(pool->writer);
+    index = 0;
+    while (index < pool->reader_count) {
+        dao_async_join_worker(&pool->readers[index]);
+        index = index + 1;
+    }
+    /* Las completions pendientes solo liberan memoria porque el pool ya está desacoplado. */
+    while (g_main_context_iteration(pool->main_context, FALSE)) {
+    }
+    g_async_queue_unref(pool->read_queue);
+    g_async_queue_unref(pool->write_queue);
+    g_free(pool->writer);
+    g_free(pool->readers);
+    g_main_context_unref(pool->main_context);
+    memset(pool, 0, sizeof(DaoAsync));
+}
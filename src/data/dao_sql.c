@@ -0,0 +1,115 @@
+#include "data/dao_sql.h"
+#include <stddef.h>
+
+const char DAO_SQL_USER_BY_USERNAME[] = "SELECT id, username, role, password_hash FROM users WHERE username = ?";
+const char DAO_SQL_ORDER_INSERT[] = "INSERT INTO orders(table_id, waiter_id, status, created_at, business_date) VALUES(?, ?, 'abierta', CURRENT_TIMESTAMP, DATE('now'))";
+const char DAO_SQL_TABLE_OCCUPY[] = "UPDATE tables SET status='ocupada', waiter_id = ? WHERE id = ?";
+const char DAO_SQL_ORDER_ITEM_INSERT[] = "INSERT INTO order_items(order_id, menu_item_id, status, notes, unit_price, unit_cost) SELECT ?, id, 'pedido', ?, price, cost FROM menu_items WHERE id = ?";
+const char DAO_SQL_ORDER_ITEM_SET_STATUS[] = "UPDATE order_items SET status = ? WHERE id = ? AND EXISTS (SELECT 1 FROM orders WHERE id = order_items.order_id AND status = 'abierta')";
+const char DAO_SQL_ORDER_SUBTOTAL[] = "SELECT subtotal FROM orders WHERE id = ?";
+const char DAO_SQL_DAILY_REPORT[] = "SELECT o.id, t.name, u.username, o.subtotal FROM orders o JOIN tables t ON o.table_id = t.id JOIN users u ON o.waiter_id = u.id WHERE o.business_date = ? AND o.item_count > 0";
+const char DAO_SQL_TABLES_LIST[] = "SELECT id, name, status, IFNULL(waiter_id, 0), capacity FROM tables ORDER BY id";
+const char DAO_SQL_MENU_ITEMS_LIST[] = "SELECT id, name, category, price, cost, stock, IFNULL(photo, '') FROM menu_items ORDER BY category, name";
+const char DAO_SQL_USERS_LIST[] = "SELECT id, username, role, password_hash FROM users ORDER BY id";
+const char DAO_SQL_DATA_VERSION[] = "PRAGMA data_version";
+const char DAO_SQL_TABLE_VERSIONS[] = "SELECT name, version FROM table_versions";
+const char DAO_SQL_OPEN_ORDERS[] = "SELECT id FROM orders WHERE status='abierta' ORDER BY created_at DESC";
+const char DAO_SQL_OPEN_ORDER_SUMMARIES[] = "SELECT id, table_id, item_count, subtotal FROM orders WHERE status='abierta' ORDER BY created_at DESC";
+const char DAO_SQL_ORDER_ITEMS_BY_ORDER[] = "SELECT id, order_id, menu_item_id, status, IFNULL(notes, '') FROM order_items WHERE order_id = ?";
+const char DAO_SQL_ORDER_ITEM_BY_ID[] = "SELECT id, order_id, menu_item_id, status, IFNULL(notes, '') FROM order_items WHERE id = ?";
+const char DAO_SQL_OPEN_ORDER_SUMMARY_BY_ID[] = "SELECT id, table_id, item_count, subtotal FROM orders WHERE id = ? AND status='abierta'";
+const char DAO_SQL_KITCHEN_SEQ[] = "SELECT version FROM table_versions WHERE name = 'order_items'";
+const char DAO_SQL_KITCHEN_PENDING[] = "SELECT oi.id, oi.order_id, o.table_id, mi.name, mi.station, oi.status, IFNULL(oi.notes, ''), strftime('%H:%M', o.created_at, 'localtime'), 1 FROM orders o JOIN order_items oi ON oi.order_id = o.id JOIN menu_items mi ON mi.id = oi.menu_item_id WHERE o.status = 'abierta' AND oi.status IN ('pedido', 'preparacion', 'listo') AND (?1 = '' OR mi.station = ?1) ORDER BY o.created_at";
+const char DAO_SQL_KITCHEN_CHANGES[] = "SELECT oi.id, oi.order_id, o.table_id, mi.name, mi.station, oi.status, IFNULL(oi.notes, ''), strftime('%H:%M', o.created_at, 'localtime'), o.status = 'abierta' AND oi.status IN ('pedido', 'preparacion', 'listo') FROM order_items oi JOIN orders o ON o.id = oi.order_id JOIN menu_items mi ON mi.id = oi.menu_item_id WHERE oi.change_seq > ?2 AND (?1 = '' OR mi.station = ?1) ORDER BY oi.change_seq";
+const char DAO_SQL_RESERVATION_INSERT[] = "INSERT INTO reservations(table_id, customer_name, customer_phone, reserved_at, notes) VALUES(?, ?, ?, ?, ?)";
+const char DAO_SQL_RESERVATION_DELETE[] = "DELETE FROM reservations WHERE id = ?1";
+const char DAO_SQL_RESERVATIONS_LIST[] = "SELECT id, table_id, customer_name, IFNULL(customer_phone,''), reserved_at, IFNULL(notes,'') FROM reservations ORDER BY reserved_at";
+const char DAO_SQL_RESERVATIONS_WINDOW[] = "SELECT id, table_id, customer_name, IFNULL(customer_phone,''), reserved_at, IFNULL(notes,'') FROM reservations WHERE reserved_at >= ?1 AND reserved_at < ?2 AND (reserved_at > ?1 OR id > ?3) ORDER BY reserved_at, id LIMIT ?4";
+const char DAO_SQL_ORDER_CLOSE[] = "UPDATE orders SET status='cerrada', closed_at=CURRENT_TIMESTAMP WHERE id = ? AND status='abierta'";
+const char DAO_SQL_TABLE_RELEASE[] = "UPDATE tables SET status='libre', waiter_id = NULL WHERE id = (SELECT table_id FROM orders WHERE id = ?1) AND NOT EXISTS (SELECT 1 FROM orders WHERE table_id = tables.id AND status='abierta')";
+const char DAO_SQL_ROLLUP_DAILY_ADD[] = "INSERT INTO sales_daily(business_date, revenue, cost, item_count, order_count) SELECT o.business_date, o.subtotal, IFNULL((SELECT ROUND(SUM(unit_cost), 2) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0), o.item_count, 1 FROM orders o WHERE o.id = ? ON CONFLICT(business_date) DO UPDATE SET revenue = ROUND(revenue + excluded.revenue, 2), cost = ROUND(cost + excluded.cost, 2), item_count = item_count + excluded.item_count, order_count = order_count + excluded.order_count";
+const char DAO_SQL_ROLLUP_WAITER_ADD[] = "INSERT INTO sales_daily_waiter(business_date, waiter_id, revenue, cost, item_count, order_count) SELECT o.business_date, o.waiter_id, o.subtotal, IFNULL((SELECT ROUND(SUM(unit_cost), 2) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0), o.item_count, 1 FROM orders o WHERE o.id = ? ON CONFLICT(business_date, waiter_id) DO UPDATE SET revenue = ROUND(revenue + excluded.revenue, 2), cost = ROUND(cost + excluded.cost, 2), item_count = item_count + excluded.item_count, order_count = order_count + excluded.order_count";
+const char DAO_SQL_ROLLUP_TABLE_ADD[] = "INSERT INTO sales_daily_table(business_date, table_id, revenue, cost, item_count, order_count) SELECT o.business_date, o.table_id, o.subtotal, IFNULL((SELECT ROUND(SUM(unit_cost), 2) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0), o.item_count, 1 FROM orders o WHERE o.id = ? ON CONFLICT(business_date, table_id) DO UPDATE SET revenue = ROUND(revenue + excluded.revenue, 2), cost = ROUND(cost + excluded.cost, 2), item_count = item_count + excluded.item_count, order_count = order_count + excluded.order_count";
+const char DAO_SQL_ROLLUP_ITEM_ADD[] = "INSERT INTO sales_daily_item(business_date, menu_item_id, revenue, cost, item_count, order_count) SELECT o.business_date, oi.menu_item_id, ROUND(SUM(oi.unit_price), 2), ROUND(SUM(oi.unit_cost), 2), COUNT(*), 1 FROM orders o JOIN order_items oi ON oi.order_id = o.id WHERE o.id = ? AND oi.status <> 'anulado' GROUP BY oi.menu_item_id ON CONFLICT(business_date, menu_item_id) DO UPDATE SET revenue = ROUND(revenue + excluded.revenue, 2), cost = ROUND(cost + excluded.cost, 2), item_count = item_count + excluded.item_count, order_count = order_count + excluded.order_count";
+const char DAO_SQL_ROLLUP_DAILY_CLEAR[] = "DELETE FROM sales_daily";
+const char DAO_SQL_ROLLUP_WAITER_CLEAR[] = "DELETE FROM sales_daily_waiter";
+const char DAO_SQL_ROLLUP_TABLE_CLEAR[] = "DELETE FROM sales_daily_table";
+const char DAO_SQL_ROLLUP_ITEM_CLEAR[] = "DELETE FROM sales_daily_item";
+const char DAO_SQL_ROLLUP_DAILY_REBUILD[] = "INSERT INTO sales_daily(business_date, revenue, cost, item_count, order_count) SELECT o.business_date, ROUND(SUM(o.subtotal), 2), ROUND(SUM(IFNULL((SELECT SUM(unit_cost) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0)), 2), SUM(o.item_count), COUNT(*) FROM orders o WHERE o.status = 'cerrada' GROUP BY o.business_date";
+const char DAO_SQL_ROLLUP_WAITER_REBUILD[] = "INSERT INTO sales_daily_waiter(business_date, waiter_id, revenue, cost, item_count, order_count) SELECT o.business_date, o.waiter_id, ROUND(SUM(o.subtotal), 2), ROUND(SUM(IFNULL((SELECT SUM(unit_cost) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0)), 2), SUM(o.item_count), COUNT(*) FROM orders o WHERE o.status = 'cerrada' GROUP BY o.business_date, o.waiter_id";
+const char DAO_SQL_ROLLUP_TABLE_REBUILD[] = "INSERT INTO sales_daily_table(business_date, table_id, revenue, cost, item_count, order_count) SELECT o.business_date, o.table_id, ROUND(SUM(o.subtotal), 2), ROUND(SUM(IFNULL((SELECT SUM(unit_cost) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0)), 2), SUM(o.item_count), COUNT(*) FROM orders o WHERE o.status = 'cerrada' GROUP BY o.business_date, o.table_id";
+const char DAO_SQL_ROLLUP_ITEM_REBUILD[] = "INSERT INTO sales_daily_item(business_date, menu_item_id, revenue, cost, item_count, order_count) SELECT o.business_date, oi.menu_item_id, ROUND(SUM(oi.unit_price), 2), ROUND(SUM(oi.unit_cost), 2), COUNT(*), COUNT(DISTINCT o.id) FROM orders o JOIN order_items oi ON oi.order_id = o.id WHERE o.status = 'cerrada' AND oi.status <> 'anulado' GROUP BY o.business_date, oi.menu_item_id";
+const char DAO_SQL_SALES_RANGE_TOTAL[] = "SELECT IFNULL(SUM(revenue), 0), IFNULL(SUM(cost), 0), IFNULL(SUM(item_count), 0), IFNULL(SUM(order_count), 0) FROM sales_daily WHERE business_date BETWEEN ? AND ?";
+const char DAO_SQL_BEGIN[] = "BEGIN";
+const char DAO_SQL_COMMIT[] = "COMMIT";
+const char DAO_SQL_ROLLBACK[] = "ROLLBACK";
+const char DAO_SQL_SCHEMA_VERSION_CREATE[] = "CREATE TABLE IF NOT EXISTS schema_version (version INTEGER PRIMARY KEY, applied_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP)";
+const char DAO_SQL_SCHEMA_VERSION_CURRENT[] = "SELECT version FROM schema_version ORDER BY version DESC LIMIT 1";
+const char DAO_SQL_SCHEMA_VERSION_INSERT[] = "INSERT INTO schema_version(version) VALUES(?)";
+const char DAO_SQL_SCHEMA_USER_VERSION[] = "PRAGMA user_version";
+const char DAO_SQL_SEED_NEEDED[] = "SELECT NOT EXISTS (SELECT 1 FROM users)";
+const char DAO_SQL_SEED_USER[] = "INSERT INTO users(username, role, password_hash) SELECT ?, ?, ? WHERE NOT EXISTS (SELECT 1 FROM users WHERE username = ?)";
+const char DAO_SQL_SEED_TABLE[] = "INSERT INTO tables(name, status, capacity) SELECT ?1, 'libre', ?2 WHERE NOT EXISTS (SELECT 1 FROM tables WHERE name = ?1)";
+const char DAO_SQL_SEED_MENU_ITEM[] = "INSERT INTO menu_items(name, category, price, cost, stock, station) SELECT ?, ?, ?, ?, ?, ? WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = ?1)";
+const char DAO_SQL_SEED_RESERVATION[] = "INSERT INTO reservations(table_id, customer_name, customer_phone, reserved_at, notes) SELECT 1, 'Cliente Demo', '123456789', datetime('now','+1 day'), 'Mesa junto a ventana' WHERE NOT EXISTS (SELECT 1 FROM reservations WHERE customer_name = 'Cliente Demo')";
+
+static const DaoSqlStatement DAO_SQL_STATEMENTS[] = {
+    {"DAO_SQL_USER_BY_USERNAME", DAO_SQL_USER_BY_USERNAME, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_INSERT", DAO_SQL_ORDER_INSERT, DAO_PLAN_INDEXED},
+    {"DAO_SQL_TABLE_OCCUPY", DAO_SQL_TABLE_OCCUPY, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_ITEM_INSERT", DAO_SQL_ORDER_ITEM_INSERT, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_ITEM_SET_STATUS", DAO_SQL_ORDER_ITEM_SET_STATUS, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_SUBTOTAL", DAO_SQL_ORDER_SUBTOTAL, DAO_PLAN_INDEXED},
+    {"DAO_SQL_DAILY_REPORT", DAO_SQL_DAILY_REPORT, DAO_PLAN_INDEXED},
+    {"DAO_SQL_TABLES_LIST", DAO_SQL_TABLES_LIST, DAO_PLAN_NO_TEMP_SORT},
+    {"DAO_SQL_MENU_ITEMS_LIST", DAO_SQL_MENU_ITEMS_LIST, DAO_PLAN_ANY},
+    {"DAO_SQL_USERS_LIST", DAO_SQL_USERS_LIST, DAO_PLAN_NO_TEMP_SORT},
+    {"DAO_SQL_DATA_VERSION", DAO_SQL_DATA_VERSION, DAO_PLAN_ANY},
+    {"DAO_SQL_TABLE_VERSIONS", DAO_SQL_TABLE_VERSIONS, DAO_PLAN_ANY},
+    {"DAO_SQL_OPEN_ORDERS", DAO_SQL_OPEN_ORDERS, DAO_PLAN_INDEXED},
+    {"DAO_SQL_OPEN_ORDER_SUMMARIES", DAO_SQL_OPEN_ORDER_SUMMARIES, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_ITEMS_BY_ORDER", DAO_SQL_ORDER_ITEMS_BY_ORDER, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_ITEM_BY_ID", DAO_SQL_ORDER_ITEM_BY_ID, DAO_PLAN_INDEXED},
+    {"DAO_SQL_OPEN_ORDER_SUMMARY_BY_ID", DAO_SQL_OPEN_ORDER_SUMMARY_BY_ID, DAO_PLAN_INDEXED},
+    {"DAO_SQL_KITCHEN_SEQ", DAO_SQL_KITCHEN_SEQ, DAO_PLAN_INDEXED},
+    {"DAO_SQL_KITCHEN_PENDING", DAO_SQL_KITCHEN_PENDING, DAO_PLAN_INDEXED},
+    {"DAO_SQL_KITCHEN_CHANGES", DAO_SQL_KITCHEN_CHANGES, DAO_PLAN_INDEXED},
+    {"DAO_SQL_RESERVATION_INSERT", DAO_SQL_RESERVATION_INSERT, DAO_PLAN_ANY},
+    {"DAO_SQL_RESERVATION_DELETE", DAO_SQL_RESERVATION_DELETE, DAO_PLAN_INDEXED},
+    {"DAO_SQL_RESERVATIONS_LIST", DAO_SQL_RESERVATIONS_LIST, DAO_PLAN_NO_TEMP_SORT},
+    {"DAO_SQL_RESERVATIONS_WINDOW", DAO_SQL_RESERVATIONS_WINDOW, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ORDER_CLOSE", DAO_SQL_ORDER_CLOSE, DAO_PLAN_INDEXED},
+    {"DAO_SQL_TABLE_RELEASE", DAO_SQL_TABLE_RELEASE, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ROLLUP_DAILY_ADD", DAO_SQL_ROLLUP_DAILY_ADD, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ROLLUP_WAITER_ADD", DAO_SQL_ROLLUP_WAITER_ADD, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ROLLUP_TABLE_ADD", DAO_SQL_ROLLUP_TABLE_ADD, DAO_PLAN_INDEXED},
+    {"DAO_SQL_ROLLUP_ITEM_ADD", DAO_SQL_ROLLUP_ITEM_ADD, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_DAILY_CLEAR", DAO_SQL_ROLLUP_DAILY_CLEAR, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_WAITER_CLEAR", DAO_SQL_ROLLUP_WAITER_CLEAR, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_TABLE_CLEAR", DAO_SQL_ROLLUP_TABLE_CLEAR, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_ITEM_CLEAR", DAO_SQL_ROLLUP_ITEM_CLEAR, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_DAILY_REBUILD", DAO_SQL_ROLLUP_DAILY_REBUILD, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_WAITER_REBUILD", DAO_SQL_ROLLUP_WAITER_REBUILD, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_TABLE_REBUILD", DAO_SQL_ROLLUP_TABLE_REBUILD, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLUP_ITEM_REBUILD", DAO_SQL_ROLLUP_ITEM_REBUILD, DAO_PLAN_ANY},
+    {"DAO_SQL_SALES_RANGE_TOTAL", DAO_SQL_SALES_RANGE_TOTAL, DAO_PLAN_INDEXED},
+    {"DAO_SQL_BEGIN", DAO_SQL_BEGIN, DAO_PLAN_ANY},
+    {"DAO_SQL_COMMIT", DAO_SQL_COMMIT, DAO_PLAN_ANY},
+    {"DAO_SQL_ROLLBACK", DAO_SQL_ROLLBACK, DAO_PLAN_ANY},
+    {"DAO_SQL_SCHEMA_VERSION_CREATE", DAO_SQL_SCHEMA_VERSION_CREATE, DAO_PLAN_ANY},
+    {"DAO_SQL_SCHEMA_VERSION_CURRENT", DAO_SQL_SCHEMA_VERSION_CURRENT, DAO_PLAN_NO_TEMP_SORT},
+    {"DAO_SQL_SCHEMA_VERSION_INSERT", DAO_SQL_SCHEMA_VERSION_INSERT, DAO_PLAN_ANY},
+    {"DAO_SQL_SCHEMA_USER_VERSION", DAO_SQL_SCHEMA_USER_VERSION, DAO_PLAN_ANY},
+    {"DAO_SQL_SEED_NEEDED", DAO_SQL_SEED_NEEDED, DAO_PLAN_ANY},
+    {"DAO_SQL_SEED_USER", DAO_SQL_SEED_USER, DAO_PLAN_INDEXED},
+    {"DAO_SQL_SEED_TABLE", DAO_SQL_SEED_TABLE, DAO_PLAN_ANY},
+    {"DAO_SQL_SEED_MENU_ITEM", DAO_SQL_SEED_MENU_ITEM, DAO_PLAN_ANY},
+    {"DAO_SQL_SEED_RESERVATION", DAO_SQL_SEED_RESERVATION, DAO_PLAN_ANY}
+};
+
+const DaoSqlStatement *dao_sql_statements(int *count) {
+    if (count != NULL) {
+        *count = (int)(sizeof(DAO_SQL_STATEMENTS) / sizeof(DAO_SQL_STATEMENTS[0]));
+    }
+    return DAO_SQL_STATEMENTS;
+}
@@ -1,7 +1,10 @@
 #include "data/database.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include "util/hash.h"
+#include "data/dao_sql.h"
 
 static bool database_execute(sqlite3 *db, const char *sql, Logger *logger) {
     char *errmsg = NULL;
@@ -15,24 +18,204 @@ static bool database_execute(sqlite3 *db, const char *sql, Logger *logger) {
     return true;
 }
 
-bool database_open(sqlite3 **db, const char *path, Logger *logger) {
-    if (sqlite3_open(path, db) != SQLITE_OK) {
+static bool database_pragma_value_allowed(const char *value, const char *const *allowed) {
+    int index = 0;
+    if (value == NULL || value[0] == '\0') {
+        return false;
+    }
+    while (allowed[index] != NULL) {
+        const char *a = allowed[index];
+        const char *b = value;
+        while (*a != '\0' && *b != '\0' && *a == toupper((unsigned char)*b)) {
+            a = a + 1;
+            b = b + 1;
+        }
+        if (*a == '\0' && *b == '\0') {
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+static bool database_apply_pragma(sqlite3 *db, const char *name, const char *value, const char *const *allowed, Logger *logger) {
+    char sql[96];
+    if (!database_pragma_value_allowed(value, allowed)) {
+        if (logger != NULL) {
+            logger_log_fields(logger, LOG_LEVEL_WARN, "database", "Valor inválido", LOG_FIELDS(LOG_STR("pragma", name), LOG_STR("value", value)));
+        }
+        return false;
+    }
+    snprintf(sql, sizeof(sql), "PRAGMA %s=%s", name, value);
+    return database_execute(db, sql, logger);
+}
+
+static void database_apply_profile(sqlite3 *db, const StorageProfile *profile, bool read_only, Logger *logger) {
+    static const char *const journal_modes[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF", NULL};
+    static const char *const sync_levels[] = {"OFF", "NORMAL", "FULL", "EXTRA", NULL};
+    static const char *const temp_stores[] = {"DEFAULT", "FILE", "MEMORY", NULL};
+    static const char *const vacuum_modes[] = {"NONE", "FULL", "INCREMENTAL", NULL};
+    char sql[96];
+    if (profile->busy_timeout_ms > 0) {
+        sqlite3_busy_timeout(db, profile->busy_timeout_ms);
+    }
+    if (!read_only) {
+        /* auto_vacuum solo tiene efecto antes de crear tablas, por eso va antes de journal_mode. */
+        database_apply_pragma(db, "auto_vacuum", profile->auto_vacuum, vacuum_modes, logger);
+        database_apply_pragma(db, "journal_mode", profile->journal_mode, journal_modes, logger);
+        database_apply_pragma(db, "synchronous", profile->synchronous, sync_levels, logger);
+    }
+    database_apply_pragma(db, "temp_store", profile->temp_store, temp_stores, logger);
+    if (profile->cache_size_kib > 0) {
+        snprintf(sql, sizeof(sql), "PRAGMA cache_size=-%d", profile->cache_size_kib);
+        database_execute(db, sql, logger);
+    }
+    if (profile->mmap_size >= 0) {
+        snprintf(sql, sizeof(sql), "PRAGMA mmap_size=%lld", profile->mmap_size);
+        database_execute(db, sql, logger);
+    }
+}
+
+static bool database_open_with_flags(Database **db, const char *path, int flags, const StorageProfile *profile, Logger *logger) {
+    Database *local_db = NULL;
+    if (db == NULL) {
+        return false;
+    }
+    *db = NULL;
+    local_db = calloc(1, sizeof(Database));
+    if (local_db == NULL) {
+        return false;
+    }
+    statement_cache_init(&local_db->statements);
+    if (sqlite3_open_v2(path, &local_db->handle, flags, NULL) != SQLITE_OK) {
         if (logger != NULL) {
-            logger_log(logger, LOG_LEVEL_ERROR, "database", "No se pudo abrir la base de datos");
+            logger_log_fields(logger, LOG_LEVEL_ERROR, "database", "No se pudo abrir la base de datos", LOG_FIELDS(LOG_STR("path", path)));
         }
+        sqlite3_close(local_db->handle);
+        free(local_db);
         return false;
     }
+    if (profile != NULL) {
+        database_apply_profile(local_db->handle, profile, (flags & SQLITE_OPEN_READONLY) != 0, logger);
+    }
+    *db = local_db;
     return true;
 }
 
-void database_close(sqlite3 *db) {
+bool database_open(Database **db, const char *path, const StorageProfile *profile, Logger *logger) {
+    return database_open_with_flags(db, path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, profile, logger);
+}
+
+bool database_open_readonly(Database **db, const char *path, const StorageProfile *profile, Logger *logger) {
+    return database_open_with_flags(db, path, SQLITE_OPEN_READONLY, profile, logger);
+}
+
+void database_close(Database *db) {
+    if (db == NULL) {
+        return;
+    }
+    statement_cache_clear(&db->statements);
+    sqlite3_close(db->handle);
+    free(db);
+}
+
+/* El histograma de cada sentencia lleva el nombre con que figura en dao_sql.c. */
+static const char *database_statement_name(const char *sql) {
+    int count = 0;
+    int index = 0;
+    const DaoSqlStatement *statements = dao_sql_statements(&count);
+    while (index < count) {
+        if (statements[index].sql == sql) {
+            return statements[index].name + strlen("DAO_SQL_");
+        }
+        index = index + 1;
+    }
+    return "OTHER";
+}
+
+sqlite3_stmt *database_prepare(Database *db, const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    StatementCacheEntry *entry = NULL;
+    if (db == NULL) {
+        return NULL;
+    }
+    stmt = statement_cache_acquire(&db->statements, db->handle, sql);
+    if (stmt == NULL || db->metrics == NULL) {
+        return stmt;
+    }
+    entry = statement_cache_entry(&db->statements, stmt);
+    if (entry != NULL) {
+        if (entry->latency == NULL) {
+            entry->latency = metrics_statement(db->metrics, database_statement_name(sql));
+        }
+        entry->started_us = g_get_monotonic_time();
+    }
+    return stmt;
+}
+
+void database_release(Database *db, sqlite3_stmt *stmt) {
+    if (db != NULL && db->metrics != NULL && stmt != NULL) {
+        StatementCacheEntry *entry = statement_cache_entry(&db->statements, stmt);
+        if (entry != NULL && entry->started_us != 0) {
+            metrics_histogram_record(entry->latency, g_get_monotonic_time() - entry->started_us);
+            entry->started_us = 0;
+        }
+    }
+    statement_cache_release(db == NULL ? NULL : &db->statements, stmt);
+    if (db != NULL && db->after_commit != NULL && sqlite3_get_autocommit(db->handle)) {
+        db->after_commit(db->after_commit_data);
+    }
+}
+
+void database_set_metrics(Database *db, Metrics *metrics) {
     if (db != NULL) {
-        sqlite3_close(db);
+        db->metrics = metrics;
+    }
+}
+
+void database_set_after_commit(Database *db, DatabaseCommitListener listener, void *user_data) {
+    if (db != NULL) {
+        db->after_commit = listener;
+        db->after_commit_data = user_data;
+    }
+}
+
+static bool database_step_cached(Database *db, const char *sql) {
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    int rc;
+    if (stmt == NULL) {
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    database_release(db, stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool database_begin(Database *db) {
+    return database_step_cached(db, DAO_SQL_BEGIN);
+}
+
+bool database_commit(Database *db) {
+    return database_step_cached(db, DAO_SQL_COMMIT);
+}
+
+void database_rollback(Database *db) {
+    if (db != NULL && !sqlite3_get_autocommit(db->handle)) {
+        database_step_cached(db, DAO_SQL_ROLLBACK);
+    }
+}
+
+void database_statement_stats(const Database *db, unsigned long *hits, unsigned long *misses) {
+    if (hits != NULL) {
+        *hits = db == NULL ? 0 : db->statements.hits;
+    }
+    if (misses != NULL) {
+        *misses = db == NULL ? 0 : db->statements.misses;
     }
 }
 
 static bool database_get_current_version(sqlite3 *db, int *version) {
-    const char *sql = "SELECT version FROM schema_version ORDER BY version DESC LIMIT 1";
+    const char *sql = DAO_SQL_SCHEMA_VERSION_CURRENT;
     sqlite3_stmt *stmt = NULL;
     int rc;
     *version = 0;
@@ -49,47 +232,110 @@ static bool database_get_current_version(sqlite3 *db, int *version) {
 }
 
 static bool database_ensure_schema_table(sqlite3 *db) {
-    const char *sql = "CREATE TABLE IF NOT EXISTS schema_version (version INTEGER PRIMARY KEY, applied_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP)";
+    const char *sql = DAO_SQL_SCHEMA_VERSION_CREATE;
     return database_execute(db, sql, NULL);
 }
 
-bool database_apply_migrations(sqlite3 *db, const Migration *migrations, int migration_count, Logger *logger) {
+static bool database_record_version(sqlite3 *db, int version) {
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+    if (sqlite3_prepare_v2(db, DAO_SQL_SCHEMA_VERSION_INSERT, -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_int(stmt, 1, version);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+static bool database_read_int(sqlite3 *db, const char *sql, int *value) {
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+    *value = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *value = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_ROW;
+}
+
+static int database_latest_migration(const Migration *migrations, int migration_count) {
+    int latest = 0;
+    int index = 0;
+    while (index < migration_count) {
+        if (migrations[index].version > latest) {
+            latest = migrations[index].version;
+        }
+        index = index + 1;
+    }
+    return latest;
+}
+
+bool database_schema_is_current(Database *db, const Migration *migrations, int migration_count) {
+    int user_version = 0;
+    if (!database_read_int(db->handle, DAO_SQL_SCHEMA_USER_VERSION, &user_version)) {
+        return false;
+    }
+    return user_version != 0 && user_version == database_latest_migration(migrations, migration_count);
+}
+
+bool database_needs_seed(Database *db, bool *needed) {
+    int empty = 0;
+    *needed = false;
+    if (!database_read_int(db->handle, DAO_SQL_SEED_NEEDED, &empty)) {
+        return false;
+    }
+    *needed = empty != 0;
+    return true;
+}
+
+bool database_apply_migrations(Database *db, const Migration *migrations, int migration_count, Logger *logger) {
     int current_version = 0;
     int index = 0;
-    if (!database_ensure_schema_table(db)) {
+    if (!database_ensure_schema_table(db->handle)) {
         return false;
     }
-    if (!database_get_current_version(db, &current_version)) {
+    if (!database_get_current_version(db->handle, &current_version)) {
         return false;
     }
     while (index < migration_count) {
         if (migrations[index].version > current_version) {
-            char insert_sql[128];
-            if (!database_execute(db, "BEGIN", logger)) {
+            if (!database_execute(db->handle, DAO_SQL_BEGIN, logger)) {
                 return false;
             }
-            if (!database_execute(db, migrations[index].sql, logger)) {
-                database_execute(db, "ROLLBACK", logger);
+            if (!database_execute(db->handle, migrations[index].sql, logger)) {
+                database_execute(db->handle, DAO_SQL_ROLLBACK, logger);
                 return false;
             }
-            snprintf(insert_sql, sizeof(insert_sql), "INSERT INTO schema_version(version) VALUES(%d)", migrations[index].version);
-            if (!database_execute(db, insert_sql, logger)) {
-                database_execute(db, "ROLLBACK", logger);
+            if (!database_record_version(db->handle, migrations[index].version)) {
+                database_execute(db->handle, DAO_SQL_ROLLBACK, logger);
                 return false;
             }
-            if (!database_execute(db, "COMMIT", logger)) {
-                database_execute(db, "ROLLBACK", logger);
+            if (!database_execute(db->handle, DAO_SQL_COMMIT, logger)) {
+                database_execute(db->handle, DAO_SQL_ROLLBACK, logger);
                 return false;
             }
             current_version = migrations[index].version;
         }
         index = index + 1;
     }
+    /* user_version vive en la cabecera del archivo: el próximo arranque lo lee sin tocar tablas. */
+    if (current_version == database_latest_migration(migrations, migration_count)) {
+        char sql[48];
+        snprintf(sql, sizeof(sql), "PRAGMA user_version=%d", current_version);
+        if (!database_execute(db->handle, sql, logger)) {
+            return false;
+        }
+    }
     return true;
 }
 
 static bool database_seed_user(sqlite3 *db, const char *username, const char *role, const char *password) {
-    const char *sql = "INSERT INTO users(username, role, password_hash) SELECT ?, ?, ? WHERE NOT EXISTS (SELECT 1 FROM users WHERE username = ?)";
+    const char *sql = DAO_SQL_SEED_USER;
     sqlite3_stmt *stmt = NULL;
     int rc;
     char hash_buffer[65];
@@ -113,8 +359,9 @@ static bool database_seed_user(sqlite3 *db, const char *username, const char *ro
     return true;
 }
 
+/* Las primeras mesas son de dos, las del fondo de seis. */
 static bool database_seed_table(sqlite3 *db, const char *name, int number) {
-    const char *sql = "INSERT INTO tables(name, status) SELECT ?, 'libre' WHERE NOT EXISTS (SELECT 1 FROM tables WHERE name = ?)";
+    const char *sql = DAO_SQL_SEED_TABLE;
     sqlite3_stmt *stmt = NULL;
     char buffer[64];
     int rc;
@@ -124,60 +371,88 @@ static bool database_seed_table(sqlite3 *db, const char *name, int number) {
         return false;
     }
     sqlite3_bind_text(stmt, 1, buffer, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, buffer, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, number <= 4 ? 2 : (number <= 8 ? 4 : 6));
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+typedef struct SeedMenuItem {
+    const char *name;
+    const char *category;
+    double price;
+    double cost;
+    int stock;
+    const char *station;
+} SeedMenuItem;
+
+static const SeedMenuItem SEED_MENU_ITEMS[] = {
+    {"Milanesa", "Plato Principal", 3500, 1500, 20, "cocina"},
+    {"Ensalada", "Entrada", 2100, 800, 15, "cocina"},
+    {"Sopa del día", "Entrada", 1800, 600, 10, "cocina"},
+    {"Ñoquis", "Plato Principal", 3200, 1400, 25, "cocina"},
+    {"Ravioles", "Plato Principal", 3300, 1500, 18, "cocina"},
+    {"Pizza Margherita", "Plato Principal", 3600, 1700, 20, "cocina"},
+    {"Hamburguesa Gourmet", "Plato Principal", 3400, 1600, 30, "cocina"},
+    {"Flan Casero", "Postre", 1500, 500, 12, "postres"},
+    {"Helado", "Postre", 1600, 600, 20, "postres"},
+    {"Café", "Bebida", 900, 200, 100, "barra"}
+};
+
+static bool database_seed_menu_item(sqlite3 *db, const SeedMenuItem *item) {
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+    if (sqlite3_prepare_v2(db, DAO_SQL_SEED_MENU_ITEM, -1, &stmt, NULL) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, item->name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, item->category, -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt, 3, item->price);
+    sqlite3_bind_double(stmt, 4, item->cost);
+    sqlite3_bind_int(stmt, 5, item->stock);
+    sqlite3_bind_text(stmt, 6, item->station, -1, SQLITE_STATIC);
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     return rc == SQLITE_DONE;
 }
 
-bool database_seed(sqlite3 *db, Logger *logger) {
+static bool database_seed_rows(Database *db, Logger *logger) {
     int table_index = 1;
-    if (!database_seed_user(db, "admin", "admin", "admin123")) {
+    int menu_index = 0;
+    if (!database_seed_user(db->handle, "admin", "admin", "admin123")) {
         return false;
     }
-    if (!database_seed_user(db, "mozo1", "mozo", "mozo123")) {
+    if (!database_seed_user(db->handle, "mozo1", "mozo", "mozo123")) {
         return false;
     }
-    if (!database_seed_user(db, "mozo2", "mozo", "mozo123")) {
+    if (!database_seed_user(db->handle, "mozo2", "mozo", "mozo123")) {
         return false;
     }
     while (table_index <= 10) {
-        if (!database_seed_table(db, "Mesa", table_index)) {
+        if (!database_seed_table(db->handle, "Mesa", table_index)) {
             return false;
         }
         table_index = table_index + 1;
     }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Milanesa', 'Plato Principal', 3500, 1500, 20 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Milanesa')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Ensalada', 'Entrada', 2100, 800, 15 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Ensalada')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Sopa del día', 'Entrada', 1800, 600, 10 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Sopa del día')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Ñoquis', 'Plato Principal', 3200, 1400, 25 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Ñoquis')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Ravioles', 'Plato Principal', 3300, 1500, 18 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Ravioles')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Pizza Margherita', 'Plato Principal', 3600, 1700, 20 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Pizza Margherita')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Hamburguesa Gourmet', 'Plato Principal', 3400, 1600, 30 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Hamburguesa Gourmet')", logger)) {
-        return false;
-    }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Flan Casero', 'Postre', 1500, 500, 12 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Flan Casero')", logger)) {
-        return false;
+    while (menu_index < (int)(sizeof(SEED_MENU_ITEMS) / sizeof(SEED_MENU_ITEMS[0]))) {
+        if (!database_seed_menu_item(db->handle, &SEED_MENU_ITEMS[menu_index])) {
+            return false;
+        }
+        menu_index = menu_index + 1;
     }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Helado', 'Postre', 1600, 600, 20 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Helado')", logger)) {
+    return database_execute(db->handle, DAO_SQL_SEED_RESERVATION, logger);
+}
+
+bool database_seed(Database *db, Logger *logger) {
+    if (!database_begin(db)) {
         return false;
     }
-    if (!database_execute(db, "INSERT INTO menu_items(name, category, price, cost, stock) SELECT 'Café', 'Bebida', 900, 200, 100 WHERE NOT EXISTS (SELECT 1 FROM menu_items WHERE name = 'Café')", logger)) {
+    if (!database_seed_rows(db, logger)) {
+        database_rollback(db);
         return false;
     }
-    if (!database_execute(db, "INSERT INTO reservations(table_id, customer_name, customer_phone, reserved_at, notes) SELECT 1, 'Cliente Demo', '123456789', datetime('now','+1 day'), 'Mesa junto a ventana' WHERE NOT EXISTS (SELECT 1 FROM reservations WHERE customer_name = 'Cliente Demo')", logger)) {
+    if (!database_commit(db)) {
+        database_rollback(db);
         return false;
     }
     return true;
@@ -0,0 +1,120 @@
+#include "data/maintenance.h"
+#include <stdio.h>
+#include <string.h>
+
+static int maintenance_pragma_int(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt = NULL;
+    int value = 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        value = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+static bool maintenance_exec(MaintenanceScheduler *scheduler, const char *sql) {
+    char *errmsg = NULL;
+    if (sqlite3_exec(scheduler->db->handle, sql, NULL, NULL, &errmsg) != SQLITE_OK) {
+        if (scheduler->logger != NULL && errmsg != NULL) {
+            logger_log(scheduler->logger, LOG_LEVEL_WARN, "maintenance", errmsg);
+        }
+        sqlite3_free(errmsg);
+        return false;
+    }
+    return true;
+}
+
+static bool maintenance_checkpoint(MaintenanceScheduler *scheduler, int mode) {
+    int log_frames = 0;
+    int checkpointed = 0;
+    int rc = sqlite3_wal_checkpoint_v2(scheduler->db->handle, NULL, mode, &log_frames, &checkpointed);
+    if (rc != SQLITE_OK) {
+        return false;
+    }
+    return checkpointed >= log_frames;
+}
+
+void maintenance_init(MaintenanceScheduler *scheduler, Database *db, Logger *logger) {
+    if (scheduler == NULL) {
+        return;
+    }
+    memset(scheduler, 0, sizeof(MaintenanceScheduler));
+    scheduler->db = db;
+    scheduler->logger = logger;
+    if (db != NULL) {
+        sqlite3_stmt *stmt = NULL;
+        scheduler->last_total_changes = sqlite3_total_changes(db->handle);
+        if (sqlite3_prepare_v2(db->handle, "PRAGMA journal_mode", -1, &stmt, NULL) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                const char *mode = (const char *)sqlite3_column_text(stmt, 0);
+                scheduler->wal_mode = mode != NULL && strcmp(mode, "wal") == 0;
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
+    scheduler->last_optimize = time(NULL);
+    scheduler->last_vacuum = scheduler->last_optimize;
+    scheduler->optimize_interval_s = 3600;
+    scheduler->vacuum_interval_s = 600;
+    scheduler->truncate_after_idle_ticks = 10;
+    scheduler->vacuum_pages_per_tick = 256;
+}
+
+MaintenanceTask maintenance_tick(MaintenanceScheduler *scheduler, time_t now) {
+    sqlite3 *handle;
+    int total_changes;
+    if (scheduler == NULL || scheduler->db == NULL) {
+        return MAINTENANCE_TASK_NONE;
+    }
+    handle = scheduler->db->handle;
+    total_changes = sqlite3_total_changes(handle);
+    if (total_changes != scheduler->last_total_changes || !sqlite3_get_autocommit(handle)) {
+        /* Hubo escrituras desde el último tick: no es momento de mantenimiento. */
+        scheduler->last_total_changes = total_changes;
+        scheduler->idle_ticks = 0;
+        scheduler->dirty_wal = scheduler->wal_mode;
+        return MAINTENANCE_TASK_NONE;
+    }
+    scheduler->idle_ticks = scheduler->idle_ticks + 1;
+    if (scheduler->dirty_wal) {
+        if (scheduler->idle_ticks >= scheduler->truncate_after_idle_ticks) {
+            if (maintenance_checkpoint(scheduler, SQLITE_CHECKPOINT_TRUNCATE)) {
+                scheduler->dirty_wal = false;
+            }
+            return MAINTENANCE_TASK_CHECKPOINT_TRUNCATE;
+        }
+        maintenance_checkpoint(scheduler, SQLITE_CHECKPOINT_PASSIVE);
+        return MAINTENANCE_TASK_CHECKPOINT_PASSIVE;
+    }
+    if (now - scheduler->last_optimize >= scheduler->optimize_interval_s) {
+        scheduler->last_optimize = now;
+        maintenance_exec(scheduler, "PRAGMA optimize");
+        return MAINTENANCE_TASK_OPTIMIZE;
+    }
+    if (now - scheduler->last_vacuum >= scheduler->vacuum_interval_s) {
+        char sql[64];
+        scheduler->last_vacuum = now;
+        if (maintenance_pragma_int(handle, "PRAGMA auto_vacuum") != 2 || maintenance_pragma_int(handle, "PRAGMA freelist_count") == 0) {
+            return MAINTENANCE_TASK_NONE;
+        }
+        snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d)", scheduler->vacuum_pages_per_tick);
+        maintenance_exec(scheduler, sql);
+        scheduler->last_total_changes = sqlite3_total_changes(handle);
+        scheduler->dirty_wal = scheduler->wal_mode;
+        return MAINTENANCE_TASK_INCREMENTAL_VACUUM;
+    }
+    return MAINTENANCE_TASK_NONE;
+}
+
+void maintenance_finish(MaintenanceScheduler *scheduler) {
+    if (scheduler == NULL || scheduler->db == NULL) {
+        return;
+    }
+    maintenance_exec(scheduler, "PRAGMA optimize");
+    if (scheduler->wal_mode) {
+        maintenance_checkpoint(scheduler, SQLITE_CHECKPOINT_TRUNCATE);
+    }
+}
@@ -0,0 +1,198 @@
+#include "data/migrations.h"
+
+static const char MIGRATION_1[] =
+    "CREATE TABLE IF NOT EXISTS users("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "username TEXT UNIQUE NOT NULL,"\
+    "role TEXT NOT NULL,"\
+    "password_hash TEXT NOT NULL"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS menu_items("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "name TEXT NOT NULL,"\
+    "category TEXT NOT NULL,"\
+    "price REAL NOT NULL,"\
+    "cost REAL NOT NULL,"\
+    "stock INTEGER DEFAULT 0,"\
+    "photo TEXT"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS tables("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "name TEXT NOT NULL,"\
+    "status TEXT NOT NULL DEFAULT 'libre',"\
+    "waiter_id INTEGER,"\
+    "FOREIGN KEY(waiter_id) REFERENCES users(id)"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS orders("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "table_id INTEGER NOT NULL,"\
+    "waiter_id INTEGER NOT NULL,"\
+    "status TEXT NOT NULL DEFAULT 'abierta',"\
+    "created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,"\
+    "FOREIGN KEY(table_id) REFERENCES tables(id),"\
+    "FOREIGN KEY(waiter_id) REFERENCES users(id)"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS order_items("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "order_id INTEGER NOT NULL,"\
+    "menu_item_id INTEGER NOT NULL,"\
+    "status TEXT NOT NULL DEFAULT 'pedido',"\
+    "notes TEXT,"\
+    "FOREIGN KEY(order_id) REFERENCES orders(id),"\
+    "FOREIGN KEY(menu_item_id) REFERENCES menu_items(id)"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS reservations("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "table_id INTEGER NOT NULL,"\
+    "customer_name TEXT NOT NULL,"\
+    "customer_phone TEXT,"\
+    "reserved_at TEXT NOT NULL,"\
+    "notes TEXT,"\
+    "FOREIGN KEY(table_id) REFERENCES tables(id)"\
+    ");"\
+    "CREATE TABLE IF NOT EXISTS payments("\
+    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
+    "order_id INTEGER NOT NULL,"\
+    "amount REAL NOT NULL,"\
+    "method TEXT NOT NULL,"\
+    "created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,"\
+    "FOREIGN KEY(order_id) REFERENCES orders(id)"\
+    ");"\
+    "CREATE INDEX IF NOT EXISTS idx_orders_table ON orders(table_id);"\
+    "CREATE INDEX IF NOT EXISTS idx_order_items_order ON order_items(order_id);";
+
+static const char MIGRATION_2[] =
+    "ALTER TABLE order_items ADD COLUMN unit_price REAL NOT NULL DEFAULT 0;"\
+    "ALTER TABLE orders ADD COLUMN subtotal REAL NOT NULL DEFAULT 0;"\
+    "ALTER TABLE orders ADD COLUMN item_count INTEGER NOT NULL DEFAULT 0;"\
+    "UPDATE order_items SET unit_price = IFNULL((SELECT price FROM menu_items WHERE id = order_items.menu_item_id), 0);"\
+    "UPDATE orders SET "\
+    "subtotal = IFNULL((SELECT ROUND(SUM(unit_price), 2) FROM order_items WHERE order_id = orders.id AND status <> 'anulado'), 0),"\
+    "item_count = (SELECT COUNT(*) FROM order_items WHERE order_id = orders.id AND status <> 'anulado');"\
+    "CREATE TRIGGER IF NOT EXISTS trg_order_items_insert AFTER INSERT ON order_items "\
+    "WHEN NEW.status <> 'anulado' "\
+    "BEGIN "\
+    "UPDATE orders SET subtotal = ROUND(subtotal + NEW.unit_price, 2), item_count = item_count + 1 WHERE id = NEW.order_id;"\
+    "END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_order_items_delete AFTER DELETE ON order_items "\
+    "WHEN OLD.status <> 'anulado' "\
+    "BEGIN "\
+    "UPDATE orders SET subtotal = ROUND(subtotal - OLD.unit_price, 2), item_count = item_count - 1 WHERE id = OLD.order_id;"\
+    "END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_order_items_update AFTER UPDATE OF order_id, unit_price, status ON order_items "\
+    "WHEN OLD.order_id <> NEW.order_id OR OLD.unit_price <> NEW.unit_price OR (OLD.status = 'anulado') <> (NEW.status = 'anulado') "\
+    "BEGIN "\
+    "UPDATE orders SET subtotal = ROUND(subtotal - OLD.unit_price, 2), item_count = item_count - 1 WHERE id = OLD.order_id AND OLD.status <> 'anulado';"\
+    "UPDATE orders SET subtotal = ROUND(subtotal + NEW.unit_price, 2), item_count = item_count + 1 WHERE id = NEW.order_id AND NEW.status <> 'anulado';"\
+    "END;";
+
+static const char MIGRATION_3[] =
+    "ALTER TABLE orders ADD COLUMN business_date TEXT;"\
+    "UPDATE orders SET business_date = DATE(created_at);"\
+    "CREATE TRIGGER IF NOT EXISTS trg_orders_business_date AFTER INSERT ON orders "\
+    "WHEN NEW.business_date IS NULL "\
+    "BEGIN "\
+    "UPDATE orders SET business_date = DATE(NEW.created_at) WHERE id = NEW.id;"\
+    "END;"\
+    "CREATE INDEX IF NOT EXISTS idx_orders_business_date ON orders(business_date);"\
+    "CREATE INDEX IF NOT EXISTS idx_orders_status_created ON orders(status, created_at);"\
+    "CREATE INDEX IF NOT EXISTS idx_reservations_reserved_at ON reservations(reserved_at);"\
+    "CREATE INDEX IF NOT EXISTS idx_reservations_table_reserved ON reservations(table_id, reserved_at);"\
+    "CREATE INDEX IF NOT EXISTS idx_payments_order ON payments(order_id);";
+
+static const char MIGRATION_4[] =
+    "ALTER TABLE order_items ADD COLUMN unit_cost REAL NOT NULL DEFAULT 0;"\
+    "UPDATE order_items SET unit_cost = IFNULL((SELECT cost FROM menu_items WHERE id = order_items.menu_item_id), 0);"\
+    "ALTER TABLE orders ADD COLUMN closed_at TEXT;"\
+    "CREATE TABLE IF NOT EXISTS sales_daily ("\
+    "business_date TEXT PRIMARY KEY,"\
+    "revenue REAL NOT NULL DEFAULT 0,"\
+    "cost REAL NOT NULL DEFAULT 0,"\
+    "item_count INTEGER NOT NULL DEFAULT 0,"\
+    "order_count INTEGER NOT NULL DEFAULT 0"\
+    ") WITHOUT ROWID;"\
+    "CREATE TABLE IF NOT EXISTS sales_daily_waiter ("\
+    "business_date TEXT NOT NULL,"\
+    "waiter_id INTEGER NOT NULL,"\
+    "revenue REAL NOT NULL DEFAULT 0,"\
+    "cost REAL NOT NULL DEFAULT 0,"\
+    "item_count INTEGER NOT NULL DEFAULT 0,"\
+    "order_count INTEGER NOT NULL DEFAULT 0,"\
+    "PRIMARY KEY(business_date, waiter_id)"\
+    ") WITHOUT ROWID;"\
+    "CREATE TABLE IF NOT EXISTS sales_daily_table ("\
+    "business_date TEXT NOT NULL,"\
+    "table_id INTEGER NOT NULL,"\
+    "revenue REAL NOT NULL DEFAULT 0,"\
+    "cost REAL NOT NULL DEFAULT 0,"\
+    "item_count INTEGER NOT NULL DEFAULT 0,"\
+    "order_count INTEGER NOT NULL DEFAULT 0,"\
+    "PRIMARY KEY(business_date, table_id)"\
+    ") WITHOUT ROWID;"\
+    "CREATE TABLE IF NOT EXISTS sales_daily_item ("\
+    "business_date TEXT NOT NULL,"\
+    "menu_item_id INTEGER NOT NULL,"\
+    "revenue REAL NOT NULL DEFAULT 0,"\
+    "cost REAL NOT NULL DEFAULT 0,"\
+    "item_count INTEGER NOT NULL DEFAULT 0,"\
+    "order_count INTEGER NOT NULL DEFAULT 0,"\
+    "PRIMARY KEY(business_date, menu_item_id)"\
+    ") WITHOUT ROWID;";
+
+static const char MIGRATION_5[] =
+    "CREATE TABLE IF NOT EXISTS table_versions (name TEXT PRIMARY KEY, version INTEGER NOT NULL DEFAULT 0) WITHOUT ROWID;"\
+    "INSERT OR IGNORE INTO table_versions(name, version) VALUES ('menu_items', 0), ('tables', 0), ('users', 0);"\
+    "CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_insert AFTER INSERT ON menu_items BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_update AFTER UPDATE ON menu_items BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_menu_items_version_delete AFTER DELETE ON menu_items BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'menu_items'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_tables_version_insert AFTER INSERT ON tables BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'tables'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_tables_version_update AFTER UPDATE ON tables BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'tables'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_tables_version_delete AFTER DELETE ON tables BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'tables'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_users_version_insert AFTER INSERT ON users BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'users'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_users_version_update AFTER UPDATE ON users BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'users'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_users_version_delete AFTER DELETE ON users BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'users'; END;";
+
+static const char MIGRATION_6[] =
+    "ALTER TABLE menu_items ADD COLUMN station TEXT NOT NULL DEFAULT 'cocina';"\
+    "UPDATE menu_items SET station = 'barra' WHERE category = 'Bebida';"\
+    "UPDATE menu_items SET station = 'postres' WHERE category = 'Postre';"\
+    "ALTER TABLE order_items ADD COLUMN change_seq INTEGER NOT NULL DEFAULT 0;"\
+    "INSERT OR IGNORE INTO table_versions(name, version) VALUES ('order_items', 0);"\
+    "CREATE TRIGGER IF NOT EXISTS trg_order_items_seq_insert AFTER INSERT ON order_items "\
+    "BEGIN "\
+    "UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';"\
+    "UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items') WHERE id = NEW.id;"\
+    "END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_order_items_seq_status AFTER UPDATE OF status ON order_items "\
+    "WHEN OLD.status <> NEW.status "\
+    "BEGIN "\
+    "UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';"\
+    "UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items') WHERE id = NEW.id;"\
+    "END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_orders_seq_status AFTER UPDATE OF status ON orders "\
+    "WHEN OLD.status <> NEW.status "\
+    "BEGIN "\
+    "UPDATE table_versions SET version = version + 1 WHERE name = 'order_items';"\
+    "UPDATE order_items SET change_seq = (SELECT version FROM table_versions WHERE name = 'order_items') "\
+    "WHERE order_id = NEW.id AND status IN ('pedido', 'preparacion', 'listo');"\
+    "END;"\
+    "CREATE INDEX IF NOT EXISTS idx_order_items_change_seq ON order_items(change_seq);";
+
+static const char MIGRATION_7[] =
+    "ALTER TABLE tables ADD COLUMN capacity INTEGER NOT NULL DEFAULT 4;"\
+    "INSERT OR IGNORE INTO table_versions(name, version) VALUES ('reservations', 0);"\
+    "CREATE TRIGGER IF NOT EXISTS trg_reservations_version_insert AFTER INSERT ON reservations BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'reservations'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_reservations_version_update AFTER UPDATE ON reservations BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'reservations'; END;"\
+    "CREATE TRIGGER IF NOT EXISTS trg_reservations_version_delete AFTER DELETE ON reservations BEGIN UPDATE table_versions SET version = version + 1 WHERE name = 'reservations'; END;";
+
+const Migration MIGRATIONS[] = {
+    {1, MIGRATION_1},
+    {2, MIGRATION_2},
+    {3, MIGRATION_3},
+    {4, MIGRATION_4},
+    {5, MIGRATION_5},
+    {6, MIGRATION_6},
+    {7, MIGRATION_7}
+};
+
+const int MIGRATION_COUNT = sizeof(MIGRATIONS) / sizeof(Migration);
@@ -0,0 +1,203 @@
+#include "data/snapshot_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const SNAPSHOT_TABLE_NAMES[SNAPSHOT_KIND_COUNT] = {"menu_items", "tables", "users"};
+
+typedef struct SnapshotVersions {
+    int versions[SNAPSHOT_KIND_COUNT];
+} SnapshotVersions;
+
+/* MenuItem, TableStatus y User empiezan con el id. */
+static int snapshot_row_id(const Snapshot *snapshot, int index) {
+    return *(const int *)((const char *)snapshot->rows + (size_t)index * snapshot->row_size);
+}
+
+static unsigned int snapshot_hash_id(int id) {
+    return (unsigned int)id * 2654435761u;
+}
+
+static bool snapshot_build_index(Snapshot *snapshot) {
+    int capacity = 8;
+    int index = 0;
+    while (capacity < snapshot->count * 2) {
+        capacity = capacity * 2;
+    }
+    snapshot->slots = calloc((size_t)capacity, sizeof(int));
+    if (snapshot->slots == NULL) {
+        return false;
+    }
+    snapshot->slot_mask = capacity - 1;
+    while (index < snapshot->count) {
+        unsigned int slot = snapshot_hash_id(snapshot_row_id(snapshot, index)) & (unsigned int)snapshot->slot_mask;
+        while (snapshot->slots[slot] != 0) {
+            slot = (slot + 1) & (unsigned int)snapshot->slot_mask;
+        }
+        snapshot->slots[slot] = index + 1;
+        index = index + 1;
+    }
+    return true;
+}
+
+static const void *snapshot_find(const Snapshot *snapshot, SnapshotKind kind, int id) {
+    unsigned int slot;
+    if (snapshot == NULL || snapshot->kind != kind || snapshot->slots == NULL) {
+        return NULL;
+    }
+    slot = snapshot_hash_id(id) & (unsigned int)snapshot->slot_mask;
+    while (snapshot->slots[slot] != 0) {
+        int index = snapshot->slots[slot] - 1;
+        if (snapshot_row_id(snapshot, index) == id) {
+            return (const char *)snapshot->rows + (size_t)index * snapshot->row_size;
+        }
+        slot = (slot + 1) & (unsigned int)snapshot->slot_mask;
+    }
+    return NULL;
+}
+
+static Snapshot *snapshot_load(Database *db, SnapshotKind kind, int version) {
+    Snapshot *snapshot = calloc(1, sizeof(Snapshot));
+    bool ok = false;
+    if (snapshot == NULL) {
+        return NULL;
+    }
+    snapshot->refs = 1;
+    snapshot->kind = kind;
+    snapshot->version = version;
+    if (kind == SNAPSHOT_MENU_ITEMS) {
+        MenuItem *items = NULL;
+        ok = dao_list_menu_items(db, &items, &snapshot->count);
+        snapshot->rows = items;
+        snapshot->row_size = sizeof(MenuItem);
+    } else if (kind == SNAPSHOT_TABLES) {
+        TableStatus *tables = NULL;
+        ok = dao_list_tables(db, &tables, &snapshot->count);
+        snapshot->rows = tables;
+        snapshot->row_size = sizeof(TableStatus);
+    } else if (kind == SNAPSHOT_USERS) {
+        User *users = NULL;
+        ok = dao_list_users(db, &users, &snapshot->count);
+        snapshot->rows = users;
+        snapshot->row_size = sizeof(User);
+    }
+    if (!ok || !snapshot_build_index(snapshot)) {
+        free(snapshot->rows);
+        free(snapshot);
+        return NULL;
+    }
+    return snapshot;
+}
+
+void snapshot_release(Snapshot *snapshot) {
+    if (snapshot == NULL || !g_atomic_int_dec_and_test(&snapshot->refs)) {
+        return;
+    }
+    free(snapshot->rows);
+    free(snapshot->slots);
+    free(snapshot);
+}
+
+static bool snapshot_collect_version(const char *table_name, int version, void *user_data) {
+    SnapshotVersions *versions = (SnapshotVersions *)user_data;
+    int kind = 0;
+    while (kind < SNAPSHOT_KIND_COUNT) {
+        if (strcmp(table_name, SNAPSHOT_TABLE_NAMES[kind]) == 0) {
+            versions->versions[kind] = version;
+        }
+        kind = kind + 1;
+    }
+    return true;
+}
+
+/* Sin escrituras desde la última validación en esta conexión, todo lo cacheado sigue vigente. */
+static bool snapshot_connection_unchanged(Database *db, int *data_version, int *total_changes) {
+    if (!dao_get_data_version(db, data_version)) {
+        return false;
+    }
+    *total_changes = sqlite3_total_changes(db->handle);
+    return db->snapshot_stamped && db->snapshot_data_version == *data_version && db->snapshot_total_changes == *total_changes;
+}
+
+static bool snapshot_cache_validate(SnapshotCache *cache, Database *db, SnapshotKind kind, int data_version, int total_changes) {
+    SnapshotVersions versions;
+    int index = 0;
+    memset(&versions, 0xff, sizeof(versions));
+    cache->validations = cache->validations + 1;
+    if (!dao_visit_table_versions(db, snapshot_collect_version, &versions)) {
+        return false;
+    }
+    while (index < SNAPSHOT_KIND_COUNT) {
+        if (cache->snapshots[index] != NULL && cache->snapshots[index]->version != versions.versions[index]) {
+            snapshot_release(cache->snapshots[index]);
+            cache->snapshots[index] = NULL;
+        }
+        index = index + 1;
+    }
+    if (cache->snapshots[kind] == NULL) {
+        cache->snapshots[kind] = snapshot_load(db, kind, versions.versions[kind]);
+        if (cache->snapshots[kind] == NULL) {
+            return false;
+        }
+        cache->rebuilds = cache->rebuilds + 1;
+    }
+    db->snapshot_stamped = true;
+    db->snapshot_data_version = data_version;
+    db->snapshot_total_changes = total_changes;
+    return true;
+}
+
+void snapshot_cache_init(SnapshotCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    memset(cache, 0, sizeof(SnapshotCache));
+    g_mutex_init(&cache->lock);
+}
+
+Snapshot *snapshot_cache_acquire(SnapshotCache *cache, Database *db, SnapshotKind kind) {
+    Snapshot *snapshot = NULL;
+    int data_version = 0;
+    int total_changes = 0;
+    bool unchanged;
+    if (cache == NULL || db == NULL || kind < 0 || kind >= SNAPSHOT_KIND_COUNT) {
+        return NULL;
+    }
+    g_mutex_lock(&cache->lock);
+    unchanged = snapshot_connection_unchanged(db, &data_version, &total_changes);
+    if (unchanged && cache->snapshots[kind] != NULL) {
+        cache->hits = cache->hits + 1;
+        snapshot = cache->snapshots[kind];
+    } else if (snapshot_cache_validate(cache, db, kind, data_version, total_changes)) {
+        snapshot = cache->snapshots[kind];
+    }
+    if (snapshot != NULL) {
+        g_atomic_int_inc(&snapshot->refs);
+    }
+    g_mutex_unlock(&cache->lock);
+    return snapshot;
+}
+
+void snapshot_cache_clear(SnapshotCache *cache) {
+    int index = 0;
+    if (cache == NULL) {
+        return;
+    }
+    while (index < SNAPSHOT_KIND_COUNT) {
+        snapshot_release(cache->snapshots[index]);
+        index = index + 1;
+    }
+    g_mutex_clear(&cache->lock);
+    memset(cache, 0, sizeof(SnapshotCache));
+}
+
+const MenuItem *snapshot_menu_item(const Snapshot *snapshot, int id) {
+    return (const MenuItem *)snapshot_find(snapshot, SNAPSHOT_MENU_ITEMS, id);
+}
+
+const TableStatus *snapshot_table(const Snapshot *snapshot, int id) {
+    return (const TableStatus *)snapshot_find(snapshot, SNAPSHOT_TABLES, id);
+}
+
+const User *snapshot_user(const Snapshot *snapshot, int id) {
+    return (const User *)snapshot_find(snapshot, SNAPSHOT_USERS, id);
+}
@@ -0,0 +1,99 @@
+#include "data/statement_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+void statement_cache_init(StatementCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    memset(cache, 0, sizeof(StatementCache));
+}
+
+static StatementCacheEntry *statement_cache_find(StatementCache *cache, const char *sql) {
+    int index = 0;
+    while (index < cache->count) {
+        if (cache->entries[index].sql == sql) {
+            return &cache->entries[index];
+        }
+        index = index + 1;
+    }
+    return NULL;
+}
+
+sqlite3_stmt *statement_cache_acquire(StatementCache *cache, sqlite3 *db, const char *sql) {
+    StatementCacheEntry *entry = NULL;
+    sqlite3_stmt *stmt = NULL;
+    if (cache == NULL || db == NULL || sql == NULL) {
+        return NULL;
+    }
+    entry = statement_cache_find(cache, sql);
+    if (entry != NULL && !sqlite3_stmt_busy(entry->stmt)) {
+        cache->hits = cache->hits + 1;
+        return entry->stmt;
+    }
+    cache->misses = cache->misses + 1;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+    if (entry != NULL) {
+        /* La sentencia cacheada sigue en uso (llamada reentrante): se entrega una copia no cacheada. */
+        return stmt;
+    }
+    if (cache->count == cache->capacity) {
+        int new_capacity = cache->capacity == 0 ? 16 : cache->capacity * 2;
+        StatementCacheEntry *new_entries = realloc(cache->entries, sizeof(StatementCacheEntry) * new_capacity);
+        if (new_entries == NULL) {
+            return stmt;
+        }
+        cache->entries = new_entries;
+        cache->capacity = new_capacity;
+    }
+    memset(&cache->entries[cache->count], 0, sizeof(StatementCacheEntry));
+    cache->entries[cache->count].sql = sql;
+    cache->entries[cache->count].stmt = stmt;
+    cache->count = cache->count + 1;
+    return stmt;
+}
+
+StatementCacheEntry *statement_cache_entry(StatementCache *cache, sqlite3_stmt *stmt) {
+    int index = 0;
+    while (cache != NULL && index < cache->count) {
+        if (cache->entries[index].stmt == stmt) {
+            return &cache->entries[index];
+        }
+        index = index + 1;
+    }
+    return NULL;
+}
+
+void statement_cache_release(StatementCache *cache, sqlite3_stmt *stmt) {
+    int index = 0;
+    if (stmt == NULL) {
+        return;
+    }
+    while (cache != NULL && index < cache->count) {
+        if (cache->entries[index].stmt == stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+            return;
+        }
+        index = index + 1;
+    }
+    sqlite3_finalize(stmt);
+}
+
+void statement_cache_clear(StatementCache *cache) {
+    int index = 0;
+    if (cache == NULL) {
+        return;
+    }
+    while (index < cache->count) {
+        sqlite3_finalize(cache->entries[index].stmt);
+        index = index + 1;
+    }
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+}
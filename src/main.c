@@ -1,5 +1,6 @@
 #include <gtk/gtk.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 #ifdef _WIN32
@@ -7,74 +8,12 @@
 #endif
 #include "app_context.h"
 #include "data/database.h"
+#include "data/migrations.h"
+#include "ui/kitchen_window.h"
 #include "ui/main_window.h"
+#include "core/order_service.h"
 #include "core/report_service.h"
 
-static const char MIGRATION_1[] =
-    "CREATE TABLE IF NOT EXISTS users("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "username TEXT UNIQUE NOT NULL,"\
-    "role TEXT NOT NULL,"\
-    "password_hash TEXT NOT NULL"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS menu_items("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "name TEXT NOT NULL,"\
-    "category TEXT NOT NULL,"\
-    "price REAL NOT NULL,"\
-    "cost REAL NOT NULL,"\
-    "stock INTEGER DEFAULT 0,"\
-    "photo TEXT"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS tables("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "name TEXT NOT NULL,"\
-    "status TEXT NOT NULL DEFAULT 'libre',"\
-    "waiter_id INTEGER,"\
-    "FOREIGN KEY(waiter_id) REFERENCES users(id)"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS orders("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "table_id INTEGER NOT NULL,"\
-    "waiter_id INTEGER NOT NULL,"\
-    "status TEXT NOT NULL DEFAULT 'abierta',"\
-    "created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,"\
-    "FOREIGN KEY(table_id) REFERENCES tables(id),"\
-    "FOREIGN KEY(waiter_id) REFERENCES users(id)"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS order_items("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "order_id INTEGER NOT NULL,"\
-    "menu_item_id INTEGER NOT NULL,"\
-    "status TEXT NOT NULL DEFAULT 'pedido',"\
-    "notes TEXT,"\
-    "FOREIGN KEY(order_id) REFERENCES orders(id),"\
-    "FOREIGN KEY(menu_item_id) REFERENCES menu_items(id)"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS reservations("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "table_id INTEGER NOT NULL,"\
-    "customer_name TEXT NOT NULL,"\
-    "customer_phone TEXT,"\
-    "reserved_at TEXT NOT NULL,"\
-    "notes TEXT,"\
-    "FOREIGN KEY(table_id) REFERENCES tables(id)"\
-    ");"\
-    "CREATE TABLE IF NOT EXISTS payments("\
-    "id INTEGER PRIMARY KEY AUTOINCREMENT,"\
-    "order_id INTEGER NOT NULL,"\
-    "amount REAL NOT NULL,"\
-    "method TEXT NOT NULL,"\
-    "created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,"\
-    "FOREIGN KEY(order_id) REFERENCES orders(id)"\
-    ");"\
-    "CREATE INDEX IF NOT EXISTS idx_orders_table ON orders(table_id);"\
-    "CREATE INDEX IF NOT EXISTS idx_order_items_order ON order_items(order_id);";
-
-static const Migration MIGRATIONS[] = {
-    {1, MIGRATION_1}
-};
-
 static void ensure_directory(const char *path) {
 #ifdef _WIN32
     _mkdir(path);
@@ -83,10 +22,128 @@ static void ensure_directory(const char *path) {
 #endif
 }
 
+static void log_statement_stats(AppContext *ctx) {
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    database_statement_stats(ctx->db, &hits, &misses);
+    logger_log_fields(&ctx->logger, LOG_LEVEL_INFO, "database", "Cache de sentencias", LOG_FIELDS(LOG_INT("hits", hits), LOG_INT("prepares", misses)));
+}
+
+static void log_snapshot_stats(AppContext *ctx) {
+    logger_log_fields(&ctx->logger, LOG_LEVEL_INFO, "database", "Instantáneas",
+                      LOG_FIELDS(LOG_INT("hits", ctx->snapshots.hits), LOG_INT("validations", ctx->snapshots.validations), LOG_INT("rebuilds", ctx->snapshots.rebuilds)));
+}
+
+static void dump_metrics(AppContext *ctx) {
+    metrics_gauge_set(&ctx->metrics, METRICS_GAUGE_STATUS_QUEUE, status_queue_count(&ctx->statuses));
+    if (!metrics_write_file(&ctx->metrics, ctx->config.metrics.path, metrics_format_from_string(ctx->config.metrics.format))) {
+        logger_log_fields(&ctx->logger, LOG_LEVEL_WARN, "metrics", "No se pudieron volcar las métricas", LOG_FIELDS(LOG_STR("path", ctx->config.metrics.path)));
+    }
+}
+
+/*
+ * Salida de --bootstrap, --rebuild-rollups y --export-report*: sin ventana, el
+ * trabajo cuenta como arranque, así que el reporte y el presupuesto se aplican igual.
+ */
+static int finish_without_window(AppContext *ctx, int status) {
+    startup_trace_begin_shutdown(&ctx->trace);
+    i18n_free(&ctx->catalog);
+    database_close(ctx->db);
+    metrics_clear(&ctx->metrics);
+    startup_trace_mark(&ctx->trace, "database_close");
+    if (!startup_trace_report(&ctx->trace, &ctx->logger, stdout) && status == 0) {
+        status = 2;
+    }
+    logger_close(&ctx->logger);
+    return status;
+}
+
+static gboolean on_metrics_tick(gpointer user_data) {
+    dump_metrics((AppContext *)user_data);
+    return G_SOURCE_CONTINUE;
+}
+
+typedef struct MaintenanceJob {
+    AppContext *ctx;
+    MaintenanceTask task;
+} MaintenanceJob;
+
+static bool maintenance_job_run(Database *db, gpointer job_data) {
+    MaintenanceJob *job = (MaintenanceJob *)job_data;
+    (void)db;
+    job->task = maintenance_tick(&job->ctx->maintenance, time(NULL));
+    return true;
+}
+
+static void maintenance_job_done(bool ok, gpointer job_data, gpointer user_data) {
+    MaintenanceJob *job = (MaintenanceJob *)job_data;
+    (void)ok;
+    (void)user_data;
+    job->ctx->maintenance_pending = false;
+    if (job->task != MAINTENANCE_TASK_NONE) {
+        logger_log_fields(&job->ctx->logger, LOG_LEVEL_DEBUG, "maintenance", "Tarea de mantenimiento ejecutada", LOG_FIELDS(LOG_INT("task", job->task)));
+    }
+}
+
+static gboolean on_maintenance_tick(gpointer user_data) {
+    AppContext *ctx = (AppContext *)user_data;
+    MaintenanceJob *job = NULL;
+    if (ctx->maintenance_pending) {
+        return G_SOURCE_CONTINUE;
+    }
+    /* El mantenimiento corre en el hilo escritor, dueño de ctx->db, para no bloquear la UI. */
+    job = g_new0(MaintenanceJob, 1);
+    job->ctx = ctx;
+    ctx->maintenance_pending = true;
+    dao_async_write(&ctx->async, maintenance_job_run, job, g_free, maintenance_job_done, NULL);
+    return G_SOURCE_CONTINUE;
+}
+
+static bool status_flush_job_run(Database *db, gpointer job_data) {
+    (void)db;
+    return order_service_flush_statuses((AppContext *)job_data);
+}
+
+static void status_flush_job_done(bool ok, gpointer job_data, gpointer user_data) {
+    AppContext *ctx = (AppContext *)job_data;
+    (void)ok;
+    (void)user_data;
+    ctx->status_flush_pending = false;
+}
+
+static gboolean on_status_flush_tick(gpointer user_data) {
+    AppContext *ctx = (AppContext *)user_data;
+    if (ctx->status_flush_pending || status_queue_count(&ctx->statuses) == 0) {
+        return G_SOURCE_CONTINUE;
+    }
+    ctx->status_flush_pending = true;
+    dao_async_write(&ctx->async, status_flush_job_run, ctx, NULL, status_flush_job_done, NULL);
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_first_frame(GdkFrameClock *clock, gpointer user_data) {
+    AppContext *ctx = (AppContext *)user_data;
+    g_signal_handlers_disconnect_by_func(clock, G_CALLBACK(on_first_frame), user_data);
+    startup_trace_first_frame(&ctx->trace);
+    /* Con --startup-trace la app sale sola tras el primer cuadro para poder medir el cierre. */
+    g_application_quit(g_application_get_default());
+}
+
+static void on_window_realized(GtkWidget *window, gpointer user_data) {
+    g_signal_connect(gtk_widget_get_frame_clock(window), "after-paint", G_CALLBACK(on_first_frame), user_data);
+}
+
 static void on_activate(GtkApplication *app, gpointer user_data) {
     AppContext *ctx = (AppContext *)user_data;
-    GtkWidget *window = ui_main_window_new(ctx, app);
+    GtkWidget *window = NULL;
+    startup_trace_mark(&ctx->trace, "gtk_activate");
+    window = ctx->kitchen_station != NULL ? ui_kitchen_window_new(ctx, app) : ui_main_window_new(ctx, app);
+    startup_trace_mark(&ctx->trace, "ui_main_window_new");
+    if (ctx->trace.enabled) {
+        g_signal_connect(window, "realize", G_CALLBACK(on_window_realized), ctx);
+    }
     gtk_window_present(GTK_WINDOW(window));
+    startup_trace_mark(&ctx->trace, "gtk_window_present");
 }
 
 int main(int argc, char **argv) {
@@ -94,84 +151,221 @@ int main(int argc, char **argv) {
     GtkApplication *app = NULL;
     int status = 0;
     bool bootstrap_only = false;
+    bool seed_needed = false;
+    bool rebuild_rollups = false;
     bool export_report = false;
+    bool export_range = false;
+    bool report_combined = false;
     char report_date[16];
+    char range_from[16];
+    char range_to[16];
     int arg_index = 1;
+    guint maintenance_source = 0;
+    guint status_flush_source = 0;
+    guint metrics_source = 0;
     report_date[0] = '\0';
+    range_from[0] = '\0';
+    range_to[0] = '\0';
     memset(&ctx, 0, sizeof(AppContext));
+    startup_trace_init(&ctx.trace, argc, argv);
+    metrics_init(&ctx.metrics);
     config_default(&ctx.config);
     if (!config_load(&ctx.config, "config.ini")) {
         config_default(&ctx.config);
         config_save(&ctx.config, "config.ini");
     }
+    startup_trace_mark(&ctx.trace, "config_load");
     ensure_directory("logs");
     ensure_directory(ctx.config.receipt_output_dir);
-    if (!logger_init(&ctx.logger, "logs", LOG_LEVEL_INFO)) {
+    if (!logger_init(&ctx.logger, "logs", logger_level_from_string(ctx.config.log.level, LOG_LEVEL_INFO))) {
+        return 1;
+    }
+    if (!logger_set_format(&ctx.logger, logger_format_from_string(ctx.config.log.format))) {
         return 1;
     }
-    if (database_open(&ctx.db, ctx.config.database_path, &ctx.logger) == false) {
+    if (ctx.config.log.async && !logger_start_async(&ctx.logger, ctx.config.log.buffer_records, strcmp(ctx.config.log.overflow, "block") == 0)) {
+        logger_log(&ctx.logger, LOG_LEVEL_WARN, "main", "No se pudo iniciar el log asíncrono; se escribe en línea");
+    }
+    startup_trace_mark(&ctx.trace, "logger_init");
+    if (database_open(&ctx.db, ctx.config.database_path, &ctx.config.storage, &ctx.logger) == false) {
         logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se pudo abrir la base de datos");
         logger_close(&ctx.logger);
         return 1;
     }
+    database_set_metrics(ctx.db, &ctx.metrics);
+    startup_trace_mark(&ctx.trace, "database_open");
     while (arg_index < argc) {
         if (strcmp(argv[arg_index], "--bootstrap") == 0) {
             bootstrap_only = true;
-        } else if (strncmp(argv[arg_index], "--export-report=", 15) == 0) {
-            strncpy(report_date, argv[arg_index] + 15, sizeof(report_date) - 1);
+        } else if (strncmp(argv[arg_index], "--export-report=", 16) == 0) {
+            strncpy(report_date, argv[arg_index] + 16, sizeof(report_date) - 1);
             report_date[sizeof(report_date) - 1] = '\0';
             export_report = true;
+        } else if (strncmp(argv[arg_index], "--export-report-range=", 22) == 0) {
+            const char *range = argv[arg_index] + 22;
+            const char *separator = strchr(range, ':');
+            if (separator != NULL && (size_t)(separator - range) < sizeof(range_from)) {
+                memcpy(range_from, range, (size_t)(separator - range));
+                range_from[separator - range] = '\0';
+                strncpy(range_to, separator + 1, sizeof(range_to) - 1);
+                range_to[sizeof(range_to) - 1] = '\0';
+            }
+            export_range = true;
+        } else if (strcmp(argv[arg_index], "--kitchen-display") == 0) {
+            ctx.kitchen_station = "";
+        } else if (strncmp(argv[arg_index], "--kitchen-display=", 18) == 0) {
+            ctx.kitchen_station = argv[arg_index] + 18;
+        } else if (strcmp(argv[arg_index], "--rebuild-rollups") == 0) {
+            rebuild_rollups = true;
+        } else if (strcmp(argv[arg_index], "--report-combined") == 0) {
+            report_combined = true;
         } else if (strncmp(argv[arg_index], "--locale=", 9) == 0) {
             strncpy(ctx.config.locale, argv[arg_index] + 9, sizeof(ctx.config.locale) - 1);
             ctx.config.locale[sizeof(ctx.config.locale) - 1] = '\0';
         }
         arg_index = arg_index + 1;
     }
-    if (!database_apply_migrations(ctx.db, MIGRATIONS, sizeof(MIGRATIONS) / sizeof(Migration), &ctx.logger)) {
+    /* Camino rápido: con el esquema al día (una lectura de PRAGMA user_version) no se migra. */
+    if (!database_schema_is_current(ctx.db, MIGRATIONS, MIGRATION_COUNT) && !database_apply_migrations(ctx.db, MIGRATIONS, MIGRATION_COUNT, &ctx.logger)) {
         logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "Migraciones fallidas");
         database_close(ctx.db);
         logger_close(&ctx.logger);
         return 1;
     }
-    if (!database_seed(ctx.db, &ctx.logger)) {
+    /*
+     * user_version se escribe antes de sembrar: si un primer arranque cortó el seed
+     * el esquema figura al día sin usuarios. La verificación es una sola lectura.
+     */
+    if (!database_needs_seed(ctx.db, &seed_needed)) {
+        logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se pudo verificar el seed");
+        database_close(ctx.db);
+        logger_close(&ctx.logger);
+        return 1;
+    }
+    startup_trace_mark(&ctx.trace, "migrations");
+    if ((bootstrap_only || seed_needed) && !database_seed(ctx.db, &ctx.logger)) {
         logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "Seed fallido");
         database_close(ctx.db);
         logger_close(&ctx.logger);
         return 1;
     }
+    startup_trace_mark(&ctx.trace, "seed");
     char locale_path[64];
     snprintf(locale_path, sizeof(locale_path), "po/%s.txt", ctx.config.locale);
     if (!i18n_load(&ctx.catalog, locale_path)) {
         i18n_load(&ctx.catalog, "po/es.txt");
     }
+    startup_trace_mark(&ctx.trace, "i18n_load");
+    if (rebuild_rollups) {
+        bool rebuilt = report_service_rebuild_rollups(&ctx);
+        startup_trace_mark(&ctx.trace, "rebuild_rollups");
+        return finish_without_window(&ctx, rebuilt ? 0 : 1);
+    }
     if (bootstrap_only) {
-        i18n_free(&ctx.catalog);
-        database_close(ctx.db);
-        logger_close(&ctx.logger);
-        return 0;
+        return finish_without_window(&ctx, 0);
     }
     if (export_report) {
         char csv_path[256];
         snprintf(csv_path, sizeof(csv_path), "reports/ventas_%s.csv", report_date);
         ensure_directory("reports");
         if (!report_service_export_daily(&ctx, report_date, csv_path)) {
-            logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se exportó reporte");
-            i18n_free(&ctx.catalog);
-            database_close(ctx.db);
-            logger_close(&ctx.logger);
-            return 1;
+            logger_log_fields(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se exportó reporte", LOG_FIELDS(LOG_STR("date", report_date)));
+            startup_trace_mark(&ctx.trace, "export_report");
+            return finish_without_window(&ctx, 1);
+        }
+        startup_trace_mark(&ctx.trace, "export_report");
+        log_statement_stats(&ctx);
+        return finish_without_window(&ctx, 0);
+    }
+    if (export_range) {
+        ReportRangeStats stats;
+        bool exported;
+        ensure_directory("reports");
+        exported = report_service_export_range(&ctx, range_from, range_to, report_combined, "reports", &stats);
+        startup_trace_mark(&ctx.trace, "export_report_range");
+        if (exported) {
+            printf("Reporte %s..%s: %d días, %ld filas, %d hilos, %.3f s (%.0f filas/s)\n",
+                   range_from, range_to, stats.days, stats.rows, stats.workers, stats.elapsed_s,
+                   stats.elapsed_s > 0.0 ? (double)stats.rows / stats.elapsed_s : 0.0);
+        } else {
+            logger_log_fields(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se exportó el reporte por rango", LOG_FIELDS(LOG_STR("from", range_from), LOG_STR("to", range_to)));
         }
+        return finish_without_window(&ctx, exported ? 0 : 1);
+    }
+    status_queue_init(&ctx.statuses);
+    snapshot_cache_init(&ctx.snapshots);
+    reservation_book_init(&ctx.reservations, ctx.config.reservation_seating_min);
+    /* Después de sembrar: el arranque no debe generar avisos de cambios. */
+    change_bus_init(&ctx.changes);
+    change_bus_attach(&ctx.changes, ctx.db);
+    if (!dao_async_open(&ctx.async, ctx.db, ctx.config.database_path, &ctx.config.storage, ctx.config.storage.read_connections, &ctx.logger)) {
+        logger_log(&ctx.logger, LOG_LEVEL_ERROR, "main", "No se pudieron abrir las conexiones de lectura");
+        status_queue_clear(&ctx.statuses);
+        snapshot_cache_clear(&ctx.snapshots);
+        reservation_book_clear(&ctx.reservations);
+        change_bus_detach(&ctx.changes, ctx.db);
+        change_bus_clear(&ctx.changes);
         i18n_free(&ctx.catalog);
         database_close(ctx.db);
         logger_close(&ctx.logger);
-        return 0;
+        return 1;
     }
+    maintenance_init(&ctx.maintenance, ctx.db, &ctx.logger);
+    if (ctx.config.storage.maintenance_interval_s > 0) {
+        maintenance_source = g_timeout_add_seconds((guint)ctx.config.storage.maintenance_interval_s, on_maintenance_tick, &ctx);
+    }
+    if (ctx.config.status_queue.max_delay_ms > 0) {
+        /* El intervalo nunca supera la cota de durabilidad configurada. */
+        int interval = ctx.config.status_queue.flush_interval_ms;
+        if (interval <= 0 || interval > ctx.config.status_queue.max_delay_ms) {
+            interval = ctx.config.status_queue.max_delay_ms;
+        }
+        status_flush_source = g_timeout_add((guint)interval, on_status_flush_tick, &ctx);
+    }
+    if (ctx.config.metrics.dump_interval_s > 0) {
+        metrics_source = g_timeout_add_seconds((guint)ctx.config.metrics.dump_interval_s, on_metrics_tick, &ctx);
+    }
+    startup_trace_mark(&ctx.trace, "dao_async_open");
     app = gtk_application_new("com.prompt.maestro", G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(app, "activate", G_CALLBACK(on_activate), &ctx);
-    status = g_application_run(G_APPLICATION(app), argc, argv);
+    startup_trace_mark(&ctx.trace, "gtk_application_new");
+    /* Las opciones propias ya se leyeron; GApplication rechazaría las que no conoce. */
+    status = g_application_run(G_APPLICATION(app), 1, argv);
+    startup_trace_begin_shutdown(&ctx.trace);
     g_object_unref(app);
+    startup_trace_mark(&ctx.trace, "gtk_teardown");
+    if (maintenance_source != 0) {
+        g_source_remove(maintenance_source);
+    }
+    if (status_flush_source != 0) {
+        g_source_remove(status_flush_source);
+    }
+    if (metrics_source != 0) {
+        g_source_remove(metrics_source);
+    }
+    dao_async_close(&ctx.async);
+    startup_trace_mark(&ctx.trace, "dao_async_close");
+    change_bus_detach(&ctx.changes, ctx.db);
+    /* El escritor ya terminó: lo que quede en la cola se escribe desde este hilo antes de cerrar. */
+    order_service_flush_statuses(&ctx);
+    status_queue_clear(&ctx.statuses);
+    startup_trace_mark(&ctx.trace, "status_flush");
+    maintenance_finish(&ctx.maintenance);
+    if (ctx.config.metrics.dump_interval_s > 0) {
+        dump_metrics(&ctx);
+    }
+    log_statement_stats(&ctx);
+    log_snapshot_stats(&ctx);
+    snapshot_cache_clear(&ctx.snapshots);
+    reservation_book_clear(&ctx.reservations);
+    change_bus_clear(&ctx.changes);
     i18n_free(&ctx.catalog);
     database_close(ctx.db);
+    metrics_clear(&ctx.metrics);
+    startup_trace_mark(&ctx.trace, "database_close");
+    if (!startup_trace_report(&ctx.trace, &ctx.logger, stdout) && status == 0) {
+        status = 2;
+    }
     logger_close(&ctx.logger);
     return status;
 }
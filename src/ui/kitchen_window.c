@@ -0,0 +1,252 @@
+#include "ui/kitchen_window.h"
+#include "core/kitchen_service.h"
+#include "core/order_service.h"
+#include "ui/row_model.h"
+#include <string.h>
+
+typedef struct KitchenTicket {
+    int id;
+    int table_id;
+    bool active;
+    bool bumping;
+    char *item_name;
+    char *notes;
+    char ordered_at[8];
+    char status[16];
+} KitchenTicket;
+
+typedef struct {
+    AppContext *ctx;
+    GtkWidget *window;
+    GtkWidget *status_label;
+    UiRowModel *model;
+    GHashTable *tickets;
+    KitchenFeed feed;
+    bool poll_pending;
+    guint poll_source;
+} KitchenState;
+
+/* El trabajo lleva su propia copia del estado del sondeo: no toca KitchenState desde el hilo lector. */
+typedef struct KitchenPollJob {
+    KitchenState *state;
+    KitchenFeed feed;
+    bool changed;
+    GArray *tickets;
+} KitchenPollJob;
+
+typedef struct KitchenBumpJob {
+    KitchenState *state;
+    AppContext *ctx;
+    int order_item_id;
+    char status[16];
+} KitchenBumpJob;
+
+static void kitchen_ticket_clear(gpointer data) {
+    KitchenTicket *ticket = (KitchenTicket *)data;
+    g_free(ticket->item_name);
+    g_free(ticket->notes);
+}
+
+static void kitchen_ticket_free(gpointer data) {
+    kitchen_ticket_clear(data);
+    g_free(data);
+}
+
+static void kitchen_poll_job_free(gpointer data) {
+    KitchenPollJob *job = (KitchenPollJob *)data;
+    g_array_unref(job->tickets);
+    g_free(job);
+}
+
+static void kitchen_status(KitchenState *state) {
+    char text[128];
+    snprintf(text, sizeof(text), "%s · %u pendientes", state->feed.station[0] != '\0' ? state->feed.station : "Todas las estaciones",
+             g_hash_table_size(state->tickets));
+    gtk_label_set_text(GTK_LABEL(state->status_label), text);
+}
+
+/* Los estados que esperan en la cola de escritura se muestran sobre lo leído de la base. */
+static void kitchen_render(KitchenState *state, KitchenTicket *ticket) {
+    UiTextRow row;
+    char pending[16];
+    if (order_service_pending_status(state->ctx, ticket->id, pending, sizeof(pending))) {
+        g_strlcpy(ticket->status, pending, sizeof(ticket->status));
+    }
+    if (strcmp(ticket->status, "servido") == 0 || strcmp(ticket->status, "anulado") == 0) {
+        ui_row_model_remove(state->model, ticket->id);
+        g_hash_table_remove(state->tickets, GINT_TO_POINTER(ticket->id));
+        return;
+    }
+    row.id = ticket->id;
+    row.primary = g_strdup_printf("Mesa %d · %s", ticket->table_id, ticket->item_name);
+    row.secondary = g_strdup_printf("#%d · %s · desde %s", ticket->id, ticket->status, ticket->ordered_at);
+    row.extra = ticket->notes[0] != '\0' ? g_strdup(ticket->notes) : NULL;
+    ui_row_model_upsert(state->model, &row, false);
+}
+
+static bool kitchen_visit_ticket(const KitchenTicketView *row, void *user_data) {
+    KitchenPollJob *job = (KitchenPollJob *)user_data;
+    KitchenTicket ticket;
+    memset(&ticket, 0, sizeof(ticket));
+    ticket.id = row->id;
+    ticket.table_id = row->table_id;
+    ticket.active = row->active;
+    ticket.item_name = g_strdup(row->item_name);
+    ticket.notes = g_strdup(row->notes);
+    g_strlcpy(ticket.ordered_at, row->ordered_at, sizeof(ticket.ordered_at));
+    g_strlcpy(ticket.status, row->status, sizeof(ticket.status));
+    g_array_append_val(job->tickets, ticket);
+    return true;
+}
+
+static bool kitchen_job_poll(Database *db, gpointer data) {
+    KitchenPollJob *job = (KitchenPollJob *)data;
+    return kitchen_service_poll(db, &job->feed, kitchen_visit_ticket, job, &job->changed);
+}
+
+static void kitchen_on_polled(bool ok, gpointer data, gpointer user_data) {
+    KitchenState *state = (KitchenState *)user_data;
+    KitchenPollJob *job = (KitchenPollJob *)data;
+    guint index = 0;
+    state->poll_pending = false;
+    if (!ok) {
+        gtk_label_set_text(GTK_LABEL(state->status_label), "No se pudo leer la base; reintentando");
+        return;
+    }
+    state->feed = job->feed;
+    if (!job->changed) {
+        return;
+    }
+    /* Solo llegan las filas que cambiaron: se reemplazan, agregan o quitan de a una. */
+    while (index < job->tickets->len) {
+        KitchenTicket *row = &g_array_index(job->tickets, KitchenTicket, index);
+        if (!row->active) {
+            ui_row_model_remove(state->model, row->id);
+            g_hash_table_remove(state->tickets, GINT_TO_POINTER(row->id));
+        } else {
+            KitchenTicket *previous = g_hash_table_lookup(state->tickets, GINT_TO_POINTER(row->id));
+            KitchenTicket *ticket = g_new(KitchenTicket, 1);
+            *ticket = *row;
+            ticket->bumping = previous != NULL && previous->bumping;
+            row->item_name = NULL;
+            row->notes = NULL;
+            g_hash_table_replace(state->tickets, GINT_TO_POINTER(ticket->id), ticket);
+            kitchen_render(state, ticket);
+        }
+        index = index + 1;
+    }
+    kitchen_status(state);
+}
+
+static gboolean kitchen_on_poll_tick(gpointer user_data) {
+    KitchenState *state = (KitchenState *)user_data;
+    KitchenPollJob *job = NULL;
+    if (state->poll_pending) {
+        return G_SOURCE_CONTINUE;
+    }
+    job = g_new0(KitchenPollJob, 1);
+    job->state = state;
+    job->feed = state->feed;
+    job->tickets = g_array_new(FALSE, TRUE, sizeof(KitchenTicket));
+    g_array_set_clear_func(job->tickets, kitchen_ticket_clear);
+    state->poll_pending = true;
+    dao_async_read(&state->ctx->async, kitchen_job_poll, job, kitchen_poll_job_free, kitchen_on_polled, state);
+    return G_SOURCE_CONTINUE;
+}
+
+static bool kitchen_job_bump(Database *db, gpointer data) {
+    KitchenBumpJob *job = (KitchenBumpJob *)data;
+    (void)db;
+    return order_service_update_status(job->ctx, job->order_item_id, job->status);
+}
+
+static void kitchen_on_bumped(bool ok, gpointer data, gpointer user_data) {
+    KitchenState *state = (KitchenState *)user_data;
+    KitchenBumpJob *job = (KitchenBumpJob *)data;
+    KitchenTicket *ticket = g_hash_table_lookup(state->tickets, GINT_TO_POINTER(job->order_item_id));
+    if (ticket == NULL) {
+        return;
+    }
+    ticket->bumping = false;
+    if (!ok) {
+        gtk_label_set_text(GTK_LABEL(state->status_label), "No se actualizó el estado");
+        return;
+    }
+    /* El cambio puede estar todavía en la cola: se muestra ya, sin esperar al próximo sondeo. */
+    g_strlcpy(ticket->status, job->status, sizeof(ticket->status));
+    kitchen_render(state, ticket);
+    kitchen_status(state);
+}
+
+/* Un toque avanza el ticket al estado siguiente. */
+static void kitchen_on_ticket_activated(GtkGridView *grid_view, guint position, KitchenState *state) {
+    const UiTextRow *row = ui_row_model_get_row(state->model, position);
+    KitchenTicket *ticket = NULL;
+    KitchenBumpJob *job = NULL;
+    const char *next = NULL;
+    (void)grid_view;
+    if (row == NULL) {
+        return;
+    }
+    ticket = g_hash_table_lookup(state->tickets, GINT_TO_POINTER(row->id));
+    if (ticket == NULL || ticket->bumping) {
+        return;
+    }
+    next = kitchen_service_next_status(ticket->status);
+    if (next == NULL) {
+        return;
+    }
+    job = g_new0(KitchenBumpJob, 1);
+    job->state = state;
+    job->ctx = state->ctx;
+    job->order_item_id = ticket->id;
+    g_strlcpy(job->status, next, sizeof(job->status));
+    ticket->bumping = true;
+    dao_async_write(&state->ctx->async, kitchen_job_bump, job, g_free, kitchen_on_bumped, state);
+}
+
+static void kitchen_on_destroy(GtkWidget *window, KitchenState *state) {
+    (void)window;
+    dao_async_detach(&state->ctx->async);
+    if (state->poll_source != 0) {
+        g_source_remove(state->poll_source);
+        state->poll_source = 0;
+    }
+    g_clear_pointer(&state->tickets, g_hash_table_destroy);
+    g_clear_object(&state->model);
+}
+
+GtkWidget *ui_kitchen_window_new(AppContext *ctx, GtkApplication *app) {
+    KitchenState *state = g_new0(KitchenState, 1);
+    GtkWidget *window = gtk_application_window_new(app);
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
+    GtkWidget *scrolled = gtk_scrolled_window_new();
+    GtkWidget *grid = NULL;
+    char title[96];
+    int poll_ms = ctx->config.kitchen_poll_ms > 0 ? ctx->config.kitchen_poll_ms : 1000;
+    state->ctx = ctx;
+    state->window = window;
+    state->model = ui_row_model_new();
+    state->tickets = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, kitchen_ticket_free);
+    state->status_label = gtk_label_new("Cargando…");
+    kitchen_feed_init(&state->feed, ctx->kitchen_station);
+    grid = gtk_grid_view_new(GTK_SELECTION_MODEL(gtk_no_selection_new(G_LIST_MODEL(g_object_ref(state->model)))), ui_row_factory_new(GTK_ORIENTATION_VERTICAL));
+    gtk_grid_view_set_min_columns(GTK_GRID_VIEW(grid), 2);
+    gtk_grid_view_set_max_columns(GTK_GRID_VIEW(grid), 6);
+    gtk_grid_view_set_single_click_activate(GTK_GRID_VIEW(grid), TRUE);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), grid);
+    gtk_widget_set_vexpand(scrolled, TRUE);
+    gtk_box_append(GTK_BOX(box), state->status_label);
+    gtk_box_append(GTK_BOX(box), scrolled);
+    snprintf(title, sizeof(title), "Cocina · %s", state->feed.station[0] != '\0' ? state->feed.station : "todas las estaciones");
+    gtk_window_set_title(GTK_WINDOW(window), title);
+    gtk_window_set_default_size(GTK_WINDOW(window), 1024, 600);
+    gtk_window_set_child(GTK_WINDOW(window), box);
+    g_signal_connect(grid, "activate", G_CALLBACK(kitchen_on_ticket_activated), state);
+    g_object_set_data_full(G_OBJECT(window), "kitchen-state", state, g_free);
+    g_signal_connect(window, "destroy", G_CALLBACK(kitchen_on_destroy), state);
+    kitchen_on_poll_tick(state);
+    state->poll_source = g_timeout_add((guint)poll_ms, kitchen_on_poll_tick, state);
+    return window;
+}
@@ -2,7 +2,10 @@
 #include "core/auth_service.h"
 #include "core/order_service.h"
 #include "core/report_service.h"
+#include "core/reservation_service.h"
 #include "data/dao.h"
+#include "data/snapshot_cache.h"
+#include "ui/row_model.h"
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -20,25 +23,84 @@ typedef struct {
     GtkWidget *content_panel;
     GtkWidget *status_label;
     GtkWidget *tables_list;
+    UiRowModel *tables_model;
     GtkWidget *table_selector;
     GtkWidget *orders_list;
     GtkWidget *order_items_list;
+    UiRowModel *orders_model;
+    UiRowModel *order_items_model;
     GtkWidget *menu_selector;
     GtkWidget *notes_entry;
+    GtkWidget *quantity_spin;
+    GtkWidget *cart_list;
     GtkWidget *order_status_label;
     GtkWidget *totals_label;
     GtkWidget *status_combo;
     GtkWidget *item_id_entry;
     GtkWidget *reservations_list;
+    UiRowModel *reservations_model;
     GtkWidget *reservation_table_selector;
     GtkWidget *reservation_name_entry;
     GtkWidget *reservation_phone_entry;
     GtkWidget *reservation_datetime_entry;
     GtkWidget *reservation_notes_entry;
+    GtkWidget *reservation_party_spin;
+    GtkWidget *sales_label;
+    GtkStackPage *diagnostics_page;
+    GtkWidget *metrics_label;
+    UiRowModel *metrics_model;
     User current_user;
     int selected_order_id;
+    GArray *cart;
+    guint change_subscription;
+    unsigned int tables_generation;
+    unsigned int menu_generation;
+    int menu_version;
+    bool menu_loaded;
+    unsigned int orders_generation;
+    unsigned int items_generation;
+    unsigned int reservations_generation;
+    ReservationKey reservations_after;
+    bool reservations_started;
+    bool reservations_loading;
+    bool reservations_exhausted;
 } UiState;
 
+typedef struct UiListJob {
+    UiState *state;
+    unsigned int generation;
+    int order_id;
+    int known_version;
+    int snapshot_version;
+    bool unchanged;
+    GArray *rows;
+} UiListJob;
+
+typedef struct UiWriteJob {
+    UiState *state;
+    int table_id;
+    int user_id;
+    int order_id;
+    int menu_item_id;
+    int order_item_id;
+    int reservation_id;
+    char *text;
+} UiWriteJob;
+
+/* Ítems pendientes de la comanda: se envían juntos en una sola transacción. */
+typedef struct UiCartEntry {
+    int menu_item_id;
+    int quantity;
+    char *notes;
+    char *label;
+} UiCartEntry;
+
+typedef struct UiCartJob {
+    UiState *state;
+    int order_id;
+    GArray *entries;
+} UiCartJob;
+
 static void ui_clear_list_box(GtkListBox *list_box) {
     GtkWidget *child = gtk_widget_get_first_child(GTK_WIDGET(list_box));
     while (child != NULL) {
@@ -52,109 +114,429 @@ static void ui_status(UiState *state, const char *message) {
     gtk_label_set_text(GTK_LABEL(state->status_label), message);
 }
 
-static void ui_bind_order_buttons(UiState *state);
 static void ui_refresh_reservations(UiState *state);
 
-static void ui_refresh_tables(UiState *state) {
-    TableStatus *tables = NULL;
-    int count = 0;
+static UiListJob *ui_list_job_new(UiState *state, unsigned int generation) {
+    UiListJob *job = g_new0(UiListJob, 1);
+    job->state = state;
+    job->generation = generation;
+    job->rows = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    g_array_set_clear_func(job->rows, ui_text_row_clear);
+    return job;
+}
+
+static void ui_list_job_free(gpointer data) {
+    UiListJob *job = (UiListJob *)data;
+    g_array_unref(job->rows);
+    g_free(job);
+}
+
+static void ui_list_job_append(UiListJob *job, int id, char *primary, char *secondary, char *extra) {
+    UiTextRow row;
+    row.id = id;
+    row.primary = primary;
+    row.secondary = secondary;
+    row.extra = extra;
+    g_array_append_val(job->rows, row);
+}
+
+static UiWriteJob *ui_write_job_new(UiState *state) {
+    UiWriteJob *job = g_new0(UiWriteJob, 1);
+    job->state = state;
+    return job;
+}
+
+static void ui_write_job_free(gpointer data) {
+    UiWriteJob *job = (UiWriteJob *)data;
+    g_free(job->text);
+    g_free(job);
+}
+
+/* Mesas y mozos salen de las instantáneas en memoria; solo se relee SQLite si alguien escribió. */
+static bool ui_job_list_tables(Database *db, gpointer data) {
+    UiListJob *job = (UiListJob *)data;
+    Snapshot *tables = snapshot_cache_acquire(&job->state->ctx->snapshots, db, SNAPSHOT_TABLES);
+    Snapshot *users = NULL;
     int index = 0;
-    ui_clear_list_box(GTK_LIST_BOX(state->tables_list));
+    if (tables == NULL) {
+        return false;
+    }
+    users = snapshot_cache_acquire(&job->state->ctx->snapshots, db, SNAPSHOT_USERS);
+    while (index < tables->count) {
+        const TableStatus *table = (const TableStatus *)tables->rows + index;
+        const User *waiter = snapshot_user(users, table->waiter_id);
+        char *status = waiter != NULL ? g_strdup_printf("%s · %s", table->status, waiter->username) : g_strdup(table->status);
+        ui_list_job_append(job, table->id, g_strdup(table->name), status, g_strdup_printf("%d personas", table->capacity));
+        index = index + 1;
+    }
+    snapshot_release(users);
+    snapshot_release(tables);
+    return true;
+}
+
+static void ui_on_tables_loaded(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiListJob *job = (UiListJob *)data;
+    guint index = 0;
+    if (job->generation != state->tables_generation) {
+        return;
+    }
     gtk_combo_box_text_remove_all(GTK_COMBO_BOX_TEXT(state->table_selector));
     if (state->reservation_table_selector != NULL) {
         gtk_combo_box_text_remove_all(GTK_COMBO_BOX_TEXT(state->reservation_table_selector));
     }
-    if (!dao_list_tables(state->ctx->db, &tables, &count)) {
+    if (!ok) {
+        ui_row_model_clear(state->tables_model);
         ui_status(state, "No se pudieron cargar las mesas");
         return;
     }
-    while (index < count) {
+    while (index < job->rows->len) {
+        UiTextRow *table = &g_array_index(job->rows, UiTextRow, index);
         char label_text[128];
         char id_buffer[32];
-        GtkWidget *row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
-        GtkWidget *name_label = gtk_label_new(tables[index].name);
-        GtkWidget *status_label = gtk_label_new(tables[index].status);
-        snprintf(label_text, sizeof(label_text), "%s (%s)", tables[index].name, tables[index].status);
-        snprintf(id_buffer, sizeof(id_buffer), "%d", tables[index].id);
+        snprintf(label_text, sizeof(label_text), "%s (%s)", table->primary, table->secondary);
+        snprintf(id_buffer, sizeof(id_buffer), "%d", table->id);
         gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->table_selector), id_buffer, label_text);
         if (state->reservation_table_selector != NULL) {
             gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->reservation_table_selector), id_buffer, label_text);
         }
-        gtk_box_append(GTK_BOX(row), name_label);
-        gtk_box_append(GTK_BOX(row), status_label);
-        gtk_list_box_append(GTK_LIST_BOX(state->tables_list), row);
         index = index + 1;
     }
-    dao_free_tables(tables);
+    ui_row_model_set_rows(state->tables_model, job->rows);
 }
 
-static void ui_refresh_menu(UiState *state) {
-    MenuItem *items = NULL;
-    int count = 0;
+static void ui_refresh_tables(UiState *state) {
+    state->tables_generation = state->tables_generation + 1;
+    dao_async_read(&state->ctx->async, ui_job_list_tables, ui_list_job_new(state, state->tables_generation), ui_list_job_free, ui_on_tables_loaded, state);
+}
+
+static bool ui_job_list_menu_items(Database *db, gpointer data) {
+    UiListJob *job = (UiListJob *)data;
+    Snapshot *menu = snapshot_cache_acquire(&job->state->ctx->snapshots, db, SNAPSHOT_MENU_ITEMS);
     int index = 0;
+    if (menu == NULL) {
+        return false;
+    }
+    job->snapshot_version = menu->version;
+    /* El combo ya muestra esta versión del menú: no hace falta rearmarlo. */
+    job->unchanged = job->known_version == menu->version;
+    while (!job->unchanged && index < menu->count) {
+        const MenuItem *item = (const MenuItem *)menu->rows + index;
+        ui_list_job_append(job, item->id, g_strdup_printf("%s - %.2f", item->name, item->price), NULL, NULL);
+        index = index + 1;
+    }
+    snapshot_release(menu);
+    return true;
+}
+
+static void ui_on_menu_loaded(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiListJob *job = (UiListJob *)data;
+    guint index = 0;
+    if (job->generation != state->menu_generation || (ok && job->unchanged)) {
+        return;
+    }
     gtk_combo_box_text_remove_all(GTK_COMBO_BOX_TEXT(state->menu_selector));
-    if (!dao_list_menu_items(state->ctx->db, &items, &count)) {
+    state->menu_loaded = ok;
+    if (!ok) {
         ui_status(state, "Error cargando menú");
         return;
     }
-    while (index < count) {
-        char label_text[256];
+    state->menu_version = job->snapshot_version;
+    while (index < job->rows->len) {
+        UiTextRow *item = &g_array_index(job->rows, UiTextRow, index);
         char id_buffer[32];
-        snprintf(label_text, sizeof(label_text), "%s - %.2f", items[index].name, items[index].price);
-        snprintf(id_buffer, sizeof(id_buffer), "%d", items[index].id);
-        gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->menu_selector), id_buffer, label_text);
+        snprintf(id_buffer, sizeof(id_buffer), "%d", item->id);
+        gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->menu_selector), id_buffer, item->primary);
         index = index + 1;
     }
-    dao_free_menu_items(items);
 }
 
-static void ui_refresh_orders(UiState *state) {
-    int *order_ids = NULL;
-    int count = 0;
-    int index = 0;
-    ui_clear_list_box(GTK_LIST_BOX(state->orders_list));
-    if (!dao_list_open_orders(state->ctx->db, &order_ids, &count)) {
+static void ui_refresh_menu(UiState *state) {
+    UiListJob *job = NULL;
+    state->menu_generation = state->menu_generation + 1;
+    job = ui_list_job_new(state, state->menu_generation);
+    job->known_version = state->menu_loaded ? state->menu_version : G_MININT;
+    dao_async_read(&state->ctx->async, ui_job_list_menu_items, job, ui_list_job_free, ui_on_menu_loaded, state);
+}
+
+static char *ui_order_label(const OrderSummaryView *row) {
+    return g_strdup_printf("Comanda #%d · %d ítems · %.2f", row->id, row->item_count, row->subtotal);
+}
+
+static bool ui_visit_open_order(const OrderSummaryView *row, void *user_data) {
+    ui_list_job_append((UiListJob *)user_data, row->id, ui_order_label(row), NULL, NULL);
+    return true;
+}
+
+static bool ui_job_list_open_orders(Database *db, gpointer data) {
+    return dao_visit_open_order_summaries(db, ui_visit_open_order, data);
+}
+
+static void ui_on_orders_loaded(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiListJob *job = (UiListJob *)data;
+    if (job->generation != state->orders_generation) {
+        return;
+    }
+    if (!ok) {
+        ui_row_model_clear(state->orders_model);
         ui_status(state, "No se pudieron cargar las comandas");
         return;
     }
-    while (index < count) {
-        char label_text[64];
-        GtkWidget *button;
-        snprintf(label_text, sizeof(label_text), "Comanda #%d", order_ids[index]);
-        button = gtk_button_new_with_label(label_text);
-        g_object_set_data(G_OBJECT(button), "order-id", GINT_TO_POINTER(order_ids[index]));
-        gtk_list_box_append(GTK_LIST_BOX(state->orders_list), button);
-        index = index + 1;
+    ui_row_model_set_rows(state->orders_model, job->rows);
+}
+
+static void ui_refresh_orders(UiState *state) {
+    state->orders_generation = state->orders_generation + 1;
+    dao_async_read(&state->ctx->async, ui_job_list_open_orders, ui_list_job_new(state, state->orders_generation), ui_list_job_free, ui_on_orders_loaded, state);
+}
+
+static char *ui_order_item_label(UiState *state, const OrderItemView *row) {
+    char pending[16];
+    /* Los cambios de cocina que todavía esperan en la cola se muestran sobre lo leído de la base. */
+    const char *status = order_service_pending_status(state->ctx, row->id, pending, sizeof(pending)) ? pending : row->status;
+    return g_strdup_printf("#%d %.160s (%.40s)", row->id, row->notes, status);
+}
+
+static bool ui_visit_order_item(const OrderItemView *row, void *user_data) {
+    UiListJob *job = (UiListJob *)user_data;
+    ui_list_job_append(job, row->id, ui_order_item_label(job->state, row), NULL, NULL);
+    return true;
+}
+
+static bool ui_job_list_order_items(Database *db, gpointer data) {
+    UiListJob *job = (UiListJob *)data;
+    return dao_visit_order_items(db, job->order_id, ui_visit_order_item, job);
+}
+
+static void ui_on_order_items_loaded(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiListJob *job = (UiListJob *)data;
+    if (job->generation != state->items_generation) {
+        return;
     }
-    dao_free_order_ids(order_ids);
-    ui_bind_order_buttons(state);
+    if (!ok) {
+        ui_row_model_clear(state->order_items_model);
+        ui_status(state, "Error al cargar ítems");
+        return;
+    }
+    ui_row_model_set_rows(state->order_items_model, job->rows);
 }
 
 static void ui_refresh_order_items(UiState *state) {
-    OrderItem *items = NULL;
-    int count = 0;
-    int index = 0;
+    UiListJob *job = NULL;
     char label_text[128];
-    ui_clear_list_box(GTK_LIST_BOX(state->order_items_list));
+    state->items_generation = state->items_generation + 1;
     if (state->selected_order_id <= 0) {
+        ui_row_model_clear(state->order_items_model);
         gtk_label_set_text(GTK_LABEL(state->order_status_label), "Sin comanda seleccionada");
         return;
     }
     snprintf(label_text, sizeof(label_text), "Comanda #%d", state->selected_order_id);
     gtk_label_set_text(GTK_LABEL(state->order_status_label), label_text);
-    if (!dao_list_order_items(state->ctx->db, state->selected_order_id, &items, &count)) {
-        ui_status(state, "Error al cargar ítems");
+    job = ui_list_job_new(state, state->items_generation);
+    job->order_id = state->selected_order_id;
+    dao_async_read(&state->ctx->async, ui_job_list_order_items, job, ui_list_job_free, ui_on_order_items_loaded, state);
+}
+
+/*
+ * Filas de comandas e ítems tocadas por un commit. Se releen una por una y se
+ * reemplazan en su lugar; primary NULL significa que la fila ya no corresponde
+ * (comanda cerrada o ítem borrado) y se quita de la lista.
+ */
+typedef struct UiDeltaJob {
+    UiState *state;
+    unsigned int orders_generation;
+    unsigned int items_generation;
+    int order_id;
+    GArray *order_ids;
+    GArray *item_ids;
+    GArray *orders;
+    GArray *items;
+} UiDeltaJob;
+
+static UiDeltaJob *ui_delta_job_new(UiState *state) {
+    UiDeltaJob *job = g_new0(UiDeltaJob, 1);
+    job->state = state;
+    job->order_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    job->item_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    job->orders = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    job->items = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    g_array_set_clear_func(job->orders, ui_text_row_clear);
+    g_array_set_clear_func(job->items, ui_text_row_clear);
+    return job;
+}
+
+static void ui_delta_job_free(gpointer data) {
+    UiDeltaJob *job = (UiDeltaJob *)data;
+    g_array_unref(job->order_ids);
+    g_array_unref(job->item_ids);
+    g_array_unref(job->orders);
+    g_array_unref(job->items);
+    g_free(job);
+}
+
+static void ui_delta_job_add_id(GArray *ids, int id) {
+    guint index = 0;
+    while (index < ids->len) {
+        if (g_array_index(ids, int, index) == id) {
+            return;
+        }
+        index = index + 1;
+    }
+    g_array_append_val(ids, id);
+}
+
+static void ui_delta_job_append(GArray *rows, int id, char *primary) {
+    UiTextRow row;
+    memset(&row, 0, sizeof(row));
+    row.id = id;
+    row.primary = primary;
+    g_array_append_val(rows, row);
+}
+
+static bool ui_visit_delta_item(const OrderItemView *row, void *user_data) {
+    UiDeltaJob *job = (UiDeltaJob *)user_data;
+    if (row->order_id == job->order_id) {
+        ui_delta_job_append(job->items, row->id, ui_order_item_label(job->state, row));
+    }
+    return true;
+}
+
+static bool ui_job_refresh_rows(Database *db, gpointer data) {
+    UiDeltaJob *job = (UiDeltaJob *)data;
+    guint index = 0;
+    while (index < job->order_ids->len) {
+        int order_id = g_array_index(job->order_ids, int, index);
+        OrderSummaryView summary;
+        bool found = false;
+        if (!dao_get_open_order_summary(db, order_id, &summary, &found)) {
+            return false;
+        }
+        ui_delta_job_append(job->orders, order_id, found ? ui_order_label(&summary) : NULL);
+        index = index + 1;
+    }
+    index = 0;
+    while (index < job->item_ids->len) {
+        int item_id = g_array_index(job->item_ids, int, index);
+        guint before = job->items->len;
+        if (!dao_visit_order_item(db, item_id, ui_visit_delta_item, job)) {
+            return false;
+        }
+        if (job->items->len == before) {
+            ui_delta_job_append(job->items, item_id, NULL);
+        }
+        index = index + 1;
+    }
+    return true;
+}
+
+static void ui_on_rows_refreshed(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiDeltaJob *job = (UiDeltaJob *)data;
+    guint index = 0;
+    if (!ok) {
+        ui_status(state, "No se pudieron actualizar las comandas");
         return;
     }
+    /* Una recarga completa posterior ya trae estas filas; se descarta el delta. */
+    if (job->orders_generation == state->orders_generation) {
+        while (index < job->orders->len) {
+            UiTextRow *order = &g_array_index(job->orders, UiTextRow, index);
+            if (order->primary == NULL) {
+                ui_row_model_remove(state->orders_model, order->id);
+            } else {
+                /* Las comandas se listan de la más nueva a la más vieja. */
+                ui_row_model_upsert(state->orders_model, order, true);
+            }
+            index = index + 1;
+        }
+    }
+    index = 0;
+    if (job->items_generation == state->items_generation && job->order_id == state->selected_order_id) {
+        while (index < job->items->len) {
+            UiTextRow *item = &g_array_index(job->items, UiTextRow, index);
+            if (item->primary == NULL) {
+                ui_row_model_remove(state->order_items_model, item->id);
+            } else {
+                ui_row_model_upsert(state->order_items_model, item, false);
+            }
+            index = index + 1;
+        }
+    }
+}
+
+static void ui_submit_delta(UiState *state, UiDeltaJob *job) {
+    if (job->order_ids->len == 0 && job->item_ids->len == 0) {
+        ui_delta_job_free(job);
+        return;
+    }
+    job->orders_generation = state->orders_generation;
+    job->items_generation = state->items_generation;
+    job->order_id = state->selected_order_id;
+    dao_async_read(&state->ctx->async, ui_job_refresh_rows, job, ui_delta_job_free, ui_on_rows_refreshed, state);
+}
+
+static void ui_refresh_order_item_row(UiState *state, int item_id) {
+    UiDeltaJob *job = ui_delta_job_new(state);
+    if (state->selected_order_id > 0) {
+        ui_delta_job_add_id(job->item_ids, item_id);
+    }
+    ui_submit_delta(state, job);
+}
+
+/* Llega en el hilo principal con los cambios de un commit de la conexión escritora. */
+static void ui_on_rows_changed(const ChangeEvent *events, int count, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiDeltaJob *job = ui_delta_job_new(state);
+    bool reload_orders = false;
+    bool reload_items = false;
+    bool reload_tables = false;
+    bool reload_menu = false;
+    bool reload_reservations = false;
+    int index = 0;
     while (index < count) {
-        char row_text[256];
-        GtkWidget *row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
-        snprintf(row_text, sizeof(row_text), "#%d %.160s (%.40s)", items[index].id, items[index].notes, items[index].status);
-        gtk_box_append(GTK_BOX(row), gtk_label_new(row_text));
-        gtk_list_box_append(GTK_LIST_BOX(state->order_items_list), row);
+        const ChangeEvent *event = &events[index];
+        if (event->table == CHANGE_TABLE_ORDERS) {
+            if (event->rowid == 0) {
+                reload_orders = true;
+            } else {
+                ui_delta_job_add_id(job->order_ids, (int)event->rowid);
+            }
+        } else if (event->table == CHANGE_TABLE_ORDER_ITEMS) {
+            if (event->rowid == 0) {
+                reload_items = true;
+            } else if (state->selected_order_id > 0) {
+                ui_delta_job_add_id(job->item_ids, (int)event->rowid);
+            }
+        } else if (event->table == CHANGE_TABLE_TABLES || event->table == CHANGE_TABLE_USERS) {
+            reload_tables = true;
+        } else if (event->table == CHANGE_TABLE_MENU_ITEMS) {
+            reload_menu = true;
+        } else if (event->table == CHANGE_TABLE_RESERVATIONS) {
+            reload_reservations = true;
+        }
         index = index + 1;
     }
-    dao_free_order_items(items);
+    if (reload_orders) {
+        ui_refresh_orders(state);
+        g_array_set_size(job->order_ids, 0);
+    }
+    if (reload_items) {
+        ui_refresh_order_items(state);
+        g_array_set_size(job->item_ids, 0);
+    }
+    if (reload_tables) {
+        ui_refresh_tables(state);
+    }
+    if (reload_menu) {
+        ui_refresh_menu(state);
+    }
+    if (reload_reservations) {
+        ui_refresh_reservations(state);
+    }
+    ui_submit_delta(state, job);
 }
 
 static void ui_select_order(UiState *state, int order_id) {
@@ -162,78 +544,233 @@ static void ui_select_order(UiState *state, int order_id) {
     ui_refresh_order_items(state);
 }
 
-static void ui_on_order_button(GtkButton *button, UiState *state) {
-    gpointer value = g_object_get_data(G_OBJECT(button), "order-id");
-    ui_select_order(state, GPOINTER_TO_INT(value));
+static void ui_on_order_activated(GtkListView *list_view, guint position, UiState *state) {
+    const UiTextRow *row = ui_row_model_get_row(state->orders_model, position);
+    (void)list_view;
+    if (row != NULL) {
+        ui_select_order(state, row->id);
+    }
 }
 
-static void ui_bind_order_buttons(UiState *state) {
-    GtkWidget *child = gtk_widget_get_first_child(state->orders_list);
-    while (child != NULL) {
-        GtkWidget *next = gtk_widget_get_next_sibling(child);
-        if (GTK_IS_BUTTON(child)) {
-            g_signal_connect(child, "clicked", G_CALLBACK(ui_on_order_button), state);
-        }
-        child = next;
-    }
+typedef struct UiLoginJob {
+    UiState *state;
+    char *username;
+    char *password;
+    User user;
+    AuthResult result;
+} UiLoginJob;
+
+static void ui_login_job_free(gpointer data) {
+    UiLoginJob *job = (UiLoginJob *)data;
+    g_free(job->username);
+    g_free(job->password);
+    g_free(job);
 }
 
-static void ui_on_login(GtkButton *button, UiState *state) {
-    GtkWidget *user_entry = g_object_get_data(G_OBJECT(button), "user-entry");
-    GtkWidget *pass_entry = g_object_get_data(G_OBJECT(button), "pass-entry");
-    const char *username = gtk_editable_get_text(GTK_EDITABLE(user_entry));
-    const char *password = gtk_editable_get_text(GTK_EDITABLE(pass_entry));
-    if (auth_login(state->ctx, username, password, &state->current_user)) {
+static bool ui_job_login(Database *db, gpointer data) {
+    UiLoginJob *job = (UiLoginJob *)data;
+    job->result = auth_check_credentials(db, job->username, job->password, &job->user);
+    return job->result == AUTH_RESULT_OK;
+}
+
+static void ui_on_login_checked(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiLoginJob *job = (UiLoginJob *)data;
+    auth_log_result(state->ctx, job->result);
+    if (ok) {
+        state->current_user = job->user;
+        gtk_stack_page_set_visible(state->diagnostics_page, strcmp(job->user.role, "admin") == 0);
         gtk_widget_set_visible(state->login_panel, FALSE);
         gtk_widget_set_visible(state->content_panel, TRUE);
         ui_status(state, "Ingreso correcto");
         ui_refresh_tables(state);
         ui_refresh_menu(state);
         ui_refresh_orders(state);
-        ui_bind_order_buttons(state);
         ui_refresh_reservations(state);
     } else {
         ui_status(state, "Credenciales inválidas");
     }
 }
 
+static void ui_on_login(GtkButton *button, UiState *state) {
+    GtkWidget *user_entry = g_object_get_data(G_OBJECT(button), "user-entry");
+    GtkWidget *pass_entry = g_object_get_data(G_OBJECT(button), "pass-entry");
+    UiLoginJob *job = g_new0(UiLoginJob, 1);
+    job->state = state;
+    job->username = g_strdup(gtk_editable_get_text(GTK_EDITABLE(user_entry)));
+    job->password = g_strdup(gtk_editable_get_text(GTK_EDITABLE(pass_entry)));
+    dao_async_read(&state->ctx->async, ui_job_login, job, ui_login_job_free, ui_on_login_checked, state);
+}
+
+static bool ui_job_create_order(Database *db, gpointer data) {
+    UiWriteJob *job = (UiWriteJob *)data;
+    (void)db;
+    return order_service_create(job->state->ctx, job->table_id, job->user_id, &job->order_id);
+}
+
+static void ui_on_order_created(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    (void)data;
+    if (ok) {
+        ui_status(state, "Comanda creada");
+    } else {
+        ui_status(state, "No se pudo crear la comanda");
+    }
+}
+
 static void ui_on_create_order(GtkButton *button, UiState *state) {
     const char *table_id_str = gtk_combo_box_get_active_id(GTK_COMBO_BOX(state->table_selector));
-    int table_id;
+    UiWriteJob *job = NULL;
     (void)button;
     if (table_id_str == NULL) {
         ui_status(state, "Seleccione mesa");
         return;
     }
-    table_id = atoi(table_id_str);
-    if (order_service_create(state->ctx, table_id, state->current_user.id, NULL)) {
-        ui_status(state, "Comanda creada");
-        ui_refresh_orders(state);
-        ui_bind_order_buttons(state);
-    } else {
-        ui_status(state, "No se pudo crear la comanda");
+    job = ui_write_job_new(state);
+    job->table_id = atoi(table_id_str);
+    job->user_id = state->current_user.id;
+    dao_async_write(&state->ctx->async, ui_job_create_order, job, ui_write_job_free, ui_on_order_created, state);
+}
+
+static void ui_cart_entry_clear(gpointer data) {
+    UiCartEntry *entry = (UiCartEntry *)data;
+    g_free(entry->notes);
+    g_free(entry->label);
+}
+
+static GArray *ui_cart_new(void) {
+    GArray *cart = g_array_new(FALSE, TRUE, sizeof(UiCartEntry));
+    g_array_set_clear_func(cart, ui_cart_entry_clear);
+    return cart;
+}
+
+static void ui_render_cart(UiState *state) {
+    guint index = 0;
+    ui_clear_list_box(GTK_LIST_BOX(state->cart_list));
+    while (index < state->cart->len) {
+        UiCartEntry *entry = &g_array_index(state->cart, UiCartEntry, index);
+        char *text = entry->notes[0] == '\0'
+            ? g_strdup_printf("%d x %s", entry->quantity, entry->label)
+            : g_strdup_printf("%d x %s (%s)", entry->quantity, entry->label, entry->notes);
+        gtk_list_box_append(GTK_LIST_BOX(state->cart_list), gtk_label_new(text));
+        g_free(text);
+        index = index + 1;
     }
 }
 
-static void ui_on_add_item(GtkButton *button, UiState *state) {
+static void ui_on_add_to_cart(GtkButton *button, UiState *state) {
     const char *menu_id_str = gtk_combo_box_get_active_id(GTK_COMBO_BOX(state->menu_selector));
     const char *notes = gtk_editable_get_text(GTK_EDITABLE(state->notes_entry));
-    int menu_id;
+    int quantity = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(state->quantity_spin));
+    int menu_item_id;
+    guint index = 0;
+    UiCartEntry entry;
+    (void)button;
+    if (menu_id_str == NULL) {
+        ui_status(state, "Seleccione plato");
+        return;
+    }
+    menu_item_id = atoi(menu_id_str);
+    while (index < state->cart->len) {
+        UiCartEntry *existing = &g_array_index(state->cart, UiCartEntry, index);
+        if (existing->menu_item_id == menu_item_id && strcmp(existing->notes, notes) == 0) {
+            existing->quantity = existing->quantity + quantity;
+            ui_render_cart(state);
+            return;
+        }
+        index = index + 1;
+    }
+    entry.menu_item_id = menu_item_id;
+    entry.quantity = quantity;
+    entry.notes = g_strdup(notes);
+    entry.label = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(state->menu_selector));
+    g_array_append_val(state->cart, entry);
+    gtk_editable_set_text(GTK_EDITABLE(state->notes_entry), "");
+    ui_render_cart(state);
+}
+
+static void ui_on_clear_cart(GtkButton *button, UiState *state) {
+    (void)button;
+    g_array_set_size(state->cart, 0);
+    ui_render_cart(state);
+}
+
+static void ui_cart_job_free(gpointer data) {
+    UiCartJob *job = (UiCartJob *)data;
+    if (job->entries != NULL) {
+        g_array_unref(job->entries);
+    }
+    g_free(job);
+}
+
+static bool ui_job_send_cart(Database *db, gpointer data) {
+    UiCartJob *job = (UiCartJob *)data;
+    OrderItemRequest *requests = g_new0(OrderItemRequest, job->entries->len);
+    guint index = 0;
+    bool ok;
+    (void)db;
+    while (index < job->entries->len) {
+        UiCartEntry *entry = &g_array_index(job->entries, UiCartEntry, index);
+        requests[index].menu_item_id = entry->menu_item_id;
+        requests[index].notes = entry->notes;
+        requests[index].quantity = entry->quantity;
+        index = index + 1;
+    }
+    ok = order_service_add_items(job->state->ctx, job->order_id, requests, (int)job->entries->len);
+    g_free(requests);
+    return ok;
+}
+
+static void ui_on_cart_sent(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiCartJob *job = (UiCartJob *)data;
+    /* Comandas e ítems nuevos llegan por el bus de cambios. */
+    if (ok) {
+        ui_status(state, "Pedido enviado");
+        return;
+    }
+    /* Se devuelven los ítems al carrito para poder reintentar. */
+    g_array_prepend_vals(state->cart, job->entries->data, job->entries->len);
+    g_array_set_clear_func(job->entries, NULL);
+    ui_render_cart(state);
+    ui_status(state, "Error al enviar pedido");
+}
+
+static void ui_on_send_cart(GtkButton *button, UiState *state) {
+    UiCartJob *job = NULL;
     (void)button;
     if (state->selected_order_id <= 0) {
         ui_status(state, "Seleccione comanda");
         return;
     }
-    if (menu_id_str == NULL) {
-        ui_status(state, "Seleccione plato");
+    if (state->cart->len == 0) {
+        ui_status(state, "El pedido está vacío");
         return;
     }
-    menu_id = atoi(menu_id_str);
-    if (order_service_add_item(state->ctx, state->selected_order_id, menu_id, notes)) {
-        ui_status(state, "Ítem agregado");
-        ui_refresh_order_items(state);
+    job = g_new0(UiCartJob, 1);
+    job->state = state;
+    job->order_id = state->selected_order_id;
+    job->entries = state->cart;
+    state->cart = ui_cart_new();
+    ui_render_cart(state);
+    dao_async_write(&state->ctx->async, ui_job_send_cart, job, ui_cart_job_free, ui_on_cart_sent, state);
+}
+
+static bool ui_job_update_status(Database *db, gpointer data) {
+    UiWriteJob *job = (UiWriteJob *)data;
+    (void)db;
+    return order_service_update_status(job->state->ctx, job->order_item_id, job->text);
+}
+
+static void ui_on_status_updated(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiWriteJob *job = (UiWriteJob *)data;
+    if (ok) {
+        ui_status(state, "Estado actualizado");
+        /* Un estado encolado todavía no hizo commit: el bus no lo ve, se relee la fila con la cola aplicada. */
+        ui_refresh_order_item_row(state, job->order_item_id);
     } else {
-        ui_status(state, "Error al agregar ítem");
+        ui_status(state, "No se actualizó el estado");
     }
 }
 
@@ -241,6 +778,7 @@ static void ui_on_update_status(GtkButton *button, UiState *state) {
     const char *item_id_text = gtk_editable_get_text(GTK_EDITABLE(state->item_id_entry));
     gchar *status_text = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(state->status_combo));
     int item_id = atoi(item_id_text);
+    UiWriteJob *job = NULL;
     (void)button;
     if (item_id <= 0) {
         ui_status(state, "ID inválido");
@@ -251,13 +789,10 @@ static void ui_on_update_status(GtkButton *button, UiState *state) {
         ui_status(state, "Estado inválido");
         return;
     }
-    if (order_service_update_status(state->ctx, item_id, status_text)) {
-        ui_status(state, "Estado actualizado");
-        ui_refresh_order_items(state);
-    } else {
-        ui_status(state, "No se actualizó el estado");
-    }
-    g_free(status_text);
+    job = ui_write_job_new(state);
+    job->order_item_id = item_id;
+    job->text = status_text;
+    dao_async_write(&state->ctx->async, ui_job_update_status, job, ui_write_job_free, ui_on_status_updated, state);
 }
 
 static void ui_generate_ticket(AppContext *ctx, int order_id, double subtotal, double tax, double total) {
@@ -280,77 +815,419 @@ static void ui_generate_ticket(AppContext *ctx, int order_id, double subtotal, d
     fclose(file);
 }
 
-static void ui_on_close_order(GtkButton *button, UiState *state) {
-    double subtotal = 0;
-    double tax = 0;
-    double total = 0;
+typedef struct UiTotalsJob {
+    UiState *state;
+    int order_id;
+    double tax_rate;
+    double subtotal;
+    double tax;
+    double total;
+} UiTotalsJob;
+
+static bool ui_job_close_order(Database *db, gpointer data) {
+    UiTotalsJob *job = (UiTotalsJob *)data;
+    if (!order_service_close(job->state->ctx, job->order_id)) {
+        return false;
+    }
+    if (!dao_calculate_order_totals(db, job->order_id, job->tax_rate, 0.1, 0, &job->subtotal, &job->tax, &job->total)) {
+        return false;
+    }
+    ui_generate_ticket(job->state->ctx, job->order_id, job->subtotal, job->tax, job->total);
+    return true;
+}
+
+static void ui_on_order_closed(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiTotalsJob *job = (UiTotalsJob *)data;
     char label_text[128];
+    if (ok) {
+        snprintf(label_text, sizeof(label_text), "Total: %.2f (IVA %.2f)", job->total, job->tax);
+        gtk_label_set_text(GTK_LABEL(state->totals_label), label_text);
+        ui_status(state, "Comanda cerrada, ticket generado");
+        if (job->order_id == state->selected_order_id) {
+            state->selected_order_id = 0;
+            ui_refresh_order_items(state);
+        }
+    } else {
+        ui_status(state, "No se pudo cerrar la comanda");
+    }
+}
+
+static void ui_on_close_order(GtkButton *button, UiState *state) {
+    UiTotalsJob *job = NULL;
     (void)button;
     if (state->selected_order_id <= 0) {
         ui_status(state, "Seleccione comanda");
         return;
     }
-    if (order_service_calculate_totals(state->ctx, state->selected_order_id, 0.1, 0, &subtotal, &tax, &total)) {
-        ui_generate_ticket(state->ctx, state->selected_order_id, subtotal, tax, total);
-        snprintf(label_text, sizeof(label_text), "Total: %.2f (IVA %.2f)", total, tax);
-        gtk_label_set_text(GTK_LABEL(state->totals_label), label_text);
-        ui_status(state, "Ticket generado");
+    job = g_new0(UiTotalsJob, 1);
+    job->state = state;
+    job->order_id = state->selected_order_id;
+    job->tax_rate = state->ctx->config.tax_rate;
+    dao_async_write(&state->ctx->async, ui_job_close_order, job, g_free, ui_on_order_closed, state);
+}
+
+typedef struct UiExportJob {
+    char date_str[16];
+    char path[256];
+} UiExportJob;
+
+static bool ui_job_export_report(Database *db, gpointer data) {
+    UiExportJob *job = (UiExportJob *)data;
+#ifdef _WIN32
+    _mkdir("reports");
+#else
+    mkdir("reports", 0755);
+#endif
+    return dao_export_daily_report(db, job->date_str, job->path);
+}
+
+static void ui_on_report_exported(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    (void)data;
+    if (ok) {
+        logger_log(&state->ctx->logger, LOG_LEVEL_INFO, "report", "Reporte diario exportado");
+        ui_status(state, "Reporte exportado");
     } else {
-        ui_status(state, "No se pudo calcular total");
+        logger_log(&state->ctx->logger, LOG_LEVEL_ERROR, "report", "No se pudo exportar el reporte");
+        ui_status(state, "No se exportó reporte");
     }
 }
 
 static void ui_on_export_report(GtkButton *button, UiState *state) {
     time_t now = time(NULL);
     struct tm tm_now;
-    char date_str[16];
-    char path[256];
+    UiExportJob *job = g_new0(UiExportJob, 1);
     (void)button;
 #ifdef _WIN32
     localtime_s(&tm_now, &now);
 #else
     localtime_r(&now, &tm_now);
 #endif
-    strftime(date_str, sizeof(date_str), "%Y-%m-%d", &tm_now);
+    strftime(job->date_str, sizeof(job->date_str), "%Y-%m-%d", &tm_now);
+    snprintf(job->path, sizeof(job->path), "reports/ventas_%s.csv", job->date_str);
+    ui_status(state, "Exportando reporte...");
+    dao_async_read(&state->ctx->async, ui_job_export_report, job, g_free, ui_on_report_exported, state);
+}
+
+static bool ui_visit_reservation(const ReservationView *row, void *user_data) {
+    ui_list_job_append((UiListJob *)user_data, row->id,
+                       g_strdup_printf("Mesa %d - %s", row->table_id, row->customer_name),
+                       g_strdup_printf("%s (%s)", row->reserved_at, row->customer_phone),
+                       row->notes[0] == '\0' ? NULL : g_strdup(row->notes));
+    return true;
+}
+
+/* Compara los últimos 30 días contra la misma ventana del año anterior usando los acumulados diarios. */
+typedef struct UiSalesJob {
+    char from[16];
+    char to[16];
+    char previous_from[16];
+    char previous_to[16];
+    SalesTotals current;
+    SalesTotals previous;
+} UiSalesJob;
+
+static bool ui_job_compare_sales(Database *db, gpointer data) {
+    UiSalesJob *job = (UiSalesJob *)data;
+    if (!dao_sum_daily_sales(db, job->from, job->to, &job->current)) {
+        return false;
+    }
+    return dao_sum_daily_sales(db, job->previous_from, job->previous_to, &job->previous);
+}
+
+static void ui_on_sales_compared(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiSalesJob *job = (UiSalesJob *)data;
+    char *text;
+    if (!ok) {
+        ui_status(state, "No se pudieron leer los acumulados");
+        return;
+    }
+    text = g_strdup_printf("Últimos 30 días: %.2f (%d comandas) · año anterior: %.2f (%d comandas)",
+                           job->current.revenue, job->current.order_count, job->previous.revenue, job->previous.order_count);
+    gtk_label_set_text(GTK_LABEL(state->sales_label), text);
+    g_free(text);
+}
+
+/* Solo lee contadores en memoria: se arma en el hilo de la UI, sin pasar por la base. */
+static void ui_refresh_metrics(UiState *state) {
+    Metrics *metrics = &state->ctx->metrics;
+    GArray *summaries = metrics_snapshot(metrics);
+    GArray *rows = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    char *text = NULL;
+    guint index = 0;
+    while (index < summaries->len) {
+        const MetricsSummary *summary = &g_array_index(summaries, MetricsSummary, index);
+        UiTextRow row;
+        row.id = (int)index + 1;
+        row.primary = g_strdup_printf("%s · %s", summary->family, summary->name);
+        row.secondary = g_strdup_printf("n=%lld · p50 %.2f ms · p90 %.2f ms · p99 %.2f ms · máx %.2f ms", summary->count, summary->p50_ms, summary->p90_ms, summary->p99_ms, summary->max_ms);
+        row.extra = NULL;
+        g_array_append_val(rows, row);
+        index = index + 1;
+    }
+    ui_row_model_set_rows(state->metrics_model, rows);
+    g_array_unref(rows);
+    g_array_unref(summaries);
+    text = g_strdup_printf("Ingresos fallidos: %d · Trabajos fallidos: %d · En cola: %d lectura, %d escritura, %d estados",
+                           g_atomic_int_get(&metrics->counters[METRICS_COUNTER_LOGINS_FAILED]), g_atomic_int_get(&metrics->counters[METRICS_COUNTER_JOBS_FAILED]),
+                           g_atomic_int_get(&metrics->gauges[METRICS_GAUGE_READ_QUEUE]), g_atomic_int_get(&metrics->gauges[METRICS_GAUGE_WRITE_QUEUE]),
+                           status_queue_count(&state->ctx->statuses));
+    gtk_label_set_text(GTK_LABEL(state->metrics_label), text);
+    g_free(text);
+}
+
+static void ui_on_refresh_metrics(GtkButton *button, UiState *state) {
+    (void)button;
+    ui_refresh_metrics(state);
+}
+
+static void ui_on_page_changed(GObject *stack, GParamSpec *pspec, UiState *state) {
+    const char *name = gtk_stack_get_visible_child_name(GTK_STACK(stack));
+    (void)pspec;
+    if (name != NULL && strcmp(name, "diagnostico") == 0) {
+        ui_refresh_metrics(state);
+    }
+}
+
+static void ui_format_day(time_t when, int years_back, char *buffer, size_t buffer_len) {
+    struct tm tm_day;
 #ifdef _WIN32
-    _mkdir("reports");
+    localtime_s(&tm_day, &when);
 #else
-    mkdir("reports", 0755);
+    localtime_r(&when, &tm_day);
 #endif
-    snprintf(path, sizeof(path), "reports/ventas_%s.csv", date_str);
-    if (report_service_export_daily(state->ctx, date_str, path)) {
-        ui_status(state, "Reporte exportado");
-    } else {
-        ui_status(state, "No se exportó reporte");
+    tm_day.tm_year = tm_day.tm_year - years_back;
+    strftime(buffer, buffer_len, "%Y-%m-%d", &tm_day);
+}
+
+static void ui_on_compare_sales(GtkButton *button, UiState *state) {
+    time_t now = time(NULL);
+    time_t start = now - 29 * 24 * 60 * 60;
+    UiSalesJob *job = g_new0(UiSalesJob, 1);
+    (void)button;
+    ui_format_day(start, 0, job->from, sizeof(job->from));
+    ui_format_day(now, 0, job->to, sizeof(job->to));
+    ui_format_day(start, 1, job->previous_from, sizeof(job->previous_from));
+    ui_format_day(now, 1, job->previous_to, sizeof(job->previous_to));
+    dao_async_read(&state->ctx->async, ui_job_compare_sales, job, g_free, ui_on_sales_compared, state);
+}
+
+#define UI_RESERVATIONS_PAGE 200
+
+/* Una página de la ventana de reservas: sigue desde la última fila ya mostrada. */
+typedef struct UiReservationPageJob {
+    UiListJob list;
+    char from[16];
+    char to[16];
+    bool has_after;
+    ReservationKey after;
+    ReservationKey last;
+} UiReservationPageJob;
+
+static void ui_reservation_page_job_free(gpointer data) {
+    UiReservationPageJob *job = (UiReservationPageJob *)data;
+    g_array_unref(job->list.rows);
+    g_free(job);
+}
+
+static bool ui_visit_reservation_page(const ReservationView *row, void *user_data) {
+    UiReservationPageJob *job = (UiReservationPageJob *)user_data;
+    job->last.id = row->id;
+    g_strlcpy(job->last.reserved_at, row->reserved_at, sizeof(job->last.reserved_at));
+    return ui_visit_reservation(row, &job->list);
+}
+
+static bool ui_job_list_reservations(Database *db, gpointer data) {
+    UiReservationPageJob *job = (UiReservationPageJob *)data;
+    return dao_visit_reservations_window(db, job->from, job->to, job->has_after ? &job->after : NULL, UI_RESERVATIONS_PAGE, ui_visit_reservation_page, job);
+}
+
+static void ui_on_reservations_loaded(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiReservationPageJob *job = (UiReservationPageJob *)data;
+    if (job->list.generation != state->reservations_generation) {
+        return;
+    }
+    state->reservations_loading = false;
+    if (!ok) {
+        ui_status(state, "Error cargando reservas");
+        return;
+    }
+    if (job->list.rows->len < UI_RESERVATIONS_PAGE) {
+        state->reservations_exhausted = true;
+    }
+    if (job->list.rows->len > 0) {
+        state->reservations_after = job->last;
+        state->reservations_started = true;
     }
+    ui_row_model_append_rows(state->reservations_model, job->list.rows);
 }
 
+static void ui_load_reservations_page(UiState *state) {
+    UiReservationPageJob *job = NULL;
+    time_t now = time(NULL);
+    time_t span = 0;
+    int days = state->ctx->config.reservations_window_days > 0 ? state->ctx->config.reservations_window_days : 7;
+    if (state->reservations_loading || state->reservations_exhausted) {
+        return;
+    }
+    span = (time_t)days * 24 * 60 * 60;
+    job = g_new0(UiReservationPageJob, 1);
+    job->list.state = state;
+    job->list.generation = state->reservations_generation;
+    job->list.rows = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    g_array_set_clear_func(job->list.rows, ui_text_row_clear);
+    /* Hasta el final del último día: el límite superior es exclusivo. */
+    ui_format_day(now - span, 0, job->from, sizeof(job->from));
+    ui_format_day(now + span + 24 * 60 * 60, 0, job->to, sizeof(job->to));
+    job->has_after = state->reservations_started;
+    job->after = state->reservations_after;
+    state->reservations_loading = true;
+    dao_async_read(&state->ctx->async, ui_job_list_reservations, job, ui_reservation_page_job_free, ui_on_reservations_loaded, state);
+}
+
+/* Vuelve a la primera página; las siguientes se piden al llegar al final del scroll. */
 static void ui_refresh_reservations(UiState *state) {
-    Reservation *reservations = NULL;
-    int count = 0;
-    int index = 0;
     if (state->reservations_list == NULL) {
         return;
     }
-    ui_clear_list_box(GTK_LIST_BOX(state->reservations_list));
-    if (!dao_list_reservations(state->ctx->db, &reservations, &count)) {
-        ui_status(state, "Error cargando reservas");
+    state->reservations_generation = state->reservations_generation + 1;
+    state->reservations_started = false;
+    state->reservations_loading = false;
+    state->reservations_exhausted = false;
+    memset(&state->reservations_after, 0, sizeof(state->reservations_after));
+    ui_row_model_clear(state->reservations_model);
+    ui_load_reservations_page(state);
+}
+
+static void ui_on_reservations_edge(GtkScrolledWindow *scrolled, GtkPositionType position, UiState *state) {
+    (void)scrolled;
+    if (position == GTK_POS_BOTTOM) {
+        ui_load_reservations_page(state);
+    }
+}
+
+typedef struct UiReservationJob {
+    AppContext *ctx;
+    int table_id;
+    int conflict_id;
+    char *name;
+    char *phone;
+    char *datetime;
+    char *notes;
+} UiReservationJob;
+
+static void ui_reservation_job_free(gpointer data) {
+    UiReservationJob *job = (UiReservationJob *)data;
+    g_free(job->name);
+    g_free(job->phone);
+    g_free(job->datetime);
+    g_free(job->notes);
+    g_free(job);
+}
+
+static bool ui_job_add_reservation(Database *db, gpointer data) {
+    UiReservationJob *job = (UiReservationJob *)data;
+    return reservation_book_create(&job->ctx->reservations, db, job->table_id, job->name, job->phone, job->datetime, job->notes, NULL, &job->conflict_id);
+}
+
+static void ui_on_reservation_added(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiReservationJob *job = (UiReservationJob *)data;
+    if (ok) {
+        ui_status(state, "Reserva creada");
+    } else if (job->conflict_id > 0) {
+        char *text = g_strdup_printf("Mesa %d ocupada en ese horario (reserva #%d)", job->table_id, job->conflict_id);
+        ui_status(state, text);
+        g_free(text);
+    } else {
+        ui_status(state, "No se creó la reserva");
+    }
+}
+
+typedef struct UiFreeTablesJob {
+    AppContext *ctx;
+    char datetime[32];
+    int party_size;
+    GArray *table_ids;
+} UiFreeTablesJob;
+
+static void ui_free_tables_job_free(gpointer data) {
+    UiFreeTablesJob *job = (UiFreeTablesJob *)data;
+    g_array_unref(job->table_ids);
+    g_free(job);
+}
+
+static bool ui_job_free_tables(Database *db, gpointer data) {
+    UiFreeTablesJob *job = (UiFreeTablesJob *)data;
+    return reservation_book_free_tables(&job->ctx->reservations, db, job->datetime, 0, job->party_size, job->table_ids);
+}
+
+static void ui_on_free_tables(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    UiFreeTablesJob *job = (UiFreeTablesJob *)data;
+    GString *text = NULL;
+    guint index = 0;
+    if (!ok) {
+        ui_status(state, "No se pudo consultar la disponibilidad");
         return;
     }
-    while (index < count) {
-        char buffer[256];
-        GtkWidget *row = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
-        snprintf(buffer, sizeof(buffer), "Mesa %d - %s", reservations[index].table_id, reservations[index].customer_name);
-        gtk_box_append(GTK_BOX(row), gtk_label_new(buffer));
-        snprintf(buffer, sizeof(buffer), "%s (%s)", reservations[index].reserved_at, reservations[index].customer_phone);
-        gtk_box_append(GTK_BOX(row), gtk_label_new(buffer));
-        if (strlen(reservations[index].notes) > 0) {
-            gtk_box_append(GTK_BOX(row), gtk_label_new(reservations[index].notes));
-        }
-        gtk_list_box_append(GTK_LIST_BOX(state->reservations_list), row);
+    if (job->table_ids->len == 0) {
+        ui_status(state, "No hay mesas libres en ese horario");
+        return;
+    }
+    text = g_string_new(NULL);
+    g_string_append_printf(text, "Libres para %d el %s:", job->party_size, job->datetime);
+    while (index < job->table_ids->len) {
+        g_string_append_printf(text, " Mesa %d", g_array_index(job->table_ids, int, index));
         index = index + 1;
     }
-    dao_free_reservations(reservations);
+    ui_status(state, text->str);
+    g_string_free(text, TRUE);
+}
+
+static void ui_on_find_free_tables(GtkButton *button, UiState *state) {
+    const char *datetime = gtk_editable_get_text(GTK_EDITABLE(state->reservation_datetime_entry));
+    UiFreeTablesJob *job = NULL;
+    long long minutes = 0;
+    (void)button;
+    if (!reservation_parse_minutes(datetime, &minutes)) {
+        ui_status(state, "Fecha inválida (YYYY-MM-DD HH:MM)");
+        return;
+    }
+    job = g_new0(UiFreeTablesJob, 1);
+    job->ctx = state->ctx;
+    g_strlcpy(job->datetime, datetime, sizeof(job->datetime));
+    job->party_size = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(state->reservation_party_spin));
+    job->table_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    dao_async_read(&state->ctx->async, ui_job_free_tables, job, ui_free_tables_job_free, ui_on_free_tables, state);
+}
+
+static bool ui_job_cancel_reservation(Database *db, gpointer data) {
+    UiWriteJob *job = (UiWriteJob *)data;
+    return reservation_book_cancel(&job->state->ctx->reservations, db, job->reservation_id);
+}
+
+static void ui_on_reservation_cancelled(bool ok, gpointer data, gpointer user_data) {
+    UiState *state = (UiState *)user_data;
+    (void)data;
+    ui_status(state, ok ? "Reserva cancelada" : "No se canceló la reserva");
+}
+
+static void ui_on_cancel_reservation(GtkButton *button, UiState *state) {
+    GtkSingleSelection *selection = GTK_SINGLE_SELECTION(gtk_list_view_get_model(GTK_LIST_VIEW(state->reservations_list)));
+    const UiTextRow *row = ui_row_model_get_row(state->reservations_model, gtk_single_selection_get_selected(selection));
+    UiWriteJob *job = NULL;
+    (void)button;
+    if (row == NULL) {
+        ui_status(state, "Seleccione una reserva");
+        return;
+    }
+    job = ui_write_job_new(state);
+    job->reservation_id = row->id;
+    dao_async_write(&state->ctx->async, ui_job_cancel_reservation, job, ui_write_job_free, ui_on_reservation_cancelled, state);
 }
 
 static void ui_on_add_reservation(GtkButton *button, UiState *state) {
@@ -359,19 +1236,25 @@ static void ui_on_add_reservation(GtkButton *button, UiState *state) {
     const char *phone = gtk_editable_get_text(GTK_EDITABLE(state->reservation_phone_entry));
     const char *datetime = gtk_editable_get_text(GTK_EDITABLE(state->reservation_datetime_entry));
     const char *notes = gtk_editable_get_text(GTK_EDITABLE(state->reservation_notes_entry));
-    int table_id;
+    UiReservationJob *job = NULL;
+    long long minutes = 0;
     (void)button;
     if (table_id_str == NULL || name[0] == '\0' || datetime[0] == '\0') {
         ui_status(state, "Complete la reserva");
         return;
     }
-    table_id = atoi(table_id_str);
-    if (dao_create_reservation(state->ctx->db, table_id, name, phone, datetime, notes)) {
-        ui_status(state, "Reserva creada");
-        ui_refresh_reservations(state);
-    } else {
-        ui_status(state, "No se creó la reserva");
+    if (!reservation_parse_minutes(datetime, &minutes)) {
+        ui_status(state, "Fecha inválida (YYYY-MM-DD HH:MM)");
+        return;
     }
+    job = g_new0(UiReservationJob, 1);
+    job->ctx = state->ctx;
+    job->table_id = atoi(table_id_str);
+    job->name = g_strdup(name);
+    job->phone = g_strdup(phone);
+    job->datetime = g_strdup(datetime);
+    job->notes = g_strdup(notes);
+    dao_async_write(&state->ctx->async, ui_job_add_reservation, job, ui_reservation_job_free, ui_on_reservation_added, state);
 }
 
 static GtkWidget *ui_build_login(UiState *state) {
@@ -394,10 +1277,12 @@ static GtkWidget *ui_build_login(UiState *state) {
 static GtkWidget *ui_build_salon(UiState *state) {
     GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     GtkWidget *create_button = gtk_button_new_with_label("Crear comanda");
-    state->tables_list = gtk_list_box_new();
+    GtkWidget *tables_scroll;
+    state->tables_model = ui_row_model_new();
+    tables_scroll = ui_row_list_new(state->tables_model, GTK_ORIENTATION_HORIZONTAL, &state->tables_list);
     state->table_selector = GTK_WIDGET(gtk_combo_box_text_new());
     gtk_box_append(GTK_BOX(box), gtk_label_new("Mesas"));
-    gtk_box_append(GTK_BOX(box), state->tables_list);
+    gtk_box_append(GTK_BOX(box), tables_scroll);
     gtk_box_append(GTK_BOX(box), state->table_selector);
     gtk_box_append(GTK_BOX(box), create_button);
     g_signal_connect(create_button, "clicked", G_CALLBACK(ui_on_create_order), state);
@@ -408,13 +1293,22 @@ static GtkWidget *ui_build_comandas(UiState *state) {
     GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     GtkWidget *top = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
     GtkWidget *actions = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
-    GtkWidget *add_button = gtk_button_new_with_label("Agregar ítem");
+    GtkWidget *add_button = gtk_button_new_with_label("Agregar al pedido");
+    GtkWidget *send_button = gtk_button_new_with_label("Enviar pedido");
+    GtkWidget *clear_cart_button = gtk_button_new_with_label("Vaciar pedido");
     GtkWidget *close_button = gtk_button_new_with_label("Cerrar y ticket");
     GtkWidget *update_button = gtk_button_new_with_label("Actualizar estado");
-    state->orders_list = gtk_list_box_new();
-    state->order_items_list = gtk_list_box_new();
+    GtkWidget *orders_scroll;
+    GtkWidget *order_items_scroll;
+    state->orders_model = ui_row_model_new();
+    state->order_items_model = ui_row_model_new();
+    orders_scroll = ui_row_list_new(state->orders_model, GTK_ORIENTATION_VERTICAL, &state->orders_list);
+    order_items_scroll = ui_row_list_new(state->order_items_model, GTK_ORIENTATION_VERTICAL, &state->order_items_list);
+    gtk_list_view_set_single_click_activate(GTK_LIST_VIEW(state->orders_list), TRUE);
     state->menu_selector = GTK_WIDGET(gtk_combo_box_text_new());
     state->notes_entry = gtk_entry_new();
+    state->quantity_spin = gtk_spin_button_new_with_range(1, 50, 1);
+    state->cart_list = gtk_list_box_new();
     state->order_status_label = gtk_label_new("Sin comanda");
     state->totals_label = gtk_label_new("Total: 0");
     state->status_combo = GTK_WIDGET(gtk_combo_box_text_new());
@@ -423,12 +1317,17 @@ static GtkWidget *ui_build_comandas(UiState *state) {
     gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->status_combo), NULL, "preparacion");
     gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->status_combo), NULL, "listo");
     gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->status_combo), NULL, "servido");
-    gtk_box_append(GTK_BOX(top), state->orders_list);
-    gtk_box_append(GTK_BOX(top), state->order_items_list);
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(state->status_combo), NULL, "anulado");
+    gtk_box_append(GTK_BOX(top), orders_scroll);
+    gtk_box_append(GTK_BOX(top), order_items_scroll);
     gtk_box_append(GTK_BOX(actions), state->order_status_label);
     gtk_box_append(GTK_BOX(actions), state->menu_selector);
     gtk_box_append(GTK_BOX(actions), state->notes_entry);
+    gtk_box_append(GTK_BOX(actions), state->quantity_spin);
     gtk_box_append(GTK_BOX(actions), add_button);
+    gtk_box_append(GTK_BOX(actions), state->cart_list);
+    gtk_box_append(GTK_BOX(actions), send_button);
+    gtk_box_append(GTK_BOX(actions), clear_cart_button);
     gtk_box_append(GTK_BOX(actions), close_button);
     gtk_box_append(GTK_BOX(actions), state->totals_label);
     gtk_box_append(GTK_BOX(box), top);
@@ -439,17 +1338,40 @@ static GtkWidget *ui_build_comandas(UiState *state) {
     gtk_box_append(GTK_BOX(status_bar), state->status_combo);
     gtk_box_append(GTK_BOX(status_bar), update_button);
     gtk_box_append(GTK_BOX(box), status_bar);
-    g_signal_connect(add_button, "clicked", G_CALLBACK(ui_on_add_item), state);
+    g_signal_connect(add_button, "clicked", G_CALLBACK(ui_on_add_to_cart), state);
+    g_signal_connect(send_button, "clicked", G_CALLBACK(ui_on_send_cart), state);
+    g_signal_connect(clear_cart_button, "clicked", G_CALLBACK(ui_on_clear_cart), state);
     g_signal_connect(close_button, "clicked", G_CALLBACK(ui_on_close_order), state);
     g_signal_connect(update_button, "clicked", G_CALLBACK(ui_on_update_status), state);
+    g_signal_connect(state->orders_list, "activate", G_CALLBACK(ui_on_order_activated), state);
     return box;
 }
 
 static GtkWidget *ui_build_reportes(UiState *state) {
     GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     GtkWidget *button = gtk_button_new_with_label("Exportar ventas del día");
+    GtkWidget *compare_button = gtk_button_new_with_label("Comparar con el año anterior");
+    state->sales_label = gtk_label_new("");
     gtk_box_append(GTK_BOX(box), button);
+    gtk_box_append(GTK_BOX(box), compare_button);
+    gtk_box_append(GTK_BOX(box), state->sales_label);
     g_signal_connect(button, "clicked", G_CALLBACK(ui_on_export_report), state);
+    g_signal_connect(compare_button, "clicked", G_CALLBACK(ui_on_compare_sales), state);
+    return box;
+}
+
+static GtkWidget *ui_build_diagnostico(UiState *state) {
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
+    GtkWidget *refresh_button = gtk_button_new_with_label("Actualizar");
+    GtkWidget *metrics_scroll;
+    state->metrics_model = ui_row_model_new();
+    metrics_scroll = ui_row_list_new(state->metrics_model, GTK_ORIENTATION_VERTICAL, NULL);
+    state->metrics_label = gtk_label_new("");
+    gtk_box_append(GTK_BOX(box), gtk_label_new("Latencias por operación y por sentencia"));
+    gtk_box_append(GTK_BOX(box), state->metrics_label);
+    gtk_box_append(GTK_BOX(box), refresh_button);
+    gtk_box_append(GTK_BOX(box), metrics_scroll);
+    g_signal_connect(refresh_button, "clicked", G_CALLBACK(ui_on_refresh_metrics), state);
     return box;
 }
 
@@ -457,12 +1379,18 @@ static GtkWidget *ui_build_reservas(UiState *state) {
     GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
     GtkWidget *form = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
     GtkWidget *add_button = gtk_button_new_with_label("Guardar reserva");
-    state->reservations_list = gtk_list_box_new();
+    GtkWidget *free_button = gtk_button_new_with_label("Mesas libres");
+    GtkWidget *cancel_button = gtk_button_new_with_label("Cancelar reserva");
+    GtkWidget *reservations_scroll;
+    state->reservations_model = ui_row_model_new();
+    reservations_scroll = ui_row_list_new(state->reservations_model, GTK_ORIENTATION_VERTICAL, &state->reservations_list);
     state->reservation_table_selector = GTK_WIDGET(gtk_combo_box_text_new());
     state->reservation_name_entry = gtk_entry_new();
     state->reservation_phone_entry = gtk_entry_new();
     state->reservation_datetime_entry = gtk_entry_new();
     state->reservation_notes_entry = gtk_entry_new();
+    state->reservation_party_spin = gtk_spin_button_new_with_range(1, 20, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(state->reservation_party_spin), 2);
     gtk_entry_set_placeholder_text(GTK_ENTRY(state->reservation_name_entry), "Nombre cliente");
     gtk_entry_set_placeholder_text(GTK_ENTRY(state->reservation_phone_entry), "Teléfono");
     gtk_entry_set_placeholder_text(GTK_ENTRY(state->reservation_datetime_entry), "YYYY-MM-DD HH:MM");
@@ -472,13 +1400,33 @@ static GtkWidget *ui_build_reservas(UiState *state) {
     gtk_box_append(GTK_BOX(form), state->reservation_phone_entry);
     gtk_box_append(GTK_BOX(form), state->reservation_datetime_entry);
     gtk_box_append(GTK_BOX(form), state->reservation_notes_entry);
+    gtk_box_append(GTK_BOX(form), state->reservation_party_spin);
     gtk_box_append(GTK_BOX(form), add_button);
+    gtk_box_append(GTK_BOX(form), free_button);
+    gtk_box_append(GTK_BOX(form), cancel_button);
     gtk_box_append(GTK_BOX(box), form);
-    gtk_box_append(GTK_BOX(box), state->reservations_list);
+    gtk_box_append(GTK_BOX(box), reservations_scroll);
     g_signal_connect(add_button, "clicked", G_CALLBACK(ui_on_add_reservation), state);
+    g_signal_connect(free_button, "clicked", G_CALLBACK(ui_on_find_free_tables), state);
+    g_signal_connect(cancel_button, "clicked", G_CALLBACK(ui_on_cancel_reservation), state);
+    g_signal_connect(reservations_scroll, "edge-reached", G_CALLBACK(ui_on_reservations_edge), state);
     return box;
 }
 
+static void ui_on_destroy(GtkWidget *window, UiState *state) {
+    (void)window;
+    /* Las respuestas que lleguen después no deben tocar widgets destruidos. */
+    dao_async_detach(&state->ctx->async);
+    change_bus_unsubscribe(&state->ctx->changes, state->change_subscription);
+    g_array_unref(state->cart);
+    state->cart = NULL;
+    g_clear_object(&state->tables_model);
+    g_clear_object(&state->orders_model);
+    g_clear_object(&state->order_items_model);
+    g_clear_object(&state->reservations_model);
+    g_clear_object(&state->metrics_model);
+}
+
 GtkWidget *ui_main_window_new(AppContext *ctx, GtkApplication *app) {
     UiState *state = g_new0(UiState, 1);
     GtkWidget *window = gtk_application_window_new(app);
@@ -497,13 +1445,24 @@ GtkWidget *ui_main_window_new(AppContext *ctx, GtkApplication *app) {
     state->content_panel = content_box;
     state->status_label = status_label;
     state->selected_order_id = 0;
+    state->cart = ui_cart_new();
+    state->change_subscription = change_bus_subscribe(&ctx->changes, ui_on_rows_changed, state);
     gtk_stack_sidebar_set_stack(GTK_STACK_SIDEBAR(sidebar), GTK_STACK(stack));
     gtk_box_append(GTK_BOX(content_box), sidebar);
     gtk_box_append(GTK_BOX(content_box), stack);
+    startup_trace_mark(&ctx->trace, "ui_window");
     gtk_stack_add_titled(GTK_STACK(stack), ui_build_salon(state), "salon", "Salón");
+    startup_trace_mark(&ctx->trace, "ui_build_salon");
     gtk_stack_add_titled(GTK_STACK(stack), ui_build_comandas(state), "comandas", "Comandas");
+    startup_trace_mark(&ctx->trace, "ui_build_comandas");
     gtk_stack_add_titled(GTK_STACK(stack), ui_build_reservas(state), "reservas", "Reservas");
+    startup_trace_mark(&ctx->trace, "ui_build_reservas");
     gtk_stack_add_titled(GTK_STACK(stack), ui_build_reportes(state), "reportes", "Reportes");
+    startup_trace_mark(&ctx->trace, "ui_build_reportes");
+    /* Visible solo para administradores; se decide al ingresar. */
+    state->diagnostics_page = gtk_stack_add_titled(GTK_STACK(stack), ui_build_diagnostico(state), "diagnostico", "Diagnóstico");
+    gtk_stack_page_set_visible(state->diagnostics_page, FALSE);
+    g_signal_connect(stack, "notify::visible-child-name", G_CALLBACK(ui_on_page_changed), state);
     login_box = ui_build_login(state);
     gtk_box_append(GTK_BOX(state->login_panel), login_box);
     gtk_box_append(GTK_BOX(main_box), state->login_panel);
@@ -512,6 +1471,7 @@ GtkWidget *ui_main_window_new(AppContext *ctx, GtkApplication *app) {
     gtk_widget_set_visible(content_box, FALSE);
     gtk_window_set_child(GTK_WINDOW(window), main_box);
     g_object_set_data_full(G_OBJECT(window), "ui-state", state, g_free);
+    g_signal_connect(window, "destroy", G_CALLBACK(ui_on_destroy), state);
     return window;
 }
 
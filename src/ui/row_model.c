@@ -0,0 +1,241 @@
+#include "ui/row_model.h"
+
+struct _UiRowItem {
+    GObject parent_instance;
+    int id;
+    char *primary;
+    char *secondary;
+    char *extra;
+};
+
+G_DEFINE_TYPE(UiRowItem, ui_row_item, G_TYPE_OBJECT)
+
+static void ui_row_item_finalize(GObject *object) {
+    UiRowItem *item = UI_ROW_ITEM(object);
+    g_free(item->primary);
+    g_free(item->secondary);
+    g_free(item->extra);
+    G_OBJECT_CLASS(ui_row_item_parent_class)->finalize(object);
+}
+
+static void ui_row_item_class_init(UiRowItemClass *klass) {
+    G_OBJECT_CLASS(klass)->finalize = ui_row_item_finalize;
+}
+
+static void ui_row_item_init(UiRowItem *item) {
+    (void)item;
+}
+
+void ui_text_row_clear(gpointer data) {
+    UiTextRow *row = (UiTextRow *)data;
+    g_free(row->primary);
+    g_free(row->secondary);
+    g_free(row->extra);
+}
+
+struct _UiRowModel {
+    GObject parent_instance;
+    GArray *rows;
+};
+
+static GType ui_row_model_get_item_type(GListModel *list) {
+    (void)list;
+    return UI_TYPE_ROW_ITEM;
+}
+
+static guint ui_row_model_get_n_items(GListModel *list) {
+    return UI_ROW_MODEL(list)->rows->len;
+}
+
+/* Solo se llama para las posiciones que la vista va a mostrar. */
+static gpointer ui_row_model_get_item(GListModel *list, guint position) {
+    UiRowModel *model = UI_ROW_MODEL(list);
+    UiTextRow *row = NULL;
+    UiRowItem *item = NULL;
+    if (position >= model->rows->len) {
+        return NULL;
+    }
+    row = &g_array_index(model->rows, UiTextRow, position);
+    item = g_object_new(UI_TYPE_ROW_ITEM, NULL);
+    item->id = row->id;
+    item->primary = g_strdup(row->primary);
+    item->secondary = g_strdup(row->secondary);
+    item->extra = g_strdup(row->extra);
+    return item;
+}
+
+static void ui_row_model_list_model_init(GListModelInterface *iface) {
+    iface->get_item_type = ui_row_model_get_item_type;
+    iface->get_n_items = ui_row_model_get_n_items;
+    iface->get_item = ui_row_model_get_item;
+}
+
+G_DEFINE_TYPE_WITH_CODE(UiRowModel, ui_row_model, G_TYPE_OBJECT, G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL, ui_row_model_list_model_init))
+
+static GArray *ui_row_model_new_rows(void) {
+    GArray *rows = g_array_new(FALSE, TRUE, sizeof(UiTextRow));
+    g_array_set_clear_func(rows, ui_text_row_clear);
+    return rows;
+}
+
+static void ui_row_model_finalize(GObject *object) {
+    g_array_unref(UI_ROW_MODEL(object)->rows);
+    G_OBJECT_CLASS(ui_row_model_parent_class)->finalize(object);
+}
+
+static void ui_row_model_class_init(UiRowModelClass *klass) {
+    G_OBJECT_CLASS(klass)->finalize = ui_row_model_finalize;
+}
+
+static void ui_row_model_init(UiRowModel *model) {
+    model->rows = ui_row_model_new_rows();
+}
+
+UiRowModel *ui_row_model_new(void) {
+    return g_object_new(UI_TYPE_ROW_MODEL, NULL);
+}
+
+void ui_row_model_set_rows(UiRowModel *model, GArray *rows) {
+    guint removed = model->rows->len;
+    GArray *previous = model->rows;
+    model->rows = g_array_ref(rows);
+    g_array_unref(previous);
+    g_array_set_clear_func(model->rows, ui_text_row_clear);
+    g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, model->rows->len);
+}
+
+void ui_row_model_clear(UiRowModel *model) {
+    guint removed = model->rows->len;
+    if (removed == 0) {
+        return;
+    }
+    g_array_unref(model->rows);
+    model->rows = ui_row_model_new_rows();
+    g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, 0);
+}
+
+void ui_row_model_append_rows(UiRowModel *model, GArray *rows) {
+    guint position = model->rows->len;
+    guint index = 0;
+    if (rows->len == 0) {
+        return;
+    }
+    while (index < rows->len) {
+        UiTextRow *row = &g_array_index(rows, UiTextRow, index);
+        UiTextRow copy = *row;
+        row->primary = NULL;
+        row->secondary = NULL;
+        row->extra = NULL;
+        g_array_append_val(model->rows, copy);
+        index = index + 1;
+    }
+    g_list_model_items_changed(G_LIST_MODEL(model), position, 0, rows->len);
+}
+
+static bool ui_row_model_find(UiRowModel *model, int id, guint *position) {
+    guint index = 0;
+    while (index < model->rows->len) {
+        if (g_array_index(model->rows, UiTextRow, index).id == id) {
+            *position = index;
+            return true;
+        }
+        index = index + 1;
+    }
+    return false;
+}
+
+void ui_row_model_upsert(UiRowModel *model, UiTextRow *row, bool prepend) {
+    guint position = 0;
+    UiTextRow copy = *row;
+    row->primary = NULL;
+    row->secondary = NULL;
+    row->extra = NULL;
+    if (ui_row_model_find(model, copy.id, &position)) {
+        ui_text_row_clear(&g_array_index(model->rows, UiTextRow, position));
+        g_array_index(model->rows, UiTextRow, position) = copy;
+        g_list_model_items_changed(G_LIST_MODEL(model), position, 1, 1);
+    } else if (prepend) {
+        g_array_prepend_val(model->rows, copy);
+        g_list_model_items_changed(G_LIST_MODEL(model), 0, 0, 1);
+    } else {
+        g_array_append_val(model->rows, copy);
+        g_list_model_items_changed(G_LIST_MODEL(model), model->rows->len - 1, 0, 1);
+    }
+}
+
+void ui_row_model_remove(UiRowModel *model, int id) {
+    guint position = 0;
+    if (!ui_row_model_find(model, id, &position)) {
+        return;
+    }
+    g_array_remove_index(model->rows, position);
+    g_list_model_items_changed(G_LIST_MODEL(model), position, 1, 0);
+}
+
+const UiTextRow *ui_row_model_get_row(UiRowModel *model, guint position) {
+    if (position >= model->rows->len) {
+        return NULL;
+    }
+    return &g_array_index(model->rows, UiTextRow, position);
+}
+
+guint ui_row_model_get_count(UiRowModel *model) {
+    return model->rows->len;
+}
+
+static void ui_row_factory_setup(GtkSignalListItemFactory *factory, GtkListItem *list_item, gpointer user_data) {
+    GtkOrientation orientation = (GtkOrientation)GPOINTER_TO_INT(user_data);
+    GtkWidget *box = gtk_box_new(orientation, orientation == GTK_ORIENTATION_VERTICAL ? 4 : 8);
+    int index = 0;
+    (void)factory;
+    while (index < 3) {
+        GtkWidget *label = gtk_label_new(NULL);
+        gtk_label_set_xalign(GTK_LABEL(label), 0.0f);
+        gtk_box_append(GTK_BOX(box), label);
+        index = index + 1;
+    }
+    gtk_list_item_set_child(list_item, box);
+}
+
+static void ui_row_factory_set_label(GtkWidget *label, const char *text) {
+    gtk_label_set_text(GTK_LABEL(label), text != NULL ? text : "");
+    gtk_widget_set_visible(label, text != NULL);
+}
+
+/* El widget se recicla entre filas: bind solo cambia los textos. */
+static void ui_row_factory_bind(GtkSignalListItemFactory *factory, GtkListItem *list_item, gpointer user_data) {
+    UiRowItem *item = UI_ROW_ITEM(gtk_list_item_get_item(list_item));
+    GtkWidget *label = gtk_widget_get_first_child(gtk_list_item_get_child(list_item));
+    (void)factory;
+    (void)user_data;
+    ui_row_factory_set_label(label, item->primary);
+    label = gtk_widget_get_next_sibling(label);
+    ui_row_factory_set_label(label, item->secondary);
+    label = gtk_widget_get_next_sibling(label);
+    ui_row_factory_set_label(label, item->extra);
+}
+
+GtkListItemFactory *ui_row_factory_new(GtkOrientation orientation) {
+    GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
+    g_signal_connect(factory, "setup", G_CALLBACK(ui_row_factory_setup), GINT_TO_POINTER(orientation));
+    g_signal_connect(factory, "bind", G_CALLBACK(ui_row_factory_bind), NULL);
+    return factory;
+}
+
+GtkWidget *ui_row_list_new(UiRowModel *model, GtkOrientation orientation, GtkWidget **list_view) {
+    GtkWidget *scrolled = gtk_scrolled_window_new();
+    GtkSelectionModel *selection = GTK_SELECTION_MODEL(gtk_single_selection_new(G_LIST_MODEL(g_object_ref(model))));
+    GtkWidget *view = gtk_list_view_new(selection, ui_row_factory_new(orientation));
+    gtk_single_selection_set_autoselect(GTK_SINGLE_SELECTION(selection), FALSE);
+    gtk_single_selection_set_can_unselect(GTK_SINGLE_SELECTION(selection), TRUE);
+    /* Sin alto acotado la vista se estira y materializa todas las filas. */
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_min_content_height(GTK_SCROLLED_WINDOW(scrolled), 160);
+    gtk_widget_set_vexpand(scrolled, TRUE);
+    gtk_widget_set_hexpand(scrolled, TRUE);
+    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), view);
+    if (list_view != NULL) {
+        *list_view = view;
+    }
+    return scrolled;
+}
@@ -0,0 +1,154 @@
+#include "util/arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+#define ARENA_ALIGN (sizeof(max_align_t))
+
+static size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+void arena_init(Arena *arena, size_t block_size) {
+    if (arena == NULL) {
+        return;
+    }
+    memset(arena, 0, sizeof(Arena));
+    arena->block_size = block_size < 1024 ? 1024 : block_size;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    ArenaBlock *block;
+    size_t aligned = arena_align(size == 0 ? 1 : size);
+    void *result;
+    if (arena == NULL) {
+        return NULL;
+    }
+    block = arena->head;
+    if (block == NULL || block->size - block->used < aligned) {
+        size_t block_size = aligned > arena->block_size ? aligned : arena->block_size;
+        block = malloc(sizeof(ArenaBlock) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->size = block_size;
+        block->used = 0;
+        block->next = arena->head;
+        arena->head = block;
+        arena->bytes_reserved = arena->bytes_reserved + sizeof(ArenaBlock) + block_size;
+    }
+    result = (unsigned char *)block->data + block->used;
+    block->used = block->used + aligned;
+    arena->bytes_used = arena->bytes_used + aligned;
+    return result;
+}
+
+char *arena_strdup(Arena *arena, const char *text) {
+    size_t len;
+    char *copy;
+    if (text == NULL) {
+        return NULL;
+    }
+    len = strlen(text);
+    copy = arena_alloc(arena, len + 1);
+    if (copy != NULL) {
+        memcpy(copy, text, len + 1);
+    }
+    return copy;
+}
+
+void arena_free(Arena *arena) {
+    ArenaBlock *block;
+    if (arena == NULL) {
+        return;
+    }
+    block = arena->head;
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->bytes_reserved = 0;
+    arena->bytes_used = 0;
+}
+
+void arena_interner_init(ArenaInterner *interner) {
+    if (interner == NULL) {
+        return;
+    }
+    memset(interner, 0, sizeof(ArenaInterner));
+}
+
+static uint32_t arena_hash(const char *text) {
+    uint32_t hash = 2166136261u;
+    while (*text != '\0') {
+        hash = (hash ^ (unsigned char)*text) * 16777619u;
+        text = text + 1;
+    }
+    return hash;
+}
+
+static bool arena_interner_grow(ArenaInterner *interner) {
+    size_t new_capacity = interner->capacity == 0 ? 64 : interner->capacity * 2;
+    const char **new_slots = calloc(new_capacity, sizeof(const char *));
+    size_t index = 0;
+    if (new_slots == NULL) {
+        return false;
+    }
+    while (index < interner->capacity) {
+        const char *text = interner->slots[index];
+        if (text != NULL) {
+            size_t slot = arena_hash(text) & (new_capacity - 1);
+            while (new_slots[slot] != NULL) {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+            new_slots[slot] = text;
+        }
+        index = index + 1;
+    }
+    free(interner->slots);
+    interner->slots = new_slots;
+    interner->capacity = new_capacity;
+    return true;
+}
+
+const char *arena_intern(ArenaInterner *interner, Arena *arena, const char *text) {
+    size_t slot;
+    char *copy;
+    if (interner == NULL || text == NULL) {
+        return NULL;
+    }
+    if ((interner->count + 1) * 10 > interner->capacity * 7 && !arena_interner_grow(interner)) {
+        return arena_strdup(arena, text);
+    }
+    slot = arena_hash(text) & (interner->capacity - 1);
+    while (interner->slots[slot] != NULL) {
+        if (strcmp(interner->slots[slot], text) == 0) {
+            return interner->slots[slot];
+        }
+        slot = (slot + 1) & (interner->capacity - 1);
+    }
+    copy = arena_strdup(arena, text);
+    if (copy == NULL) {
+        return NULL;
+    }
+    interner->slots[slot] = copy;
+    interner->count = interner->count + 1;
+    return copy;
+}
+
+void arena_interner_free(ArenaInterner *interner) {
+    if (interner == NULL) {
+        return;
+    }
+    free(interner->slots);
+    memset(interner, 0, sizeof(ArenaInterner));
+}
@@ -21,6 +21,29 @@ void config_default(AppConfig *config) {
     strcpy(config->currency, "ARS");
     config->tax_rate = 0.21;
     strcpy(config->receipt_output_dir, "receipts");
+    strcpy(config->storage.journal_mode, "WAL");
+    strcpy(config->storage.synchronous, "NORMAL");
+    config->storage.cache_size_kib = 16384;
+    config->storage.mmap_size = 134217728;
+    strcpy(config->storage.temp_store, "MEMORY");
+    config->storage.busy_timeout_ms = 5000;
+    strcpy(config->storage.auto_vacuum, "INCREMENTAL");
+    config->storage.maintenance_interval_s = 30;
+    config->storage.read_connections = 2;
+    config->status_queue.flush_interval_ms = 250;
+    config->status_queue.max_entries = 64;
+    config->status_queue.max_delay_ms = 1000;
+    config->kitchen_poll_ms = 1000;
+    config->reservations_window_days = 7;
+    config->reservation_seating_min = 120;
+    strcpy(config->log.level, "INFO");
+    strcpy(config->log.format, "text");
+    config->log.async = true;
+    config->log.buffer_records = 1024;
+    strcpy(config->log.overflow, "drop");
+    strcpy(config->metrics.path, "logs/metrics.prom");
+    strcpy(config->metrics.format, "prometheus");
+    config->metrics.dump_interval_s = 60;
 }
 
 bool config_load(AppConfig *config, const char *path) {
@@ -60,6 +83,61 @@ bool config_load(AppConfig *config, const char *path) {
         } else if (strcmp(buffer, "receipt_output_dir") == 0) {
             strncpy(config->receipt_output_dir, equals, sizeof(config->receipt_output_dir) - 1);
             config->receipt_output_dir[sizeof(config->receipt_output_dir) - 1] = '\0';
+        } else if (strcmp(buffer, "journal_mode") == 0) {
+            strncpy(config->storage.journal_mode, equals, sizeof(config->storage.journal_mode) - 1);
+            config->storage.journal_mode[sizeof(config->storage.journal_mode) - 1] = '\0';
+        } else if (strcmp(buffer, "synchronous") == 0) {
+            strncpy(config->storage.synchronous, equals, sizeof(config->storage.synchronous) - 1);
+            config->storage.synchronous[sizeof(config->storage.synchronous) - 1] = '\0';
+        } else if (strcmp(buffer, "cache_size_kib") == 0) {
+            config->storage.cache_size_kib = atoi(equals);
+        } else if (strcmp(buffer, "mmap_size") == 0) {
+            config->storage.mmap_size = atoll(equals);
+        } else if (strcmp(buffer, "temp_store") == 0) {
+            strncpy(config->storage.temp_store, equals, sizeof(config->storage.temp_store) - 1);
+            config->storage.temp_store[sizeof(config->storage.temp_store) - 1] = '\0';
+        } else if (strcmp(buffer, "busy_timeout_ms") == 0) {
+            config->storage.busy_timeout_ms = atoi(equals);
+        } else if (strcmp(buffer, "auto_vacuum") == 0) {
+            strncpy(config->storage.auto_vacuum, equals, sizeof(config->storage.auto_vacuum) - 1);
+            config->storage.auto_vacuum[sizeof(config->storage.auto_vacuum) - 1] = '\0';
+        } else if (strcmp(buffer, "maintenance_interval_s") == 0) {
+            config->storage.maintenance_interval_s = atoi(equals);
+        } else if (strcmp(buffer, "read_connections") == 0) {
+            config->storage.read_connections = atoi(equals);
+        } else if (strcmp(buffer, "status_flush_interval_ms") == 0) {
+            config->status_queue.flush_interval_ms = atoi(equals);
+        } else if (strcmp(buffer, "status_flush_max_entries") == 0) {
+            config->status_queue.max_entries = atoi(equals);
+        } else if (strcmp(buffer, "status_max_delay_ms") == 0) {
+            config->status_queue.max_delay_ms = atoi(equals);
+        } else if (strcmp(buffer, "kitchen_poll_ms") == 0) {
+            config->kitchen_poll_ms = atoi(equals);
+        } else if (strcmp(buffer, "reservations_window_days") == 0) {
+            config->reservations_window_days = atoi(equals);
+        } else if (strcmp(buffer, "reservation_seating_min") == 0) {
+            config->reservation_seating_min = atoi(equals);
+        } else if (strcmp(buffer, "log_level") == 0) {
+            strncpy(config->log.level, equals, sizeof(config->log.level) - 1);
+            config->log.level[sizeof(config->log.level) - 1] = '\0';
+        } else if (strcmp(buffer, "log_format") == 0) {
+            strncpy(config->log.format, equals, sizeof(config->log.format) - 1);
+            config->log.format[sizeof(config->log.format) - 1] = '\0';
+        } else if (strcmp(buffer, "log_async") == 0) {
+            config->log.async = atoi(equals) != 0;
+        } else if (strcmp(buffer, "log_buffer_records") == 0) {
+            config->log.buffer_records = atoi(equals);
+        } else if (strcmp(buffer, "log_overflow") == 0) {
+            strncpy(config->log.overflow, equals, sizeof(config->log.overflow) - 1);
+            config->log.overflow[sizeof(config->log.overflow) - 1] = '\0';
+        } else if (strcmp(buffer, "metrics_path") == 0) {
+            strncpy(config->metrics.path, equals, sizeof(config->metrics.path) - 1);
+            config->metrics.path[sizeof(config->metrics.path) - 1] = '\0';
+        } else if (strcmp(buffer, "metrics_format") == 0) {
+            strncpy(config->metrics.format, equals, sizeof(config->metrics.format) - 1);
+            config->metrics.format[sizeof(config->metrics.format) - 1] = '\0';
+        } else if (strcmp(buffer, "metrics_dump_interval_s") == 0) {
+            config->metrics.dump_interval_s = atoi(equals);
         }
     }
     fclose(file);
@@ -80,6 +158,29 @@ bool config_save(const AppConfig *config, const char *path) {
     fprintf(file, "currency=%s\n", config->currency);
     fprintf(file, "tax_rate=%.4f\n", config->tax_rate);
     fprintf(file, "receipt_output_dir=%s\n", config->receipt_output_dir);
+    fprintf(file, "journal_mode=%s\n", config->storage.journal_mode);
+    fprintf(file, "synchronous=%s\n", config->storage.synchronous);
+    fprintf(file, "cache_size_kib=%d\n", config->storage.cache_size_kib);
+    fprintf(file, "mmap_size=%lld\n", config->storage.mmap_size);
+    fprintf(file, "temp_store=%s\n", config->storage.temp_store);
+    fprintf(file, "busy_timeout_ms=%d\n", config->storage.busy_timeout_ms);
+    fprintf(file, "auto_vacuum=%s\n", config->storage.auto_vacuum);
+    fprintf(file, "maintenance_interval_s=%d\n", config->storage.maintenance_interval_s);
+    fprintf(file, "read_connections=%d\n", config->storage.read_connections);
+    fprintf(file, "status_flush_interval_ms=%d\n", config->status_queue.flush_interval_ms);
+    fprintf(file, "status_flush_max_entries=%d\n", config->status_queue.max_entries);
+    fprintf(file, "status_max_delay_ms=%d\n", config->status_queue.max_delay_ms);
+    fprintf(file, "kitchen_poll_ms=%d\n", config->kitchen_poll_ms);
+    fprintf(file, "reservations_window_days=%d\n", config->reservations_window_days);
+    fprintf(file, "reservation_seating_min=%d\n", config->reservation_seating_min);
+    fprintf(file, "log_level=%s\n", config->log.level);
+    fprintf(file, "log_format=%s\n", config->log.format);
+    fprintf(file, "log_async=%d\n", config->log.async ? 1 : 0);
+    fprintf(file, "log_buffer_records=%d\n", config->log.buffer_records);
+    fprintf(file, "log_overflow=%s\n", config->log.overflow);
+    fprintf(file, "metrics_path=%s\n", config->metrics.path);
+    fprintf(file, "metrics_format=%s\n", config->metrics.format);
+    fprintf(file, "metrics_dump_interval_s=%d\n", config->metrics.dump_interval_s);
     fclose(file);
     return true;
 }
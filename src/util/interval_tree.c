@@ -0,0 +1,208 @@
+#include "util/interval_tree.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct IntervalNode {
+    IntervalNode *left;
+    IntervalNode *right;
+    long long start;
+    long long end;
+    long long max_end;
+    int id;
+    int height;
+};
+
+static int interval_height(const IntervalNode *node) {
+    return node != NULL ? node->height : 0;
+}
+
+static void interval_update(IntervalNode *node) {
+    int left = interval_height(node->left);
+    int right = interval_height(node->right);
+    node->height = 1 + (left > right ? left : right);
+    node->max_end = node->end;
+    if (node->left != NULL && node->left->max_end > node->max_end) {
+        node->max_end = node->left->max_end;
+    }
+    if (node->right != NULL && node->right->max_end > node->max_end) {
+        node->max_end = node->right->max_end;
+    }
+}
+
+static IntervalNode *interval_rotate_right(IntervalNode *node) {
+    IntervalNode *pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    interval_update(node);
+    interval_update(pivot);
+    return pivot;
+}
+
+static IntervalNode *interval_rotate_left(IntervalNode *node) {
+    IntervalNode *pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    interval_update(node);
+    interval_update(pivot);
+    return pivot;
+}
+
+static IntervalNode *interval_balance(IntervalNode *node) {
+    int factor;
+    interval_update(node);
+    factor = interval_height(node->left) - interval_height(node->right);
+    if (factor > 1) {
+        if (interval_height(node->left->left) < interval_height(node->left->right)) {
+            node->left = interval_rotate_left(node->left);
+        }
+        return interval_rotate_right(node);
+    }
+    if (factor < -1) {
+        if (interval_height(node->right->right) < interval_height(node->right->left)) {
+            node->right = interval_rotate_right(node->right);
+        }
+        return interval_rotate_left(node);
+    }
+    return node;
+}
+
+static int interval_compare(long long start, int id, const IntervalNode *node) {
+    if (start != node->start) {
+        return start < node->start ? -1 : 1;
+    }
+    if (id != node->id) {
+        return id < node->id ? -1 : 1;
+    }
+    return 0;
+}
+
+static IntervalNode *interval_insert(IntervalNode *node, IntervalNode *created, bool *inserted) {
+    int order;
+    if (node == NULL) {
+        *inserted = true;
+        return created;
+    }
+    order = interval_compare(created->start, created->id, node);
+    if (order < 0) {
+        node->left = interval_insert(node->left, created, inserted);
+    } else if (order > 0) {
+        node->right = interval_insert(node->right, created, inserted);
+    } else {
+        return node;
+    }
+    return interval_balance(node);
+}
+
+static IntervalNode *interval_remove(IntervalNode *node, long long start, int id, bool *removed) {
+    int order;
+    if (node == NULL) {
+        return NULL;
+    }
+    order = interval_compare(start, id, node);
+    if (order < 0) {
+        node->left = interval_remove(node->left, start, id, removed);
+    } else if (order > 0) {
+        node->right = interval_remove(node->right, start, id, removed);
+    } else {
+        IntervalNode *successor = NULL;
+        bool ignored = false;
+        *removed = true;
+        if (node->left == NULL || node->right == NULL) {
+            IntervalNode *child = node->left != NULL ? node->left : node->right;
+            free(node);
+            return child;
+        }
+        /* Dos hijos: el nodo toma los datos del sucesor y se quita el sucesor. */
+        successor = node->right;
+        while (successor->left != NULL) {
+            successor = successor->left;
+        }
+        node->start = successor->start;
+        node->end = successor->end;
+        node->id = successor->id;
+        node->right = interval_remove(node->right, successor->start, successor->id, &ignored);
+    }
+    return interval_balance(node);
+}
+
+static void interval_free(IntervalNode *node) {
+    if (node == NULL) {
+        return;
+    }
+    interval_free(node->left);
+    interval_free(node->right);
+    free(node);
+}
+
+void interval_tree_init(IntervalTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    memset(tree, 0, sizeof(IntervalTree));
+}
+
+bool interval_tree_insert(IntervalTree *tree, long long start, long long end, int id) {
+    IntervalNode *created = NULL;
+    bool inserted = false;
+    if (end <= start) {
+        return false;
+    }
+    created = calloc(1, sizeof(IntervalNode));
+    if (created == NULL) {
+        return false;
+    }
+    created->start = start;
+    created->end = end;
+    created->max_end = end;
+    created->id = id;
+    created->height = 1;
+    tree->root = interval_insert(tree->root, created, &inserted);
+    if (!inserted) {
+        free(created);
+        return false;
+    }
+    tree->count = tree->count + 1;
+    return true;
+}
+
+bool interval_tree_remove(IntervalTree *tree, long long start, int id) {
+    bool removed = false;
+    tree->root = interval_remove(tree->root, start, id, &removed);
+    if (removed) {
+        tree->count = tree->count - 1;
+    }
+    return removed;
+}
+
+/*
+ * Si el subárbol izquierdo termina después de start y no hay solapamiento ahí,
+ * su intervalo que termina más tarde empieza en o después de end, y todo el
+ * subárbol derecho también: basta con bajar por una sola rama.
+ */
+bool interval_tree_find_overlap(const IntervalTree *tree, long long start, long long end, int *id) {
+    const IntervalNode *node = tree->root;
+    while (node != NULL && node->max_end > start) {
+        if (node->start < end && node->end > start) {
+            if (id != NULL) {
+                *id = node->id;
+            }
+            return true;
+        }
+        if (node->left != NULL && node->left->max_end > start) {
+            node = node->left;
+        } else if (node->start >= end) {
+            return false;
+        } else {
+            node = node->right;
+        }
+    }
+    return false;
+}
+
+void interval_tree_clear(IntervalTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    interval_free(tree->root);
+    memset(tree, 0, sizeof(IntervalTree));
+}
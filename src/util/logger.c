@@ -1,7 +1,9 @@
 #include "util/logger.h"
+#include <math.h>
 #include <string.h>
 #include <time.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <sys/stat.h>
 #include <errno.h>
 #include <stdio.h>
@@ -9,6 +11,12 @@
 #include <direct.h>
 #endif
 
+#define LOGGER_BATCH_MAX 256
+#define LOGGER_IDLE_WAIT_US 200000
+/* Campos codificados en el registro: clave, tipo y valor separados por US, cada campo cerrado por RS. */
+#define LOGGER_FIELD_SEP '\x1f'
+#define LOGGER_FIELD_END '\x1e'
+
 static void logger_close_file(Logger *logger) {
     if (logger->file != NULL) {
         fclose(logger->file);
@@ -32,32 +40,42 @@ static bool logger_create_directory(const char *path) {
 #endif
 }
 
-static void logger_filename_for_today(char *buffer, size_t buffer_len) {
-    time_t now = time(NULL);
-    struct tm tm_now;
+static void logger_local_time(time_t when, struct tm *tm_when) {
 #ifdef _WIN32
-    localtime_s(&tm_now, &now);
+    localtime_s(tm_when, &when);
 #else
-    localtime_r(&now, &tm_now);
+    localtime_r(&when, tm_when);
 #endif
+}
+
+static void logger_filename_for_today(char *buffer, size_t buffer_len) {
+    struct tm tm_now;
+    logger_local_time(time(NULL), &tm_now);
     strftime(buffer, buffer_len, "%Y-%m-%d", &tm_now);
 }
 
-bool logger_init(Logger *logger, const char *directory, LogLevel level) {
+static void logger_open_file(Logger *logger) {
     char filename[1024];
+    snprintf(filename, sizeof(filename), "%s/%s.%s", logger->directory, logger->current_date, logger->format == LOG_FORMAT_JSON ? "jsonl" : "log");
+    logger->file = fopen(filename, "a");
+}
+
+bool logger_init(Logger *logger, const char *directory, LogLevel level) {
     if (logger == NULL) {
         return false;
     }
     memset(logger, 0, sizeof(Logger));
+    g_mutex_init(&logger->lock);
+    g_cond_init(&logger->wake);
     logger->level = level;
+    logger->stamp_second = -1;
     strncpy(logger->directory, directory, sizeof(logger->directory) - 1);
     logger->directory[sizeof(logger->directory) - 1] = '\0';
     if (!logger_create_directory(directory)) {
         return false;
     }
     logger_filename_for_today(logger->current_date, sizeof(logger->current_date));
-    snprintf(filename, sizeof(filename), "%s/%s.log", directory, logger->current_date);
-    logger->file = fopen(filename, "a");
+    logger_open_file(logger);
     if (logger->file == NULL) {
         return false;
     }
@@ -71,19 +89,73 @@ void logger_set_level(Logger *logger, LogLevel level) {
     logger->level = level;
 }
 
-static void logger_rotate_if_needed(Logger *logger) {
+bool logger_set_format(Logger *logger, LogFormat format) {
+    bool opened;
+    if (logger == NULL || logger->async) {
+        return false;
+    }
+    g_mutex_lock(&logger->lock);
+    if (logger->format != format) {
+        logger_close_file(logger);
+        logger->format = format;
+        logger_open_file(logger);
+    }
+    opened = logger->file != NULL;
+    g_mutex_unlock(&logger->lock);
+    return opened;
+}
+
+LogFormat logger_format_from_string(const char *text) {
+    if (text != NULL && g_ascii_strcasecmp(text, "json") == 0) {
+        return LOG_FORMAT_JSON;
+    }
+    return LOG_FORMAT_TEXT;
+}
+
+bool logger_enabled(const Logger *logger, LogLevel level) {
+    return logger != NULL && level >= logger->level;
+}
+
+LogLevel logger_level_from_string(const char *text, LogLevel fallback) {
+    if (text == NULL) {
+        return fallback;
+    }
+    if (g_ascii_strcasecmp(text, "DEBUG") == 0) {
+        return LOG_LEVEL_DEBUG;
+    }
+    if (g_ascii_strcasecmp(text, "INFO") == 0) {
+        return LOG_LEVEL_INFO;
+    }
+    if (g_ascii_strcasecmp(text, "WARN") == 0) {
+        return LOG_LEVEL_WARN;
+    }
+    if (g_ascii_strcasecmp(text, "ERROR") == 0) {
+        return LOG_LEVEL_ERROR;
+    }
+    return fallback;
+}
+
+/*
+ * Hora y fecha se recalculan una vez por segundo, no por línea; al cambiar el
+ * día se rota el archivo. Se llama con el lock tomado.
+ */
+static void logger_stamp(Logger *logger, gint64 time_us) {
+    gint64 second = time_us / G_USEC_PER_SEC;
+    struct tm tm_now;
     char today[16];
-    if (logger == NULL) {
+    if (second == logger->stamp_second) {
         return;
     }
-    logger_filename_for_today(today, sizeof(today));
+    logger->stamp_second = second;
+    logger_local_time((time_t)second, &tm_now);
+    strftime(logger->stamp_time, sizeof(logger->stamp_time), "%H:%M:%S", &tm_now);
+    strftime(logger->stamp_date_time, sizeof(logger->stamp_date_time), "%Y-%m-%dT%H:%M:%S", &tm_now);
+    strftime(today, sizeof(today), "%Y-%m-%d", &tm_now);
     if (strcmp(today, logger->current_date) != 0) {
-        char filename[1024];
         logger_close_file(logger);
         strncpy(logger->current_date, today, sizeof(logger->current_date) - 1);
         logger->current_date[sizeof(logger->current_date) - 1] = '\0';
-        snprintf(filename, sizeof(filename), "%s/%s.log", logger->directory, logger->current_date);
-        logger->file = fopen(filename, "a");
+        logger_open_file(logger);
     }
 }
 
@@ -100,34 +172,317 @@ static const char *logger_level_to_string(LogLevel level) {
     return "ERROR";
 }
 
-void logger_log(Logger *logger, LogLevel level, const char *component, const char *message) {
-    time_t now;
-    struct tm tm_now;
-    char timestamp[32];
+/* Los campos se copian ya convertidos a texto; el formato final lo arma quien escribe. */
+static void logger_encode_fields(char *buffer, size_t buffer_len, const LogField *fields, int field_count) {
+    size_t used = 0;
+    int index = 0;
+    buffer[0] = '\0';
+    while (index < field_count) {
+        const LogField *field = &fields[index];
+        char value[128];
+        char type = 's';
+        int length;
+        if (field->type == LOG_FIELD_INT) {
+            snprintf(value, sizeof(value), "%lld", field->int_value);
+            type = 'n';
+        } else if (field->type == LOG_FIELD_DOUBLE && isfinite(field->double_value)) {
+            snprintf(value, sizeof(value), "%.10g", field->double_value);
+            type = 'n';
+        } else if (field->type == LOG_FIELD_DOUBLE) {
+            g_strlcpy(value, "NaN", sizeof(value));
+        } else {
+            g_strlcpy(value, field->string_value != NULL ? field->string_value : "", sizeof(value));
+        }
+        length = snprintf(buffer + used, buffer_len - used, "%s%c%c%c%s%c", field->key, LOGGER_FIELD_SEP, type, LOGGER_FIELD_SEP, value, LOGGER_FIELD_END);
+        if (length < 0 || (size_t)length >= buffer_len - used) {
+            buffer[used] = '\0';
+            return;
+        }
+        used = used + (size_t)length;
+        index = index + 1;
+    }
+}
+
+static void logger_write_json_string(FILE *file, const char *text, const char *end) {
+    fputc('"', file);
+    while (text < end && *text != '\0') {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc((int)c, file);
+        } else if (c == '\n') {
+            fputs("\\n", file);
+        } else if (c == '\t') {
+            fputs("\\t", file);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc((int)c, file);
+        }
+        text = text + 1;
+    }
+    fputc('"', file);
+}
+
+/* Recorre los campos codificados y los escribe como " k=v" o como miembros JSON. */
+static void logger_write_fields(Logger *logger, const char *fields) {
+    const char *cursor = fields;
+    while (*cursor != '\0') {
+        const char *key_end = strchr(cursor, LOGGER_FIELD_SEP);
+        const char *value = NULL;
+        const char *value_end = NULL;
+        char type;
+        if (key_end == NULL || key_end[1] == '\0' || key_end[2] != LOGGER_FIELD_SEP) {
+            return;
+        }
+        type = key_end[1];
+        value = key_end + 3;
+        value_end = strchr(value, LOGGER_FIELD_END);
+        if (value_end == NULL) {
+            return;
+        }
+        if (logger->format == LOG_FORMAT_JSON) {
+            fputc(',', logger->file);
+            logger_write_json_string(logger->file, cursor, key_end);
+            fputc(':', logger->file);
+            if (type == 'n') {
+                fwrite(value, 1, (size_t)(value_end - value), logger->file);
+            } else {
+                logger_write_json_string(logger->file, value, value_end);
+            }
+        } else if (type == 's' && (value == value_end || memchr(value, ' ', (size_t)(value_end - value)) != NULL)) {
+            fprintf(logger->file, " %.*s=\"%.*s\"", (int)(key_end - cursor), cursor, (int)(value_end - value), value);
+        } else {
+            fprintf(logger->file, " %.*s=%.*s", (int)(key_end - cursor), cursor, (int)(value_end - value), value);
+        }
+        cursor = value_end + 1;
+    }
+}
+
+static void logger_write_line(Logger *logger, gint64 time_us, LogLevel level, const char *component, const char *message, const char *fields) {
+    logger_stamp(logger, time_us);
+    if (logger->file == NULL) {
+        return;
+    }
+    if (logger->format == LOG_FORMAT_JSON) {
+        fprintf(logger->file, "{\"ts\":\"%s.%03d\",\"level\":\"%s\",\"component\":", logger->stamp_date_time, (int)((time_us % G_USEC_PER_SEC) / 1000),
+                logger_level_to_string(level));
+        logger_write_json_string(logger->file, component, component + strlen(component));
+        fputs(",\"msg\":", logger->file);
+        logger_write_json_string(logger->file, message, message + strlen(message));
+        logger_write_fields(logger, fields);
+        fputs("}\n", logger->file);
+    } else {
+        fprintf(logger->file, "%s [%s] %s: %s", logger->stamp_time, logger_level_to_string(level), component, message);
+        logger_write_fields(logger, fields);
+        fputc('\n', logger->file);
+    }
+    logger->written = logger->written + 1;
+}
+
+static bool logger_ring_init(LogRing *ring, int records) {
+    guint capacity = 16;
+    guint index = 0;
+    while (capacity < (guint)records && capacity < (1u << 20)) {
+        capacity = capacity * 2;
+    }
+    ring->slots = calloc(capacity, sizeof(LogRecord));
+    if (ring->slots == NULL) {
+        return false;
+    }
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    while (index < capacity) {
+        ring->slots[index].sequence = (gint)index;
+        index = index + 1;
+    }
+    return true;
+}
+
+/* false si el buffer está lleno. Las posiciones dan la vuelta: se comparan por diferencia. */
+static bool logger_ring_push(LogRing *ring, LogLevel level, gint64 time_us, const char *component, const char *message, const LogField *fields, int field_count) {
+    guint position = (guint)g_atomic_int_get(&ring->head);
+    LogRecord *slot = NULL;
+    while (true) {
+        gint distance;
+        slot = &ring->slots[position & ring->mask];
+        distance = (gint)((guint)g_atomic_int_get(&slot->sequence) - position);
+        if (distance == 0) {
+            if (g_atomic_int_compare_and_exchange(&ring->head, (gint)position, (gint)(position + 1))) {
+                break;
+            }
+            position = (guint)g_atomic_int_get(&ring->head);
+        } else if (distance < 0) {
+            return false;
+        } else {
+            position = (guint)g_atomic_int_get(&ring->head);
+        }
+    }
+    slot->level = level;
+    slot->time_us = time_us;
+    g_strlcpy(slot->component, component, sizeof(slot->component));
+    g_strlcpy(slot->message, message, sizeof(slot->message));
+    logger_encode_fields(slot->fields, sizeof(slot->fields), fields, field_count);
+    g_atomic_int_set(&slot->sequence, (gint)(position + 1));
+    return true;
+}
+
+/* Solo el hilo escritor consume. El casillero se libera para la vuelta siguiente del anillo. */
+static LogRecord *logger_ring_peek(LogRing *ring) {
+    LogRecord *slot = &ring->slots[ring->tail & ring->mask];
+    if ((gint)((guint)g_atomic_int_get(&slot->sequence) - (ring->tail + 1)) < 0) {
+        return NULL;
+    }
+    return slot;
+}
+
+static void logger_ring_release(LogRing *ring, LogRecord *slot) {
+    g_atomic_int_set(&slot->sequence, (gint)(ring->tail + ring->mask + 1));
+    ring->tail = ring->tail + 1;
+}
+
+static void logger_wake_flusher(Logger *logger) {
+    if (g_atomic_int_get(&logger->flusher_idle)) {
+        g_mutex_lock(&logger->lock);
+        g_cond_signal(&logger->wake);
+        g_mutex_unlock(&logger->lock);
+    }
+}
+
+static int logger_drain(Logger *logger) {
+    LogRecord *slot = NULL;
+    int count = 0;
+    int dropped = g_atomic_int_get(&logger->dropped);
+    g_mutex_lock(&logger->lock);
+    while (count < LOGGER_BATCH_MAX && (slot = logger_ring_peek(&logger->ring)) != NULL) {
+        logger_write_line(logger, slot->time_us, slot->level, slot->component, slot->message, slot->fields);
+        logger_ring_release(&logger->ring, slot);
+        count = count + 1;
+    }
+    if (dropped != logger->dropped_reported) {
+        char fields[64];
+        logger_encode_fields(fields, sizeof(fields), LOG_FIELDS(LOG_INT("dropped", dropped - logger->dropped_reported)));
+        logger_write_line(logger, g_get_real_time(), LOG_LEVEL_WARN, "logger", "Registros descartados con el buffer lleno", fields);
+        logger->dropped_reported = dropped;
+        count = count + 1;
+    }
+    if (count > 0 && logger->file != NULL) {
+        fflush(logger->file);
+        logger->batches = logger->batches + 1;
+    }
+    g_mutex_unlock(&logger->lock);
+    return count;
+}
+
+static gpointer logger_flusher_main(gpointer data) {
+    Logger *logger = (Logger *)data;
+    while (true) {
+        if (logger_drain(logger) > 0) {
+            continue;
+        }
+        if (g_atomic_int_get(&logger->stopping)) {
+            break;
+        }
+        /* Se marca ocioso y se vuelve a mirar antes de dormir para no perder un aviso. */
+        g_mutex_lock(&logger->lock);
+        g_atomic_int_set(&logger->flusher_idle, 1);
+        if (logger_ring_peek(&logger->ring) == NULL && !g_atomic_int_get(&logger->stopping)) {
+            g_cond_wait_until(&logger->wake, &logger->lock, g_get_monotonic_time() + LOGGER_IDLE_WAIT_US);
+        }
+        g_atomic_int_set(&logger->flusher_idle, 0);
+        g_mutex_unlock(&logger->lock);
+    }
+    logger_drain(logger);
+    return NULL;
+}
+
+bool logger_start_async(Logger *logger, int buffer_records, bool block_when_full) {
+    if (logger == NULL || logger->async) {
+        return false;
+    }
+    if (!logger_ring_init(&logger->ring, buffer_records > 0 ? buffer_records : 1024)) {
+        return false;
+    }
+    logger->block_when_full = block_when_full;
+    logger->flusher = g_thread_new("logger", logger_flusher_main, logger);
+    logger->async = true;
+    return true;
+}
+
+static void logger_push(Logger *logger, LogLevel level, const char *component, const char *message, const LogField *fields, int field_count) {
+    gint64 now = g_get_real_time();
+    bool block = logger->block_when_full || level == LOG_LEVEL_ERROR;
+    while (!logger_ring_push(&logger->ring, level, now, component, message, fields, field_count)) {
+        if (!block) {
+            g_atomic_int_inc(&logger->dropped);
+            logger_wake_flusher(logger);
+            return;
+        }
+        logger_wake_flusher(logger);
+        g_usleep(100);
+    }
+    logger_wake_flusher(logger);
+}
+
+void logger_log_fields(Logger *logger, LogLevel level, const char *component, const char *message, const LogField *fields, int field_count) {
+    char encoded[LOGGER_FIELDS_MAX];
     if (logger == NULL || message == NULL) {
         return;
     }
     if (level < logger->level) {
         return;
     }
-    logger_rotate_if_needed(logger);
-    if (logger->file == NULL) {
+    if (component == NULL) {
+        component = "app";
+    }
+    if (logger->async) {
+        logger_push(logger, level, component, message, fields, field_count);
         return;
     }
-    now = time(NULL);
-#ifdef _WIN32
-    localtime_s(&tm_now, &now);
-#else
-    localtime_r(&now, &tm_now);
-#endif
-    strftime(timestamp, sizeof(timestamp), "%H:%M:%S", &tm_now);
-    fprintf(logger->file, "%s [%s] %s: %s\n", timestamp, logger_level_to_string(level), component == NULL ? "app" : component, message);
-    fflush(logger->file);
+    logger_encode_fields(encoded, sizeof(encoded), fields, field_count);
+    g_mutex_lock(&logger->lock);
+    logger_write_line(logger, g_get_real_time(), level, component, message, encoded);
+    if (logger->file != NULL) {
+        fflush(logger->file);
+    }
+    g_mutex_unlock(&logger->lock);
+}
+
+void logger_log(Logger *logger, LogLevel level, const char *component, const char *message) {
+    logger_log_fields(logger, level, component, message, NULL, 0);
+}
+
+void logger_logf(Logger *logger, LogLevel level, const char *component, const char *format, ...) {
+    char message[LOGGER_MESSAGE_MAX];
+    va_list args;
+    if (!logger_enabled(logger, level) || format == NULL) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    logger_log_fields(logger, level, component, message, NULL, 0);
 }
 
 void logger_close(Logger *logger) {
     if (logger == NULL) {
         return;
     }
+    if (logger->async) {
+        g_atomic_int_set(&logger->stopping, 1);
+        g_mutex_lock(&logger->lock);
+        g_cond_signal(&logger->wake);
+        g_mutex_unlock(&logger->lock);
+        g_thread_join(logger->flusher);
+        logger->flusher = NULL;
+        logger->async = false;
+        free(logger->ring.slots);
+        logger->ring.slots = NULL;
+    }
+    g_mutex_lock(&logger->lock);
     logger_close_file(logger);
+    g_mutex_unlock(&logger->lock);
+    g_cond_clear(&logger->wake);
+    g_mutex_clear(&logger->lock);
 }
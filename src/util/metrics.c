@@ -0,0 +1,327 @@
+#include "util/metrics.h"
+#include <stdio.h>
+#include <string.h>
+
+#define METRICS_SUB_BUCKETS (1 << METRICS_SUB_BUCKET_BITS)
+
+static const char *const METRICS_OP_NAMES[METRICS_OP_COUNT][2] = {
+    {"dao", "create_order"},
+    {"dao", "add_item"},
+    {"dao", "add_items"},
+    {"dao", "close_order"},
+    {"dao", "update_status"},
+    {"dao", "update_statuses"},
+    {"dao", "order_totals"},
+    {"dao", "export_daily_report"},
+    {"dao", "rebuild_rollups"},
+    {"auth", "login"},
+    {"order", "create"},
+    {"order", "add_items"},
+    {"order", "flush_statuses"},
+    {"order", "close"},
+    {"order", "totals"},
+    {"report", "daily"},
+    {"report", "range"},
+    {"reservation", "create"},
+    {"ui", "read_wait"},
+    {"ui", "read_run"},
+    {"ui", "write_wait"},
+    {"ui", "write_run"}
+};
+
+static const char *const METRICS_COUNTER_NAMES[METRICS_COUNTER_COUNT] = {"logins_ok", "logins_failed", "orders_created", "items_added", "orders_closed", "jobs_failed"};
+static const char *const METRICS_GAUGE_NAMES[METRICS_GAUGE_COUNT] = {"read_queue", "write_queue", "status_queue"};
+
+static void metrics_histogram_name(MetricsHistogram *histogram, const char *family, const char *name) {
+    g_strlcpy(histogram->family, family, sizeof(histogram->family));
+    g_strlcpy(histogram->name, name, sizeof(histogram->name));
+}
+
+void metrics_init(Metrics *metrics) {
+    int index = 0;
+    if (metrics == NULL) {
+        return;
+    }
+    memset(metrics, 0, sizeof(Metrics));
+    g_mutex_init(&metrics->lock);
+    metrics->started_us = g_get_monotonic_time();
+    while (index < METRICS_OP_COUNT) {
+        metrics_histogram_name(&metrics->ops[index], METRICS_OP_NAMES[index][0], METRICS_OP_NAMES[index][1]);
+        index = index + 1;
+    }
+}
+
+void metrics_clear(Metrics *metrics) {
+    int index = 0;
+    if (metrics == NULL || metrics->started_us == 0) {
+        return;
+    }
+    while (index < metrics->statement_count) {
+        g_free(metrics->statements[index]);
+        index = index + 1;
+    }
+    g_mutex_clear(&metrics->lock);
+    memset(metrics, 0, sizeof(Metrics));
+}
+
+/* Debajo de 4 us un bucket por valor; después, la potencia de dos y los dos bits siguientes. */
+static int metrics_bucket_index(gint64 value_us) {
+    int exponent = 0;
+    int index;
+    if (value_us < METRICS_SUB_BUCKETS) {
+        return value_us < 0 ? 0 : (int)value_us;
+    }
+    while ((value_us >> (exponent + 1)) != 0) {
+        exponent = exponent + 1;
+    }
+    index = (exponent - METRICS_SUB_BUCKET_BITS + 1) * METRICS_SUB_BUCKETS + (int)((value_us >> (exponent - METRICS_SUB_BUCKET_BITS)) & (METRICS_SUB_BUCKETS - 1));
+    return index < METRICS_BUCKETS ? index : METRICS_BUCKETS - 1;
+}
+
+static gint64 metrics_bucket_upper(int index) {
+    int exponent;
+    int sub;
+    if (index < METRICS_SUB_BUCKETS) {
+        return index;
+    }
+    exponent = index / METRICS_SUB_BUCKETS + METRICS_SUB_BUCKET_BITS - 1;
+    sub = index % METRICS_SUB_BUCKETS;
+    return ((gint64)(METRICS_SUB_BUCKETS + sub + 1) << (exponent - METRICS_SUB_BUCKET_BITS)) - 1;
+}
+
+void metrics_histogram_record(MetricsHistogram *histogram, gint64 elapsed_us) {
+    gint elapsed = elapsed_us > G_MAXINT ? G_MAXINT : (gint)(elapsed_us < 0 ? 0 : elapsed_us);
+    gint max_us;
+    if (histogram == NULL) {
+        return;
+    }
+    g_atomic_int_inc(&histogram->buckets[metrics_bucket_index(elapsed)]);
+    g_atomic_pointer_add(&histogram->sum_us, (gssize)elapsed);
+    max_us = g_atomic_int_get(&histogram->max_us);
+    while (elapsed > max_us && !g_atomic_int_compare_and_exchange(&histogram->max_us, max_us, elapsed)) {
+        max_us = g_atomic_int_get(&histogram->max_us);
+    }
+}
+
+void metrics_observe(Metrics *metrics, MetricsOp op, gint64 started_us) {
+    if (metrics == NULL || op < 0 || op >= METRICS_OP_COUNT) {
+        return;
+    }
+    metrics_histogram_record(&metrics->ops[op], g_get_monotonic_time() - started_us);
+}
+
+MetricsHistogram *metrics_statement(Metrics *metrics, const char *name) {
+    MetricsHistogram *histogram = NULL;
+    int index = 0;
+    if (metrics == NULL || name == NULL) {
+        return NULL;
+    }
+    g_mutex_lock(&metrics->lock);
+    while (index < metrics->statement_count && histogram == NULL) {
+        if (strcmp(metrics->statements[index]->name, name) == 0) {
+            histogram = metrics->statements[index];
+        }
+        index = index + 1;
+    }
+    if (histogram == NULL && metrics->statement_count < METRICS_MAX_STATEMENTS) {
+        histogram = g_new0(MetricsHistogram, 1);
+        metrics_histogram_name(histogram, "sql", name);
+        metrics->statements[metrics->statement_count] = histogram;
+        metrics->statement_count = metrics->statement_count + 1;
+    }
+    g_mutex_unlock(&metrics->lock);
+    return histogram;
+}
+
+void metrics_count(Metrics *metrics, MetricsCounter counter, int delta) {
+    if (metrics == NULL || counter < 0 || counter >= METRICS_COUNTER_COUNT) {
+        return;
+    }
+    g_atomic_int_add(&metrics->counters[counter], delta);
+}
+
+void metrics_gauge_set(Metrics *metrics, MetricsGauge gauge, int value) {
+    if (metrics == NULL || gauge < 0 || gauge >= METRICS_GAUGE_COUNT) {
+        return;
+    }
+    g_atomic_int_set(&metrics->gauges[gauge], value);
+}
+
+static double metrics_percentile_ms(const gint *buckets, long long count, double quantile, gint max_us) {
+    long long rank = (long long)(quantile * (double)count + 0.999999);
+    long long seen = 0;
+    int index = 0;
+    if (rank < 1) {
+        rank = 1;
+    }
+    while (index < METRICS_BUCKETS) {
+        seen = seen + buckets[index];
+        if (seen >= rank) {
+            gint64 upper = metrics_bucket_upper(index);
+            return (double)(upper < max_us ? upper : max_us) / 1000.0;
+        }
+        index = index + 1;
+    }
+    return (double)max_us / 1000.0;
+}
+
+bool metrics_summarize(const MetricsHistogram *histogram, MetricsSummary *summary) {
+    gint buckets[METRICS_BUCKETS];
+    long long count = 0;
+    gint max_us;
+    int index = 0;
+    if (histogram == NULL || summary == NULL) {
+        return false;
+    }
+    /* Copia de los contadores: el resumen es coherente aunque sigan llegando muestras. */
+    while (index < METRICS_BUCKETS) {
+        buckets[index] = g_atomic_int_get(&histogram->buckets[index]);
+        count = count + buckets[index];
+        index = index + 1;
+    }
+    memset(summary, 0, sizeof(MetricsSummary));
+    g_strlcpy(summary->family, histogram->family, sizeof(summary->family));
+    g_strlcpy(summary->name, histogram->name, sizeof(summary->name));
+    if (count == 0) {
+        return false;
+    }
+    max_us = g_atomic_int_get(&histogram->max_us);
+    summary->count = count;
+    summary->sum_ms = (double)(gsize)g_atomic_pointer_get(&histogram->sum_us) / 1000.0;
+    summary->p50_ms = metrics_percentile_ms(buckets, count, 0.50, max_us);
+    summary->p90_ms = metrics_percentile_ms(buckets, count, 0.90, max_us);
+    summary->p99_ms = metrics_percentile_ms(buckets, count, 0.99, max_us);
+    summary->max_ms = (double)max_us / 1000.0;
+    return true;
+}
+
+GArray *metrics_snapshot(Metrics *metrics) {
+    GArray *summaries = g_array_new(FALSE, TRUE, sizeof(MetricsSummary));
+    MetricsSummary summary;
+    int index = 0;
+    if (metrics == NULL) {
+        return summaries;
+    }
+    while (index < METRICS_OP_COUNT) {
+        if (metrics_summarize(&metrics->ops[index], &summary)) {
+            g_array_append_val(summaries, summary);
+        }
+        index = index + 1;
+    }
+    g_mutex_lock(&metrics->lock);
+    index = 0;
+    while (index < metrics->statement_count) {
+        if (metrics_summarize(metrics->statements[index], &summary)) {
+            g_array_append_val(summaries, summary);
+        }
+        index = index + 1;
+    }
+    g_mutex_unlock(&metrics->lock);
+    return summaries;
+}
+
+static void metrics_render_prometheus(Metrics *metrics, GArray *summaries, GString *out) {
+    guint position = 0;
+    int index = 0;
+    g_string_append(out, "# TYPE restaurant_latency_ms summary\n");
+    while (position < summaries->len) {
+        const MetricsSummary *summary = &g_array_index(summaries, MetricsSummary, position);
+        const char *family = summary->family;
+        const char *name = summary->name;
+        g_string_append_printf(out, "restaurant_latency_ms{family=\"%s\",op=\"%s\",quantile=\"0.5\"} %.3f\n", family, name, summary->p50_ms);
+        g_string_append_printf(out, "restaurant_latency_ms{family=\"%s\",op=\"%s\",quantile=\"0.9\"} %.3f\n", family, name, summary->p90_ms);
+        g_string_append_printf(out, "restaurant_latency_ms{family=\"%s\",op=\"%s\",quantile=\"0.99\"} %.3f\n", family, name, summary->p99_ms);
+        g_string_append_printf(out, "restaurant_latency_ms_sum{family=\"%s\",op=\"%s\"} %.3f\n", family, name, summary->sum_ms);
+        g_string_append_printf(out, "restaurant_latency_ms_count{family=\"%s\",op=\"%s\"} %lld\n", family, name, summary->count);
+        position = position + 1;
+    }
+    g_string_append(out, "# TYPE restaurant_events_total counter\n");
+    while (index < METRICS_COUNTER_COUNT) {
+        g_string_append_printf(out, "restaurant_events_total{event=\"%s\"} %d\n", METRICS_COUNTER_NAMES[index], g_atomic_int_get(&metrics->counters[index]));
+        index = index + 1;
+    }
+    g_string_append(out, "# TYPE restaurant_queue_depth gauge\n");
+    index = 0;
+    while (index < METRICS_GAUGE_COUNT) {
+        g_string_append_printf(out, "restaurant_queue_depth{queue=\"%s\"} %d\n", METRICS_GAUGE_NAMES[index], g_atomic_int_get(&metrics->gauges[index]));
+        index = index + 1;
+    }
+    g_string_append_printf(out, "# TYPE restaurant_uptime_seconds gauge\nrestaurant_uptime_seconds %lld\n", (long long)((g_get_monotonic_time() - metrics->started_us) / G_USEC_PER_SEC));
+}
+
+static void metrics_render_json(Metrics *metrics, GArray *summaries, GString *out) {
+    guint position = 0;
+    int index = 0;
+    g_string_append_printf(out, "{\"uptime_s\":%lld,\"latency\":[", (long long)((g_get_monotonic_time() - metrics->started_us) / G_USEC_PER_SEC));
+    while (position < summaries->len) {
+        const MetricsSummary *summary = &g_array_index(summaries, MetricsSummary, position);
+        g_string_append_printf(out, "%s{\"family\":\"%s\",\"op\":\"%s\",\"count\":%lld,\"sum_ms\":%.3f,\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f}",
+                               position > 0 ? "," : "", summary->family, summary->name, summary->count, summary->sum_ms, summary->p50_ms, summary->p90_ms, summary->p99_ms, summary->max_ms);
+        position = position + 1;
+    }
+    g_string_append(out, "],\"counters\":{");
+    while (index < METRICS_COUNTER_COUNT) {
+        g_string_append_printf(out, "%s\"%s\":%d", index > 0 ? "," : "", METRICS_COUNTER_NAMES[index], g_atomic_int_get(&metrics->counters[index]));
+        index = index + 1;
+    }
+    g_string_append(out, "},\"gauges\":{");
+    index = 0;
+    while (index < METRICS_GAUGE_COUNT) {
+        g_string_append_printf(out, "%s\"%s\":%d", index > 0 ? "," : "", METRICS_GAUGE_NAMES[index], g_atomic_int_get(&metrics->gauges[index]));
+        index = index + 1;
+    }
+    g_string_append(out, "}}\n");
+}
+
+GString *metrics_render(Metrics *metrics, MetricsFormat format) {
+    GString *out = g_string_new(NULL);
+    GArray *summaries = NULL;
+    if (metrics == NULL) {
+        return out;
+    }
+    summaries = metrics_snapshot(metrics);
+    if (format == METRICS_FORMAT_JSON) {
+        metrics_render_json(metrics, summaries, out);
+    } else {
+        metrics_render_prometheus(metrics, summaries, out);
+    }
+    g_array_unref(summaries);
+    return out;
+}
+
+/* Se escribe a un temporal y se renombra: quien lee el archivo nunca ve un volcado a medias. */
+bool metrics_write_file(Metrics *metrics, const char *path, MetricsFormat format) {
+    char temp_path[600];
+    GString *out = NULL;
+    FILE *file = NULL;
+    bool ok;
+    if (metrics == NULL || path == NULL || path[0] == '\0') {
+        return false;
+    }
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    file = fopen(temp_path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    out = metrics_render(metrics, format);
+    ok = fwrite(out->str, 1, out->len, file) == out->len;
+    g_string_free(out, TRUE);
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (!ok || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        return false;
+    }
+    return true;
+}
+
+MetricsFormat metrics_format_from_string(const char *text) {
+    if (text != NULL && g_ascii_strcasecmp(text, "json") == 0) {
+        return METRICS_FORMAT_JSON;
+    }
+    return METRICS_FORMAT_PROMETHEUS;
+}
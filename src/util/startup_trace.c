@@ -0,0 +1,132 @@
+#include "util/startup_trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+void startup_trace_init(StartupTrace *trace, int argc, char **argv) {
+    int arg_index = 1;
+    memset(trace, 0, sizeof(StartupTrace));
+    while (arg_index < argc) {
+        if (strcmp(argv[arg_index], "--startup-trace") == 0 || strcmp(argv[arg_index], "--startup-trace=table") == 0) {
+            trace->enabled = true;
+            trace->format = STARTUP_TRACE_TABLE;
+        } else if (strcmp(argv[arg_index], "--startup-trace=json") == 0) {
+            trace->enabled = true;
+            trace->format = STARTUP_TRACE_JSON;
+        } else if (strncmp(argv[arg_index], "--startup-budget-ms=", 20) == 0) {
+            trace->budget_ms = atoi(argv[arg_index] + 20);
+        }
+        arg_index = arg_index + 1;
+    }
+    trace->origin_us = g_get_monotonic_time();
+    trace->last_us = trace->origin_us;
+}
+
+void startup_trace_mark(StartupTrace *trace, const char *phase) {
+    gint64 now;
+    StartupTracePhase *entry = NULL;
+    if (trace == NULL || !trace->enabled || trace->count == STARTUP_TRACE_MAX_PHASES) {
+        return;
+    }
+    now = g_get_monotonic_time();
+    entry = &trace->phases[trace->count];
+    entry->name = phase;
+    entry->start_us = trace->last_us - trace->origin_us;
+    entry->end_us = now - trace->origin_us;
+    entry->shutdown = trace->shutting_down;
+    trace->count = trace->count + 1;
+    trace->last_us = now;
+}
+
+void startup_trace_first_frame(StartupTrace *trace) {
+    if (trace == NULL || !trace->enabled || trace->first_frame_us > 0) {
+        return;
+    }
+    startup_trace_mark(trace, "first_frame");
+    trace->first_frame_us = trace->last_us - trace->origin_us;
+}
+
+void startup_trace_begin_shutdown(StartupTrace *trace) {
+    if (trace == NULL || !trace->enabled) {
+        return;
+    }
+    /* El tiempo dentro del loop de GTK no es de arranque ni de cierre. */
+    trace->shutting_down = true;
+    trace->last_us = g_get_monotonic_time();
+}
+
+static gint64 startup_trace_startup_us(const StartupTrace *trace) {
+    int index = 0;
+    gint64 end = 0;
+    if (trace->first_frame_us > 0) {
+        return trace->first_frame_us;
+    }
+    while (index < trace->count) {
+        if (!trace->phases[index].shutdown) {
+            end = trace->phases[index].end_us;
+        }
+        index = index + 1;
+    }
+    return end;
+}
+
+static gint64 startup_trace_shutdown_us(const StartupTrace *trace) {
+    int index = 0;
+    gint64 total = 0;
+    while (index < trace->count) {
+        if (trace->phases[index].shutdown) {
+            total = total + (trace->phases[index].end_us - trace->phases[index].start_us);
+        }
+        index = index + 1;
+    }
+    return total;
+}
+
+bool startup_trace_report(const StartupTrace *trace, Logger *logger, FILE *out) {
+    int index = 0;
+    gint64 startup_us;
+    gint64 shutdown_us;
+    bool within_budget;
+    if (trace == NULL || !trace->enabled) {
+        return true;
+    }
+    startup_us = startup_trace_startup_us(trace);
+    shutdown_us = startup_trace_shutdown_us(trace);
+    within_budget = trace->budget_ms <= 0 || startup_us <= (gint64)trace->budget_ms * 1000;
+    while (index < trace->count) {
+        const StartupTracePhase *phase = &trace->phases[index];
+        logger_log_fields(logger, LOG_LEVEL_INFO, "startup", phase->shutdown ? "Cierre" : "Arranque",
+                          LOG_FIELDS(LOG_STR("phase", phase->name), LOG_DOUBLE("start_ms", phase->start_us / 1000.0), LOG_DOUBLE("duration_ms", (phase->end_us - phase->start_us) / 1000.0)));
+        index = index + 1;
+    }
+    logger_log_fields(logger, within_budget ? LOG_LEVEL_INFO : LOG_LEVEL_WARN, "startup", "Arranque hasta primer cuadro",
+                      LOG_FIELDS(LOG_DOUBLE("startup_ms", startup_us / 1000.0), LOG_DOUBLE("shutdown_ms", shutdown_us / 1000.0), LOG_INT("within_budget", within_budget)));
+    if (out == NULL) {
+        return within_budget;
+    }
+    index = 0;
+    if (trace->format == STARTUP_TRACE_JSON) {
+        fprintf(out, "{\"phases\":[");
+        while (index < trace->count) {
+            const StartupTracePhase *phase = &trace->phases[index];
+            fprintf(out, "%s{\"name\":\"%s\",\"stage\":\"%s\",\"start_ms\":%.3f,\"duration_ms\":%.3f}", index > 0 ? "," : "", phase->name,
+                    phase->shutdown ? "shutdown" : "startup", phase->start_us / 1000.0, (phase->end_us - phase->start_us) / 1000.0);
+            index = index + 1;
+        }
+        fprintf(out, "],\"startup_ms\":%.3f,\"shutdown_ms\":%.3f,\"budget_ms\":%d,\"within_budget\":%s}\n", startup_us / 1000.0, shutdown_us / 1000.0,
+                trace->budget_ms, within_budget ? "true" : "false");
+    } else {
+        fprintf(out, "%-10s %-24s %12s %12s\n", "etapa", "fase", "inicio ms", "duración ms");
+        while (index < trace->count) {
+            const StartupTracePhase *phase = &trace->phases[index];
+            fprintf(out, "%-10s %-24s %12.3f %12.3f\n", phase->shutdown ? "cierre" : "arranque", phase->name, phase->start_us / 1000.0,
+                    (phase->end_us - phase->start_us) / 1000.0);
+            index = index + 1;
+        }
+        fprintf(out, "Primer cuadro: %.3f ms · cierre: %.3f ms", startup_us / 1000.0, shutdown_us / 1000.0);
+        if (trace->budget_ms > 0) {
+            fprintf(out, " · presupuesto %d ms: %s", trace->budget_ms, within_budget ? "OK" : "EXCEDIDO");
+        }
+        fprintf(out, "\n");
+    }
+    return within_budget;
+}
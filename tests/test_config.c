@@ -1,7 +1,22 @@
 #include <assert.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
 #include <string.h>
 #include "util/config.h"
 #include "util/hash.h"
+#include "util/arena.h"
+#include "data/database.h"
+#include "data/migrations.h"
+#include "data/snapshot_cache.h"
+#include "data/change_bus.h"
+#include "core/kitchen_service.h"
+#include "core/reservation_service.h"
+#include "core/status_queue.h"
+#include "util/startup_trace.h"
+#include "util/interval_tree.h"
+#include "util/logger.h"
+#include "util/metrics.h"
+#include "data/dao.h"
 
 static void test_config_default_values(void) {
     AppConfig config;
@@ -10,6 +25,10 @@ static void test_config_default_values(void) {
     assert(strcmp(config.locale, "es") == 0);
     assert(strcmp(config.currency, "ARS") == 0);
     assert(config.tax_rate > 0.2);
+    assert(strcmp(config.storage.journal_mode, "WAL") == 0);
+    assert(strcmp(config.storage.synchronous, "NORMAL") == 0);
+    assert(config.storage.busy_timeout_ms > 0);
+    assert(config.status_queue.max_delay_ms >= config.status_queue.flush_interval_ms);
 }
 
 static void test_hash_sha256(void) {
@@ -18,8 +37,792 @@ static void test_hash_sha256(void) {
     assert(strcmp(output, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") == 0);
 }
 
+static void test_statement_cache_reuse(void) {
+    static const char sql[] = "SELECT ?";
+    Database *db = NULL;
+    sqlite3_stmt *first;
+    sqlite3_stmt *second;
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    first = database_prepare(db, sql);
+    assert(first != NULL);
+    sqlite3_bind_int(first, 1, 7);
+    assert(sqlite3_step(first) == SQLITE_ROW);
+    database_release(db, first);
+    second = database_prepare(db, sql);
+    assert(second == first);
+    assert(sqlite3_bind_parameter_count(second) == 1);
+    assert(sqlite3_step(second) == SQLITE_ROW);
+    assert(sqlite3_column_type(second, 0) == SQLITE_NULL);
+    database_release(db, second);
+    database_statement_stats(db, &hits, &misses);
+    assert(hits == 1);
+    assert(misses == 1);
+    database_close(db);
+}
+
+static void test_schema_fingerprint(void) {
+    static const Migration migrations[] = {
+        {1, "CREATE TABLE users (id INTEGER PRIMARY KEY, username TEXT)"},
+        {2, "ALTER TABLE users ADD COLUMN role TEXT"}
+    };
+    Database *db = NULL;
+    bool needed = false;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(!database_schema_is_current(db, migrations, 1));
+    assert(database_apply_migrations(db, migrations, 1, NULL));
+    assert(database_schema_is_current(db, migrations, 1));
+    assert(!database_schema_is_current(db, migrations, 2));
+    assert(database_apply_migrations(db, migrations, 2, NULL));
+    assert(database_schema_is_current(db, migrations, 2));
+    assert(database_needs_seed(db, &needed) && needed);
+    assert(sqlite3_exec(db->handle, "INSERT INTO users(username) VALUES('admin')", NULL, NULL, NULL) == SQLITE_OK);
+    assert(database_needs_seed(db, &needed) && !needed);
+    database_close(db);
+}
+
+static void test_arena_interning(void) {
+    Arena arena;
+    ArenaInterner interner;
+    const char *first;
+    const char *second;
+    char *large;
+    int index = 0;
+    arena_init(&arena, 1024);
+    arena_interner_init(&interner);
+    first = arena_intern(&interner, &arena, "Bebidas");
+    second = arena_intern(&interner, &arena, "Bebidas");
+    assert(first == second);
+    assert(arena_intern(&interner, &arena, "Postres") != first);
+    while (index < 500) {
+        char name[32];
+        snprintf(name, sizeof(name), "cat-%d", index % 50);
+        assert(strcmp(arena_intern(&interner, &arena, name), name) == 0);
+        index = index + 1;
+    }
+    assert(interner.count == 52);
+    large = arena_alloc(&arena, 4096);
+    assert(large != NULL);
+    memset(large, 'x', 4096);
+    assert(strcmp(first, "Bebidas") == 0);
+    arena_interner_free(&interner);
+    arena_free(&arena);
+    assert(arena.bytes_reserved == 0);
+}
+
+static void test_status_queue_coalescing(void) {
+    StatusQueue queue;
+    const OrderItemStatusChange *entries = NULL;
+    char status[16];
+    int count;
+    status_queue_init(&queue);
+    assert(status_queue_put(&queue, 7, "preparacion", 100) == 1);
+    assert(status_queue_put(&queue, 7, "listo", 200) == 1);
+    assert(status_queue_put(&queue, 9, "preparacion", 300) == 2);
+    assert(status_queue_oldest(&queue) == 100);
+    count = status_queue_take(&queue, &entries);
+    assert(count == 2);
+    assert(entries[0].order_item_id == 7 && strcmp(entries[0].status, "listo") == 0);
+    /* Mientras el lote se escribe sigue visible, y un cambio nuevo tiene prioridad. */
+    assert(status_queue_lookup(&queue, 9, status, sizeof(status)) && strcmp(status, "preparacion") == 0);
+    status_queue_put(&queue, 9, "servido", 400);
+    status_queue_finish(&queue, false);
+    assert(status_queue_count(&queue) == 2);
+    assert(status_queue_lookup(&queue, 9, status, sizeof(status)) && strcmp(status, "servido") == 0);
+    assert(status_queue_oldest(&queue) == 100);
+    count = status_queue_take(&queue, &entries);
+    status_queue_finish(&queue, true);
+    assert(count == 2);
+    assert(status_queue_count(&queue) == 0);
+    assert(!status_queue_lookup(&queue, 7, status, sizeof(status)));
+    status_queue_clear(&queue);
+}
+
+static void test_startup_trace_budget(void) {
+    char *argv[] = {"restaurant_app", "--startup-trace=json", "--startup-budget-ms=60000"};
+    StartupTrace trace;
+    startup_trace_init(&trace, 3, argv);
+    assert(trace.enabled && trace.format == STARTUP_TRACE_JSON && trace.budget_ms == 60000);
+    startup_trace_mark(&trace, "config_load");
+    startup_trace_first_frame(&trace);
+    startup_trace_begin_shutdown(&trace);
+    startup_trace_mark(&trace, "database_close");
+    assert(trace.count == 3);
+    assert(!trace.phases[1].shutdown && trace.phases[2].shutdown);
+    assert(trace.phases[1].end_us == trace.first_frame_us);
+    assert(startup_trace_report(&trace, NULL, NULL));
+    trace.budget_ms = 1;
+    trace.first_frame_us = 5000;
+    assert(!startup_trace_report(&trace, NULL, NULL));
+}
+
+static void test_snapshot_cache_versions(void) {
+    Database *db = NULL;
+    SnapshotCache cache;
+    Snapshot *first;
+    Snapshot *second;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    snapshot_cache_init(&cache);
+    first = snapshot_cache_acquire(&cache, db, SNAPSHOT_MENU_ITEMS);
+    assert(first != NULL && first->count > 0);
+    assert(snapshot_menu_item(first, 1) != NULL && snapshot_menu_item(first, 1)->id == 1);
+    assert(snapshot_table(first, 1) == NULL);
+    second = snapshot_cache_acquire(&cache, db, SNAPSHOT_MENU_ITEMS);
+    assert(second == first && cache.hits == 1);
+    snapshot_release(second);
+    /* Una escritura en otra tabla revalida sin reconstruir el menú. */
+    assert(sqlite3_exec(db->handle, "UPDATE tables SET status = 'ocupada' WHERE id = 1", NULL, NULL, NULL) == SQLITE_OK);
+    second = snapshot_cache_acquire(&cache, db, SNAPSHOT_MENU_ITEMS);
+    assert(second == first && cache.rebuilds == 1);
+    snapshot_release(second);
+    assert(sqlite3_exec(db->handle, "UPDATE menu_items SET price = 1.5 WHERE id = 1", NULL, NULL, NULL) == SQLITE_OK);
+    second = snapshot_cache_acquire(&cache, db, SNAPSHOT_MENU_ITEMS);
+    assert(second != first && snapshot_menu_item(second, 1)->price == 1.5);
+    assert(snapshot_menu_item(first, 1)->price != 1.5);
+    snapshot_release(second);
+    snapshot_release(first);
+    snapshot_cache_clear(&cache);
+    database_close(db);
+}
+
+typedef struct TestChangeSeen {
+    Database *db;
+    int orders;
+    int tables;
+    int batches;
+    bool after_commit;
+} TestChangeSeen;
+
+static void test_change_bus_batches(const ChangeEvent *events, int count, gpointer user_data) {
+    TestChangeSeen *seen = (TestChangeSeen *)user_data;
+    int index = 0;
+    while (index < count) {
+        if (events[index].table == CHANGE_TABLE_ORDERS && events[index].rowid == 1) {
+            seen->orders = seen->orders + 1;
+        } else if (events[index].table == CHANGE_TABLE_TABLES) {
+            seen->tables = seen->tables + 1;
+        }
+        index = index + 1;
+    }
+    /* Al entregar el lote el COMMIT ya volvió: no queda transacción abierta. */
+    seen->after_commit = sqlite3_get_autocommit(seen->db->handle) != 0;
+    seen->batches = seen->batches + 1;
+}
+
+static void test_change_bus_step(Database *db, const char *sql) {
+    sqlite3_stmt *stmt = database_prepare(db, sql);
+    assert(stmt != NULL);
+    assert(sqlite3_step(stmt) == SQLITE_DONE);
+    database_release(db, stmt);
+}
+
+static void test_change_bus_commit_only(void) {
+    Database *db = NULL;
+    ChangeBus bus;
+    TestChangeSeen seen;
+    memset(&seen, 0, sizeof(TestChangeSeen));
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    seen.db = db;
+    change_bus_init(&bus);
+    change_bus_attach(&bus, db);
+    change_bus_subscribe(&bus, test_change_bus_batches, &seen);
+    /* Lo revertido no se entrega; una transacción llega como un solo lote. */
+    assert(database_begin(db));
+    test_change_bus_step(db, "UPDATE tables SET status = 'ocupada' WHERE id = 1");
+    database_rollback(db);
+    assert(database_begin(db));
+    test_change_bus_step(db, "INSERT INTO orders (table_id, waiter_id, status) VALUES (1, 1, 'abierta')");
+    test_change_bus_step(db, "UPDATE orders SET status = 'abierta' WHERE id = 1");
+    test_change_bus_step(db, "UPDATE tables SET status = 'ocupada' WHERE id = 1");
+    while (g_main_context_iteration(bus.main_context, FALSE)) {
+    }
+    assert(seen.batches == 0);
+    assert(database_commit(db));
+    while (g_main_context_iteration(bus.main_context, FALSE)) {
+    }
+    assert(seen.batches == 1 && seen.tables == 1 && seen.orders == 2 && seen.after_commit);
+    /* Una sentencia suelta hace su propio commit y se entrega al liberarla. */
+    test_change_bus_step(db, "UPDATE tables SET status = 'libre' WHERE id = 1");
+    while (g_main_context_iteration(bus.main_context, FALSE)) {
+    }
+    assert(seen.batches == 2 && seen.tables == 2 && seen.after_commit);
+    change_bus_detach(&bus, db);
+    change_bus_clear(&bus);
+    database_close(db);
+}
+
+static bool test_kitchen_count(const KitchenTicketView *row, void *user_data) {
+    int *counts = (int *)user_data;
+    counts[row->active ? 0 : 1] = counts[row->active ? 0 : 1] + 1;
+    return true;
+}
+
+static void test_kitchen_feed_deltas(void) {
+    Database *db = NULL;
+    KitchenFeed feed;
+    int counts[2] = {0, 0};
+    int order_id = 0;
+    bool changed = false;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    assert(dao_create_order(db, 1, 1, &order_id));
+    assert(dao_add_item_to_order(db, order_id, 1, ""));
+    assert(dao_add_item_to_order(db, order_id, 10, ""));
+    kitchen_feed_init(&feed, "cocina");
+    assert(kitchen_service_poll(db, &feed, test_kitchen_count, counts, &changed));
+    assert(changed && counts[0] == 1 && counts[1] == 0);
+    /* Sin escrituras no se consulta nada. */
+    assert(kitchen_service_poll(db, &feed, test_kitchen_count, counts, &changed));
+    assert(!changed && feed.skipped == 1);
+    assert(sqlite3_exec(db->handle, "UPDATE order_items SET status = 'listo' WHERE menu_item_id = 1", NULL, NULL, NULL) == SQLITE_OK);
+    assert(kitchen_service_poll(db, &feed, test_kitchen_count, counts, &changed));
+    assert(changed && counts[0] == 2 && counts[1] == 0);
+    assert(dao_close_order(db, order_id));
+    assert(kitchen_service_poll(db, &feed, test_kitchen_count, counts, &changed));
+    assert(changed && counts[0] == 2 && counts[1] == 1);
+    assert(strcmp(kitchen_service_next_status("pedido"), "preparacion") == 0);
+    assert(kitchen_service_next_status("servido") == NULL);
+    database_close(db);
+}
+
+static void test_reservations_keyset_window(void) {
+    Database *db = NULL;
+    ReservationKey after;
+    Reservation *page = NULL;
+    int count = 0;
+    int total = 0;
+    int index = 0;
+    bool has_after = false;
+    char when[32];
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    /* Horarios repetidos a propósito: el id desempata dentro del mismo reserved_at. */
+    while (index < 30) {
+        snprintf(when, sizeof(when), "2026-03-%02d %02d:00", 1 + index % 3, 12 + (index / 3) % 4);
+        assert(dao_create_reservation(db, 1, "Cliente", "555", when, "", NULL));
+        index = index + 1;
+    }
+    memset(&after, 0, sizeof(after));
+    do {
+        assert(dao_list_reservations_window(db, "2026-03-01", "2026-03-03", has_after ? &after : NULL, 7, &page, &count));
+        index = 0;
+        while (index < count) {
+            assert(strcmp(page[index].reserved_at, "2026-03-01") >= 0 && strcmp(page[index].reserved_at, "2026-03-03") < 0);
+            if (has_after) {
+                int order = strcmp(page[index].reserved_at, after.reserved_at);
+                assert(order > 0 || (order == 0 && page[index].id > after.id));
+            }
+            g_strlcpy(after.reserved_at, page[index].reserved_at, sizeof(after.reserved_at));
+            after.id = page[index].id;
+            has_after = true;
+            index = index + 1;
+        }
+        total = total + count;
+        dao_free_reservations(page);
+        page = NULL;
+    } while (count == 7);
+    assert(total == 20);
+    database_close(db);
+}
+
+static void test_interval_tree_overlaps(void) {
+    IntervalTree tree;
+    long long starts[64];
+    int id = 0;
+    int index = 0;
+    interval_tree_init(&tree);
+    /* Turnos de 90 minutos cada dos horas, insertados desordenados. */
+    while (index < 64) {
+        int slot = (index * 37) % 64;
+        starts[slot] = (long long)slot * 120;
+        assert(interval_tree_insert(&tree, starts[slot], starts[slot] + 90, slot + 1));
+        index = index + 1;
+    }
+    assert(tree.count == 64);
+    assert(!interval_tree_insert(&tree, starts[3], starts[3] + 10, 4));
+    assert(interval_tree_find_overlap(&tree, 3 * 120 + 60, 3 * 120 + 100, &id) && id == 4);
+    assert(!interval_tree_find_overlap(&tree, 3 * 120 + 90, 4 * 120, NULL));
+    assert(interval_tree_find_overlap(&tree, 3 * 120 + 89, 4 * 120 + 1, &id) && (id == 4 || id == 5));
+    index = 0;
+    while (index < 64) {
+        if (index % 2 == 0) {
+            assert(interval_tree_remove(&tree, starts[index], index + 1));
+        }
+        index = index + 1;
+    }
+    assert(tree.count == 32);
+    assert(!interval_tree_remove(&tree, starts[0], 1));
+    index = 0;
+    while (index < 64) {
+        assert(interval_tree_find_overlap(&tree, starts[index] + 10, starts[index] + 20, NULL) == (index % 2 == 1));
+        index = index + 1;
+    }
+    interval_tree_clear(&tree);
+}
+
+static void test_reservation_book_conflicts(void) {
+    Database *db = NULL;
+    ReservationBook book;
+    GArray *free_ids = g_array_new(FALSE, FALSE, sizeof(int));
+    int first = 0;
+    int second = 0;
+    int conflict = 0;
+    bool is_free = false;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    reservation_book_init(&book, 120);
+    assert(reservation_book_create(&book, db, 1, "Ana", "", "2030-05-01 20:00", "", &first, &conflict));
+    assert(!reservation_book_create(&book, db, 1, "Beto", "", "2030-05-01 21:30", "", &second, &conflict) && conflict == first);
+    assert(reservation_book_create(&book, db, 1, "Beto", "", "2030-05-01 22:00", "", &second, &conflict));
+    assert(book.reloads == 1);
+    /* Las primeras mesas son de dos: para cuatro quedan de la 5 en adelante. */
+    assert(reservation_book_free_tables(&book, db, "2030-05-01 20:30", 0, 2, free_ids));
+    assert(free_ids->len == 9 && g_array_index(free_ids, int, 0) == 2);
+    g_array_set_size(free_ids, 0);
+    assert(reservation_book_free_tables(&book, db, "2030-05-01 20:30", 0, 5, free_ids));
+    assert(free_ids->len == 2 && g_array_index(free_ids, int, 0) == 9);
+    /* Otra terminal reserva la mesa 9: la agenda lo ve por table_versions. */
+    assert(sqlite3_exec(db->handle, "INSERT INTO reservations(table_id, customer_name, reserved_at) VALUES (9, 'Otra', '2030-05-01 19:00')", NULL, NULL, NULL) == SQLITE_OK);
+    assert(reservation_book_table_free(&book, db, 9, "2030-05-01 20:30", 0, &is_free, &conflict) && !is_free);
+    assert(book.reloads == 2);
+    assert(reservation_book_cancel(&book, db, first));
+    assert(reservation_book_table_free(&book, db, 1, "2030-05-01 20:30", 60, &is_free, NULL) && is_free);
+    assert(reservation_book_table_free(&book, db, 1, "2030-05-01 20:30", 120, &is_free, &conflict) && !is_free && conflict == second);
+    assert(book.reloads == 2);
+    g_array_unref(free_ids);
+    reservation_book_clear(&book);
+    database_close(db);
+}
+
+static void test_reservation_when_strict(void) {
+    Database *db = NULL;
+    ReservationBook book;
+    sqlite3_stmt *stmt = NULL;
+    long long minutes = 0;
+    long long expected = 0;
+    int created = 0;
+    int conflict = 0;
+    assert(reservation_parse_minutes("2026-03-05 09:00", &expected));
+    assert(reservation_parse_minutes("2026-3-5 9:00", &minutes) && minutes == expected);
+    assert(reservation_parse_minutes("2026-03-05 09:00:30", &minutes) && minutes == expected);
+    assert(reservation_parse_minutes("2024-02-29 20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-02-31 20:00", &minutes));
+    assert(!reservation_parse_minutes("2025-02-29 20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-13-01 20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05 24:00", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05 20:00x", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05 20:00 ", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05 20:001", &minutes));
+    assert(!reservation_parse_minutes("26-03-05 20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05  20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-03--5 20:00", &minutes));
+    assert(!reservation_parse_minutes("2026-03-05", &minutes));
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    reservation_book_init(&book, 120);
+    assert(!reservation_book_create(&book, db, 1, "Ana", "", "2030-02-31 20:00", "", &created, &conflict) && conflict == 0);
+    assert(reservation_book_create(&book, db, 1, "Ana", "", "2030-5-2 9:05", "", &created, &conflict));
+    assert(sqlite3_prepare_v2(db->handle, "SELECT reserved_at FROM reservations WHERE id = ?", -1, &stmt, NULL) == SQLITE_OK);
+    sqlite3_bind_int(stmt, 1, created);
+    assert(sqlite3_step(stmt) == SQLITE_ROW);
+    assert(strcmp((const char *)sqlite3_column_text(stmt, 0), "2030-05-02 09:05") == 0);
+    sqlite3_finalize(stmt);
+    reservation_book_clear(&book);
+    database_close(db);
+}
+
+/* Filas de sql como "a|b;c|d;" para comparar resultados completos. */
+static void test_query_rows(Database *db, const char *sql, GString *rows) {
+    sqlite3_stmt *stmt = NULL;
+    g_string_truncate(rows, 0);
+    assert(sqlite3_prepare_v2(db->handle, sql, -1, &stmt, NULL) == SQLITE_OK);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int column = 0;
+        while (column < sqlite3_column_count(stmt)) {
+            const char *text = (const char *)sqlite3_column_text(stmt, column);
+            g_string_append_printf(rows, "%s%s", column == 0 ? "" : "|", text == NULL ? "NULL" : text);
+            column = column + 1;
+        }
+        g_string_append_c(rows, ';');
+    }
+    sqlite3_finalize(stmt);
+}
+
+static int test_add_item(Database *db, int order_id, int menu_item_id) {
+    assert(dao_add_item_to_order(db, order_id, menu_item_id, ""));
+    return (int)sqlite3_last_insert_rowid(db->handle);
+}
+
+static int test_order_on_day(Database *db, int table_id, int waiter_id, const char *business_date) {
+    sqlite3_stmt *stmt = NULL;
+    int order_id = 0;
+    assert(dao_create_order(db, table_id, waiter_id, &order_id));
+    assert(sqlite3_prepare_v2(db->handle, "UPDATE orders SET business_date = ? WHERE id = ?", -1, &stmt, NULL) == SQLITE_OK);
+    sqlite3_bind_text(stmt, 1, business_date, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, order_id);
+    assert(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    return order_id;
+}
+
+static void test_add_items_batch(void) {
+    static const OrderItemRequest unknown_item[] = {{1, "", 2}, {999, "", 1}};
+    static const OrderItemRequest zero_quantity[] = {{1, "", 2}, {2, "", 0}};
+    static const OrderItemRequest negative_quantity[] = {{2, "", -1}, {1, "", 1}};
+    static const OrderItemRequest valid[] = {{10, "sin azúcar", 3}, {2, NULL, 1}};
+    Database *db = NULL;
+    GString *rows = g_string_new(NULL);
+    int order_id = 0;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    assert(dao_create_order(db, 1, 2, &order_id));
+    test_add_item(db, order_id, 1);
+    /* Si una línea falla no queda ninguna, ni siquiera las unidades ya insertadas. */
+    assert(!dao_add_items_to_order(db, order_id, unknown_item, 2));
+    assert(!dao_add_items_to_order(db, order_id, zero_quantity, 2));
+    assert(!dao_add_items_to_order(db, order_id, negative_quantity, 2));
+    test_query_rows(db, "SELECT (SELECT COUNT(*) FROM order_items), item_count, printf('%.2f', subtotal) FROM orders", rows);
+    assert(strcmp(rows->str, "1|1|3500.00;") == 0);
+    /* quantity N son N filas, cada una con sus notas. */
+    assert(dao_add_items_to_order(db, order_id, valid, 2));
+    test_query_rows(db, "SELECT menu_item_id, notes, COUNT(*) FROM order_items GROUP BY menu_item_id, notes ORDER BY menu_item_id", rows);
+    assert(strcmp(rows->str, "1||1;2||1;10|sin azúcar|3;") == 0);
+    test_query_rows(db, "SELECT item_count, printf('%.2f', subtotal) FROM orders", rows);
+    assert(strcmp(rows->str, "5|8300.00;") == 0);
+    g_string_free(rows, TRUE);
+    database_close(db);
+}
+
+/* subtotal e item_count de cada comanda contra lo que suman sus ítems no anulados. */
+static void test_check_order_totals(Database *db, const char *expected) {
+    GString *rows = g_string_new(NULL);
+    test_query_rows(db,
+                    "SELECT COUNT(*) FROM orders o WHERE subtotal <> IFNULL((SELECT ROUND(SUM(unit_price), 2) FROM order_items WHERE order_id = o.id AND status <> 'anulado'), 0) "
+                    "OR item_count <> (SELECT COUNT(*) FROM order_items WHERE order_id = o.id AND status <> 'anulado')",
+                    rows);
+    assert(strcmp(rows->str, "0;") == 0);
+    test_query_rows(db, "SELECT id, printf('%.2f', subtotal), item_count FROM orders ORDER BY id", rows);
+    assert(strcmp(rows->str, expected) == 0);
+    g_string_free(rows, TRUE);
+}
+
+static void test_order_item_update(Database *db, const char *format, int item_id) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), format, item_id);
+    assert(sqlite3_exec(db->handle, sql, NULL, NULL, NULL) == SQLITE_OK);
+}
+
+static void test_order_subtotal_triggers(void) {
+    Database *db = NULL;
+    GString *rows = g_string_new(NULL);
+    int first = 0;
+    int second = 0;
+    int milanesa = 0;
+    int ensalada = 0;
+    int cafe = 0;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    assert(dao_create_order(db, 1, 2, &first) && first == 1);
+    assert(dao_create_order(db, 2, 3, &second) && second == 2);
+    milanesa = test_add_item(db, first, 1);
+    ensalada = test_add_item(db, first, 2);
+    cafe = test_add_item(db, first, 10);
+    test_check_order_totals(db, "1|6500.00|3;2|0.00|0;");
+    assert(dao_update_order_item_status(db, ensalada, "anulado"));
+    test_check_order_totals(db, "1|4400.00|2;2|0.00|0;");
+    /* Pasar de un estado no anulado a otro no cambia nada. */
+    assert(dao_update_order_item_status(db, cafe, "listo"));
+    test_check_order_totals(db, "1|4400.00|2;2|0.00|0;");
+    assert(dao_update_order_item_status(db, ensalada, "pedido"));
+    test_check_order_totals(db, "1|6500.00|3;2|0.00|0;");
+    test_order_item_update(db, "UPDATE order_items SET unit_price = 950.5 WHERE id = %d", cafe);
+    test_check_order_totals(db, "1|6550.50|3;2|0.00|0;");
+    test_order_item_update(db, "UPDATE order_items SET order_id = 2 WHERE id = %d", milanesa);
+    test_check_order_totals(db, "1|3050.50|2;2|3500.00|1;");
+    test_order_item_update(db, "DELETE FROM order_items WHERE id = %d", cafe);
+    test_check_order_totals(db, "1|2100.00|1;2|3500.00|1;");
+    /* Un ítem anulado no resta al borrarse ni al moverse. */
+    assert(dao_update_order_item_status(db, ensalada, "anulado"));
+    test_order_item_update(db, "UPDATE order_items SET order_id = 2 WHERE id = %d", ensalada);
+    test_check_order_totals(db, "1|0.00|0;2|3500.00|1;");
+    test_order_item_update(db, "DELETE FROM order_items WHERE id = %d", ensalada);
+    test_check_order_totals(db, "1|0.00|0;2|3500.00|1;");
+    /* unit_price queda congelado al pedir: el nuevo precio solo afecta a lo que se pide después. */
+    assert(sqlite3_exec(db->handle, "UPDATE menu_items SET price = 4000 WHERE id = 1", NULL, NULL, NULL) == SQLITE_OK);
+    test_query_rows(db, "SELECT printf('%.2f', unit_price) FROM order_items ORDER BY id", rows);
+    assert(strcmp(rows->str, "3500.00;") == 0);
+    test_add_item(db, second, 1);
+    test_check_order_totals(db, "1|0.00|0;2|7500.00|2;");
+    g_string_free(rows, TRUE);
+    database_close(db);
+}
+
+static void test_sales_rollups(void) {
+    static const char *const sums[] = {
+        "SELECT business_date, printf('%.2f', revenue), printf('%.2f', cost), item_count, order_count FROM sales_daily ORDER BY 1",
+        "SELECT business_date, waiter_id, printf('%.2f', revenue), printf('%.2f', cost), item_count, order_count FROM sales_daily_waiter ORDER BY 1, 2",
+        "SELECT business_date, table_id, printf('%.2f', revenue), printf('%.2f', cost), item_count, order_count FROM sales_daily_table ORDER BY 1, 2",
+        "SELECT business_date, menu_item_id, printf('%.2f', revenue), printf('%.2f', cost), item_count, order_count FROM sales_daily_item ORDER BY 1, 2"
+    };
+    /* Milanesa (1) 3500/1500, Ensalada (2) 2100/800, Café (10) 900/200; una Milanesa de la primera comanda se anula. */
+    static const char *const expected[] = {
+        "2026-01-10|7400.00|2700.00|4|2;2026-01-11|3500.00|1500.00|1|1;",
+        "2026-01-10|2|4400.00|1700.00|2|1;2026-01-10|3|3000.00|1000.00|2|1;2026-01-11|2|3500.00|1500.00|1|1;",
+        "2026-01-10|1|4400.00|1700.00|2|1;2026-01-10|2|3000.00|1000.00|2|1;2026-01-11|1|3500.00|1500.00|1|1;",
+        "2026-01-10|1|3500.00|1500.00|1|1;2026-01-10|2|2100.00|800.00|1|1;2026-01-10|10|1800.00|400.00|2|2;2026-01-11|1|3500.00|1500.00|1|1;"
+    };
+    static const char *const tables[] = {
+        "SELECT * FROM sales_daily ORDER BY 1",
+        "SELECT * FROM sales_daily_waiter ORDER BY 1, 2",
+        "SELECT * FROM sales_daily_table ORDER BY 1, 2",
+        "SELECT * FROM sales_daily_item ORDER BY 1, 2"
+    };
+    Database *db = NULL;
+    GString *rows = g_string_new(NULL);
+    GString *incremental[4];
+    int first = 0;
+    int second = 0;
+    int third = 0;
+    int open = 0;
+    int voided = 0;
+    int cafe = 0;
+    int applied = 0;
+    OrderItemStatusChange unvoid;
+    int index = 0;
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    first = test_order_on_day(db, 1, 2, "2026-01-10");
+    voided = test_add_item(db, first, 1);
+    test_add_item(db, first, 1);
+    cafe = test_add_item(db, first, 10);
+    assert(dao_update_order_item_status(db, voided, "anulado"));
+    assert(dao_close_order(db, first));
+    second = test_order_on_day(db, 2, 3, "2026-01-10");
+    test_add_item(db, second, 2);
+    test_add_item(db, second, 10);
+    assert(dao_close_order(db, second));
+    third = test_order_on_day(db, 1, 2, "2026-01-11");
+    test_add_item(db, third, 1);
+    assert(dao_close_order(db, third));
+    /* Una comanda abierta no suma hasta cerrarse. */
+    open = test_order_on_day(db, 3, 3, "2026-01-11");
+    test_add_item(db, open, 2);
+    while (index < 4) {
+        test_query_rows(db, sums[index], rows);
+        assert(strcmp(rows->str, expected[index]) == 0);
+        incremental[index] = g_string_new(NULL);
+        test_query_rows(db, tables[index], incremental[index]);
+        index = index + 1;
+    }
+    /* Cerrar dos veces no vuelve a sumar, ni se anula o rehabilita un ítem de una comanda cerrada. */
+    assert(!dao_close_order(db, first));
+    assert(dao_update_order_item_status(db, cafe, "anulado"));
+    unvoid.order_item_id = voided;
+    g_strlcpy(unvoid.status, "pedido", sizeof(unvoid.status));
+    assert(dao_update_order_item_statuses(db, &unvoid, 1, &applied) && applied == 0);
+    test_query_rows(db, "SELECT printf('%.2f', subtotal), item_count FROM orders WHERE id = 1", rows);
+    assert(strcmp(rows->str, "4400.00|2;") == 0);
+    index = 0;
+    while (index < 4) {
+        test_query_rows(db, tables[index], rows);
+        assert(strcmp(rows->str, incremental[index]->str) == 0);
+        index = index + 1;
+    }
+    assert(dao_rebuild_rollups(db));
+    index = 0;
+    while (index < 4) {
+        test_query_rows(db, tables[index], rows);
+        assert(strcmp(rows->str, incremental[index]->str) == 0);
+        g_string_free(incremental[index], TRUE);
+        index = index + 1;
+    }
+    g_string_free(rows, TRUE);
+    database_close(db);
+}
+
+static gpointer test_logger_producer(gpointer data) {
+    Logger *logger = (Logger *)data;
+    char message[64];
+    int index = 0;
+    while (index < 2000) {
+        snprintf(message, sizeof(message), "registro %d", index);
+        logger_log(logger, LOG_LEVEL_DEBUG, "test", message);
+        index = index + 1;
+    }
+    return NULL;
+}
+
+static int test_logger_count_lines(const char *path) {
+    FILE *file = fopen(path, "r");
+    char line[256];
+    int lines = 0;
+    assert(file != NULL);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lines = lines + 1;
+    }
+    fclose(file);
+    return lines;
+}
+
+/* Con block y un buffer chico los productores esperan: al cerrar no falta ninguna línea. */
+/* Los logs de prueba van a un directorio temporal que test_remove_log_dir borra entero. */
+static char *test_make_log_dir(void) {
+    char *directory = g_dir_make_tmp("restaurant_test_XXXXXX", NULL);
+    assert(directory != NULL);
+    return directory;
+}
+
+static void test_remove_log_dir(char *directory) {
+    GDir *dir = g_dir_open(directory, 0, NULL);
+    const char *name = NULL;
+    assert(dir != NULL);
+    name = g_dir_read_name(dir);
+    while (name != NULL) {
+        char *file = g_build_filename(directory, name, NULL);
+        assert(g_remove(file) == 0);
+        g_free(file);
+        name = g_dir_read_name(dir);
+    }
+    g_dir_close(dir);
+    assert(g_rmdir(directory) == 0);
+    g_free(directory);
+}
+
+static void test_logger_async_drains(void) {
+    Logger logger;
+    GThread *producers[4];
+    char *directory = test_make_log_dir();
+    char path[1200];
+    int index = 0;
+    assert(logger_init(&logger, directory, LOG_LEVEL_DEBUG));
+    snprintf(path, sizeof(path), "%s/%s.log", directory, logger.current_date);
+    assert(logger_start_async(&logger, 16, true));
+    while (index < 4) {
+        producers[index] = g_thread_new("producer", test_logger_producer, &logger);
+        index = index + 1;
+    }
+    index = 0;
+    while (index < 4) {
+        g_thread_join(producers[index]);
+        index = index + 1;
+    }
+    logger_log(&logger, LOG_LEVEL_INFO, "test", "fin");
+    assert(logger.dropped == 0);
+    logger_close(&logger);
+    assert(test_logger_count_lines(path) == 8001);
+    test_remove_log_dir(directory);
+}
+
+static void test_logger_json_fields(void) {
+    Logger logger;
+    FILE *file = NULL;
+    char *directory = test_make_log_dir();
+    char path[1200];
+    char line[512];
+    const char *body = NULL;
+    /* logger_init ya crea el .log del día; el test borra los dos archivos con el directorio. */
+    assert(logger_init(&logger, directory, LOG_LEVEL_INFO));
+    assert(logger_set_format(&logger, LOG_FORMAT_JSON));
+    snprintf(path, sizeof(path), "%s/%s.jsonl", directory, logger.current_date);
+    assert(!logger_enabled(&logger, LOG_LEVEL_DEBUG));
+    logger_logf(&logger, LOG_LEVEL_DEBUG, "order", "filtrado %d", 1);
+    logger_log_fields(&logger, LOG_LEVEL_ERROR, "order", "No se pudo crear la \"comanda\"",
+                      LOG_FIELDS(LOG_INT("table_id", 7), LOG_DOUBLE("total", 12.5), LOG_STR("user", "mozo 1")));
+    logger_close(&logger);
+    file = fopen(path, "r");
+    assert(file != NULL);
+    assert(fgets(line, sizeof(line), file) != NULL);
+    assert(fgets(path, sizeof(path), file) == NULL);
+    fclose(file);
+    assert(strncmp(line, "{\"ts\":\"", 7) == 0);
+    body = strstr(line, "\",\"level\"");
+    assert(body != NULL);
+    assert(strcmp(body, "\",\"level\":\"ERROR\",\"component\":\"order\",\"msg\":\"No se pudo crear la \\\"comanda\\\"\",\"table_id\":7,\"total\":12.5,\"user\":\"mozo 1\"}\n") == 0);
+    test_remove_log_dir(directory);
+}
+
+static void test_metrics_latency_histograms(void) {
+    Metrics metrics;
+    MetricsSummary summary;
+    Database *db = NULL;
+    GArray *summaries = NULL;
+    GString *text = NULL;
+    int order_id = 0;
+    int value = 1;
+    guint index = 0;
+    bool found = false;
+    metrics_init(&metrics);
+    /* 1..1000 us: los percentiles caen en el bucket correcto, con a lo sumo 25% de error hacia arriba. */
+    while (value <= 1000) {
+        metrics_histogram_record(&metrics.ops[METRICS_OP_DAO_CREATE_ORDER], value);
+        value = value + 1;
+    }
+    assert(metrics_summarize(&metrics.ops[METRICS_OP_DAO_CREATE_ORDER], &summary));
+    assert(summary.count == 1000 && summary.max_ms == 1.0);
+    assert(summary.p50_ms >= 0.5 && summary.p50_ms <= 0.625);
+    assert(summary.p99_ms >= 0.99 && summary.p99_ms <= 1.0);
+    assert(!metrics_summarize(&metrics.ops[METRICS_OP_AUTH_LOGIN], &summary));
+    /* Cada sentencia preparada por la conexión suma a su propio histograma. */
+    assert(database_open(&db, ":memory:", NULL, NULL));
+    assert(database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL));
+    assert(database_seed(db, NULL));
+    database_set_metrics(db, &metrics);
+    assert(dao_create_order(db, 1, 1, &order_id));
+    assert(dao_create_order(db, 2, 1, &order_id));
+    summaries = metrics_snapshot(&metrics);
+    while (index < summaries->len) {
+        const MetricsSummary *row = &g_array_index(summaries, MetricsSummary, index);
+        if (strcmp(row->family, "sql") == 0 && strcmp(row->name, "ORDER_INSERT") == 0) {
+            assert(row->count == 2);
+            found = true;
+        }
+        index = index + 1;
+    }
+    assert(found);
+    text = metrics_render(&metrics, METRICS_FORMAT_PROMETHEUS);
+    assert(strstr(text->str, "restaurant_latency_ms_count{family=\"dao\",op=\"create_order\"} 1002\n") != NULL);
+    assert(strstr(text->str, "restaurant_latency_ms_count{family=\"sql\",op=\"ORDER_INSERT\"} 2\n") != NULL);
+    g_string_free(text, TRUE);
+    text = metrics_render(&metrics, METRICS_FORMAT_JSON);
+    assert(strstr(text->str, "\"op\":\"TABLE_OCCUPY\",\"count\":2,") != NULL);
+    g_string_free(text, TRUE);
+    g_array_unref(summaries);
+    database_close(db);
+    metrics_clear(&metrics);
+}
+
 int main(void) {
     test_config_default_values();
     test_hash_sha256();
+    test_statement_cache_reuse();
+    test_schema_fingerprint();
+    test_arena_interning();
+    test_status_queue_coalescing();
+    test_startup_trace_budget();
+    test_snapshot_cache_versions();
+    test_change_bus_commit_only();
+    test_kitchen_feed_deltas();
+    test_reservations_keyset_window();
+    test_interval_tree_overlaps();
+    test_reservation_book_conflicts();
+    test_reservation_when_strict();
+    test_add_items_batch();
+    test_order_subtotal_triggers();
+    test_sales_rollups();
+    test_logger_async_drains();
+    test_logger_json_fields();
+    test_metrics_latency_histograms();
     return 0;
 }
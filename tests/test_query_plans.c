@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+#include "data/dao_sql.h"
+#include "data/database.h"
+#include "data/migrations.h"
+
+static bool plan_detail_allowed(DaoPlanExpectation plan, const char *detail) {
+    if (plan == DAO_PLAN_ANY) {
+        return true;
+    }
+    if (strstr(detail, "USE TEMP B-TREE") != NULL) {
+        return false;
+    }
+    if (plan == DAO_PLAN_INDEXED && strncmp(detail, "SCAN ", 5) == 0 && strcmp(detail, "SCAN CONSTANT ROW") != 0) {
+        return false;
+    }
+    return true;
+}
+
+static int check_statement(sqlite3 *db, const DaoSqlStatement *statement) {
+    char sql[2048];
+    sqlite3_stmt *stmt = NULL;
+    int failures = 0;
+    int rc;
+    snprintf(sql, sizeof(sql), "EXPLAIN QUERY PLAN %s", statement->sql);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "%s: no compila: %s\n", statement->name, sqlite3_errmsg(db));
+        return 1;
+    }
+    rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        const char *detail = (const char *)sqlite3_column_text(stmt, 3);
+        if (detail != NULL && !plan_detail_allowed(statement->plan, detail)) {
+            fprintf(stderr, "%s: plan no permitido: %s\n", statement->name, detail);
+            failures = failures + 1;
+        }
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return failures;
+}
+
+int main(void) {
+    Database *db = NULL;
+    const DaoSqlStatement *statements;
+    int count = 0;
+    int index = 0;
+    int failures = 0;
+    if (!database_open(&db, ":memory:", NULL, NULL)) {
+        fprintf(stderr, "No se pudo abrir la base en memoria\n");
+        return 1;
+    }
+    if (!database_apply_migrations(db, MIGRATIONS, MIGRATION_COUNT, NULL)) {
+        fprintf(stderr, "No se pudieron aplicar las migraciones\n");
+        database_close(db);
+        return 1;
+    }
+    statements = dao_sql_statements(&count);
+    while (index < count) {
+        failures = failures + check_statement(db->handle, &statements[index]);
+        index = index + 1;
+    }
+    database_close(db);
+    return failures == 0 ? 0 : 1;
+}